@@ -13,10 +13,23 @@
 #define FROMNUM_UUID "ed9da18c-a800-4f66-a670-aa7547e34453"
 #define LEGACY_LOGRADIO_UUID "6c6fd238-78fa-436b-aacf-15c5be1ef2e2"
 #define LOGRADIO_UUID "5a3d6e49-06e6-4423-9944-e9de8cdf9547"
+// Opt-in alternative to FROMRADIO_UUID: each read returns as many FromRadio frames as fit the ATT MTU, each after a 16 bit
+// little-endian length
+#define FROMRADIO_BATCH_UUID "8ba2bcc2-ee02-4a55-a531-c525c5e454d5"
+
+// Largest value of the batched FromRadio characteristic, the ATT limit
+#define FROMRADIO_BATCH_MAX_LEN 512
 
 // NRF52 wants these constants as byte arrays
 // Generated here https://yupana-engineering.com/online-uuid-to-c-array-converter - but in REVERSE BYTE ORDER
-extern const uint8_t MESH_SERVICE_UUID_16[], TORADIO_UUID_16[16u], FROMRADIO_UUID_16[], FROMNUM_UUID_16[], LOGRADIO_UUID_16[];
+extern const uint8_t MESH_SERVICE_UUID_16[], TORADIO_UUID_16[16u], FROMRADIO_UUID_16[], FROMNUM_UUID_16[], LOGRADIO_UUID_16[],
+    FROMRADIO_BATCH_UUID_16[];
+
+/**
+ * Append an encoded FromRadio frame to a batched read
+ * @return false (leaving batch untouched) if it doesn't fit in maxLen
+ */
+bool appendFromRadioBatch(uint8_t *batch, size_t &batchLen, size_t maxLen, const uint8_t *frame, size_t frameLen);
 
 /// Given a level between 0-100, update the BLE attribute
 void updateBatteryLevel(uint8_t level);
@@ -9,6 +9,20 @@ AirTime *airTime = NULL;
 uint32_t air_period_tx[PERIODS_TO_LOG];
 uint32_t air_period_rx[PERIODS_TO_LOG];
 
+void DecayingUtilization::add(uint32_t nowMsec, uint32_t busyMsec)
+{
+    busy *= expf(-(float)(nowMsec - lastMsec) / timeConstant);
+    lastMsec = nowMsec;
+    // The busy time was spread over the last busyMsec, so its older part has already decayed a little
+    busy += timeConstant * (1 - expf(-(float)busyMsec / timeConstant));
+}
+
+float DecayingUtilization::percent(uint32_t nowMsec) const
+{
+    float decayed = busy * expf(-(float)(nowMsec - lastMsec) / timeConstant);
+    return min(decayed / timeConstant * 100, 100.0f);
+}
+
 void AirTime::logAirtime(reportTypes reportType, uint32_t airtime_ms)
 {
 
@@ -29,6 +43,8 @@ void AirTime::logAirtime(reportTypes reportType, uint32_t airtime_ms)
 
     // Log all airtime type for channel utilization
     this->channelUtilization[this->getPeriodUtilMinute()] = channelUtilization[this->getPeriodUtilMinute()] + airtime_ms;
+    channelShort.add(millis(), airtime_ms);
+    channelLong.add(millis(), airtime_ms);
 }
 
 uint8_t AirTime::currentPeriodIndex()
@@ -123,7 +139,11 @@ float AirTime::utilizationTXPercent()
 bool AirTime::isTxAllowedChannelUtil(bool polite)
 {
     uint8_t percentage = (polite ? polite_channel_util_percent : max_channel_util_percent);
-    if (channelUtilizationPercent() < percentage) {
+    // Polite senders also hold off during a burst, which the minute long average would only see once it is over
+    float utilization = channelUtilizationPercent();
+    if (polite)
+        utilization = max(utilization, channelUtilizationShortPercent());
+    if (utilization < percentage) {
         return true;
     } else {
         LOG_WARN("Ch. util >%d%%. Skip send", percentage);
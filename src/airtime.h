@@ -33,8 +33,32 @@
 #define MS_IN_MINUTE (SECONDS_IN_MINUTE * 1000)
 #define MS_IN_HOUR (MINUTES_IN_HOUR * SECONDS_IN_MINUTE * 1000)
 
+// Time constants of the decaying channel utilization estimates
+#define CHANNEL_UTIL_SHORT_MSEC (30 * 1000)
+#define CHANNEL_UTIL_LONG_MSEC (10 * MS_IN_MINUTE)
+
 enum reportTypes { TX_LOG, RX_LOG, RX_ALL_LOG };
 
+/**
+ * The share of time the channel was busy, exponentially weighted towards the last timeConstantMsec.  It follows a burst within
+ * about one time constant, costs O(1) per update and needs no periodic upkeep.
+ */
+class DecayingUtilization
+{
+  public:
+    explicit DecayingUtilization(uint32_t timeConstantMsec) : timeConstant(timeConstantMsec) {}
+
+    /// Record that the channel was busy for the busyMsec before nowMsec
+    void add(uint32_t nowMsec, uint32_t busyMsec);
+
+    float percent(uint32_t nowMsec) const;
+
+  private:
+    float timeConstant;
+    float busy = 0; // Decayed busy msecs, as of lastMsec
+    uint32_t lastMsec = 0;
+};
+
 void logAirtime(reportTypes reportType, uint32_t airtime_ms);
 
 uint32_t *airtimeReport(reportTypes reportType);
@@ -49,6 +73,11 @@ class AirTime : private concurrency::OSThread
     float channelUtilizationPercent();
     float utilizationTXPercent();
 
+    /// Channel utilization over about the last thirty seconds, for reacting to bursts
+    float channelUtilizationShortPercent() { return channelShort.percent(millis()); }
+    /// Channel utilization over about the last ten minutes
+    float channelUtilizationLongPercent() { return channelLong.percent(millis()); }
+
     float UtilizationPercentTX();
     uint32_t channelUtilization[CHANNEL_UTILIZATION_PERIODS] = {0};
     uint32_t utilizationTX[MINUTES_IN_HOUR] = {0};
@@ -71,6 +100,9 @@ class AirTime : private concurrency::OSThread
     uint8_t polite_channel_util_percent = 25;
     uint8_t polite_duty_cycle_percent = 50; // half of Duty Cycle allowance is ok for metadata
 
+    DecayingUtilization channelShort = DecayingUtilization(CHANNEL_UTIL_SHORT_MSEC);
+    DecayingUtilization channelLong = DecayingUtilization(CHANNEL_UTIL_LONG_MSEC);
+
     struct airtimeStruct {
         uint32_t periodTX[PERIODS_TO_LOG];     // AirTime transmitted
         uint32_t periodRX[PERIODS_TO_LOG];     // AirTime received and repeated (Only valid mesh packets)
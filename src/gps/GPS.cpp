@@ -68,6 +68,7 @@ static struct uBloxGnssModelInfo {
 } ublox_info;
 
 #define GPS_SOL_EXPIRY_MS 5000 // in millis. give 1 second time to combine different sentences. NMEA Frequency isn't higher anyway
+#define GPS_INGEST_STATS_MS (5 * 60 * 1000) // How often to log the serial ingest counters
 #define NMEA_MSG_GXGSA "GNGSA" // GSA message (GPGSA, GNGSA etc)
 
 // For logging
@@ -1739,29 +1740,55 @@ bool GPS::whileActive()
         clearBuffer();
         return false;
     }
+    uint32_t startMicros = micros();
 #ifdef SERIAL_BUFFER_SIZE
     if (_serial_gps->available() >= SERIAL_BUFFER_SIZE - 1) {
         LOG_WARN("GPS Buffer full with %u bytes waiting. Flush to avoid corruption", _serial_gps->available());
+        ingestDroppedBytes += _serial_gps->available();
+        ingestOverflows++;
         clearBuffer();
     }
 #endif
-    // First consume any chars that have piled up at the receiver
-    while (_serial_gps->available() > 0) {
-        int c = _serial_gps->read();
-        UBXscratch[charsInBuf] = c;
+    // First consume any chars that have piled up at the receiver, a block at a time rather than a read() call per byte
+    uint8_t block[64];
+    int waiting;
+    while ((waiting = _serial_gps->available()) > 0) {
+        size_t len = _serial_gps->readBytes(block, std::min((size_t)waiting, sizeof(block)));
+        if (!len)
+            break;
+        ingestBytes += len;
+        for (size_t i = 0; i < len; i++) {
 #ifdef GPS_DEBUG
-        debugmsg += vformat("%c", (c >= 32 && c <= 126) ? c : '.');
-#endif
-        isValid |= reader.encode(c);
-        if (charsInBuf > sizeof(UBXscratch) - 10 || c == '\r') {
-            if (strnstr((char *)UBXscratch, "$GPTXT,01,01,02,u-blox ag - www.u-blox.com*50", charsInBuf)) {
-                rebootsSeen++;
+            debugmsg += vformat("%c", (block[i] >= 32 && block[i] <= 126) ? block[i] : '.');
+#endif
+            // Only the sentences we use go on to the parser
+            const uint8_t *pass;
+            size_t passLen = nmeaFilter.feed(block[i], pass);
+            for (size_t j = 0; j < passLen; j++) {
+                uint8_t c = pass[j];
+                UBXscratch[charsInBuf] = c;
+                isValid |= reader.encode(c);
+                if (charsInBuf > sizeof(UBXscratch) - 10 || c == '\r') {
+                    if (strnstr((char *)UBXscratch, "$GPTXT,01,01,02,u-blox ag - www.u-blox.com*50", charsInBuf)) {
+                        rebootsSeen++;
+                    }
+                    charsInBuf = 0;
+                } else {
+                    charsInBuf++;
+                }
             }
-            charsInBuf = 0;
-        } else {
-            charsInBuf++;
         }
     }
+    ingestMicros += micros() - startMicros;
+
+    if (!Throttle::isWithinTimespanMs(lastIngestStatsMs, GPS_INGEST_STATS_MS)) {
+        lastIngestStatsMs = millis();
+        LOG_DEBUG("GPS serial: %u bytes parsed at %u bytes/ms, %u sentences used, %u skipped (%u bytes), %u bytes dropped in "
+                  "%u overflows",
+                  ingestBytes, ingestMicros ? (uint32_t)((uint64_t)ingestBytes * 1000 / ingestMicros) : 0,
+                  nmeaFilter.sentencesPassed, nmeaFilter.sentencesSkipped, nmeaFilter.bytesSkipped, ingestDroppedBytes,
+                  ingestOverflows);
+    }
 #ifdef GPS_DEBUG
     if (debugmsg != "") {
         LOG_DEBUG(debugmsg.c_str());
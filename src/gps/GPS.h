@@ -4,6 +4,7 @@
 
 #include "GPSStatus.h"
 #include "GpioLogic.h"
+#include "NMEASentenceFilter.h"
 #include "Observer.h"
 #include "TinyGPS++.h"
 #include "concurrency/OSThread.h"
@@ -151,6 +152,15 @@ class GPS : private concurrency::OSThread
     uint8_t fixQual = 0; // fix quality from GPGGA
     uint32_t lastChecksumFailCount = 0;
 
+    NMEASentenceFilter nmeaFilter; // Keeps the sentences we don't use away from reader
+
+    // Serial ingest counters, logged now and then by whileActive()
+    uint32_t ingestBytes = 0;        // Read from the serial port
+    uint32_t ingestMicros = 0;       // Spent reading and parsing them
+    uint32_t ingestDroppedBytes = 0; // Flushed because the serial buffer was full
+    uint32_t ingestOverflows = 0;
+    uint32_t lastIngestStatsMs = 0;
+
 #ifndef TINYGPS_OPTION_NO_CUSTOM_FIELDS
     // (20210908) TinyGps++ can only read the GPGSA "FIX TYPE" field
     // via optional feature "custom fields", currently disabled (bug #525)
@@ -424,6 +424,111 @@ float GeoCoord::bearing(double lat1, double lon1, double lat2, double lon2)
     return atan2(y, x);
 }
 
+namespace
+{
+// Radians per 1e-7 degree
+const float RAD_PER_DEG_E7 = PI / 180 / 1e7;
+
+// Separations in latitude and longitude (in radians) below which the small angle versions are used
+const float SMALL_ANGLE = 0.01f;
+
+// The separation of two points in 1e-7 degrees, with the trig of the first point's latitude
+struct Separation {
+    float dLat, dLon; // Radians, dLon wrapped to +-PI
+    float sinLat1, cosLat1;
+    bool small; // dLat and dLon are both below SMALL_ANGLE
+};
+
+// cos of a latitude in 1e-7 degrees, as the sin of its colatitude.  Near the poles cosf() of the latitude in radians loses
+// most of its precision to the rounding of the argument, while the colatitude is exact in integer math.
+float cosLat(int32_t lat)
+{
+    return sinf((900000000 - (lat < 0 ? -(int64_t)lat : lat)) * RAD_PER_DEG_E7);
+}
+
+Separation separation(int32_t lat1, int32_t lon1, int32_t lat2, int32_t lon2)
+{
+    // Callers mostly measure from our own position to one node after another, so the sin and cos of lat1 rarely change.
+    // Only the main thread calls this.
+    static int32_t cachedLat = 0;
+    static float cachedSin = 0, cachedCos = 1;
+    if (lat1 != cachedLat) {
+        float lat1Rad = lat1 * RAD_PER_DEG_E7;
+        cachedSin = sinf(lat1Rad);
+        cachedCos = cosLat(lat1);
+        cachedLat = lat1;
+    }
+
+    // The differences are exact in integer math, so no precision is lost to large coordinates
+    int64_t dLon = (int64_t)lon2 - lon1;
+    if (dLon > 1800000000)
+        dLon -= 3600000000LL;
+    else if (dLon < -1800000000)
+        dLon += 3600000000LL;
+
+    Separation s;
+    s.dLat = ((int64_t)lat2 - lat1) * RAD_PER_DEG_E7;
+    s.dLon = dLon * RAD_PER_DEG_E7;
+    s.sinLat1 = cachedSin;
+    s.cosLat1 = cachedCos;
+    s.small = fabsf(s.dLat) < SMALL_ANGLE && fabsf(s.dLon) < SMALL_ANGLE;
+    return s;
+}
+
+// cos(lat1 + dLat) by its Taylor series around lat1, good to about dLat^3 / 6
+float cosLatOffset(const Separation &s, float dLat)
+{
+    return s.cosLat1 * (1 - dLat * dLat / 2) - s.sinLat1 * dLat;
+}
+} // namespace
+
+/**
+ * Distance in meters between two points in 1e-7 degrees, on the same sphere as latLongToMeter().
+ *
+ * Points within SMALL_ANGLE of each other use the equirectangular approximation around their mean latitude, with no trig
+ * beyond the cached latitude of the first point.  Points further apart, including nearby points close to the poles, use
+ * single precision haversine.  Either way, and right up to the poles, the result is within 0.1 m + 0.002% of latLongToMeter().
+ */
+float GeoCoord::latLongToMeterFast(int32_t lat_a, int32_t lng_a, int32_t lat_b, int32_t lng_b)
+{
+    Separation s = separation(lat_a, lng_a, lat_b, lng_b);
+
+    if (s.small) {
+        float x = s.dLon * cosLatOffset(s, s.dLat / 2);
+        return 6366000 * sqrtf(s.dLat * s.dLat + x * x);
+    }
+
+    float cosLat2 = cosLat(lat_b);
+    float sinHalfDLat = sinf(s.dLat / 2);
+    float sinHalfDLon = sinf(s.dLon / 2);
+    float a = sinHalfDLat * sinHalfDLat + s.cosLat1 * cosLat2 * sinHalfDLon * sinHalfDLon;
+    if (a > 1)
+        a = 1;
+    return 6366000 * 2 * atan2f(sqrtf(a), sqrtf(1 - a));
+}
+
+/**
+ * Initial bearing in radians between two points in 1e-7 degrees, as bearing() but in single precision.
+ *
+ * The north component is computed as sin(dLat) + sin(lat1) cos(lat2) (1 - cos(dLon)), which equals the usual
+ * cos(lat1) sin(lat2) - sin(lat1) cos(lat2) cos(dLon) without cancelling to nothing for nearby points.  Points within
+ * SMALL_ANGLE of each other use small angle sin and cos and no trig calls.  Within 0.01 degrees of bearing() for points
+ * more than 10 m apart.
+ */
+float GeoCoord::bearingFast(int32_t lat1, int32_t lon1, int32_t lat2, int32_t lon2)
+{
+    Separation s = separation(lat1, lon1, lat2, lon2);
+
+    if (s.small) {
+        float cosLat2 = cosLatOffset(s, s.dLat);
+        return atan2f(s.dLon * cosLat2, s.dLat + s.sinLat1 * cosLat2 * s.dLon * s.dLon / 2);
+    }
+
+    float cosLat2 = cosLat(lat2);
+    float sinHalfDLon = sinf(s.dLon / 2);
+    return atan2f(sinf(s.dLon) * cosLat2, sinf(s.dLat) + s.sinLat1 * cosLat2 * 2 * sinHalfDLon * sinHalfDLon);
+}
+
 /**
  * Ported from http://www.edwilliams.org/avform147.htm#Intro
  * @brief Convert from meters to range in radians on a great circle
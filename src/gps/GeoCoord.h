@@ -93,6 +93,10 @@ class GeoCoord
     static void convertWGS84ToOSGB36(const double lat, const double lon, double &osgb_Latitude, double &osgb_Longitude);
     static float latLongToMeter(double lat_a, double lng_a, double lat_b, double lng_b);
     static float bearing(double lat1, double lon1, double lat2, double lon2);
+    // Single precision versions of latLongToMeter() and bearing() for positions in 1e-7 degrees (as in
+    // meshtastic_PositionLite), for code which runs per node per frame or on every GPS fix
+    static float latLongToMeterFast(int32_t lat_a, int32_t lng_a, int32_t lat_b, int32_t lng_b);
+    static float bearingFast(int32_t lat1, int32_t lon1, int32_t lat2, int32_t lon2);
     static float rangeRadiansToMeters(double range_radians);
     static float rangeMetersToRadians(double range_meters);
     static unsigned int bearingToDegrees(const char *bearing);
@@ -0,0 +1,55 @@
+#include "NMEASentenceFilter.h"
+#include <string.h>
+
+static bool isWanted(const uint8_t *type)
+{
+    static const char *const wanted[] = {"GGA", "RMC", "GSA", "TXT"};
+    for (const char *w : wanted) {
+        if (memcmp(type, w, 3) == 0)
+            return true;
+    }
+    return false;
+}
+
+size_t NMEASentenceFilter::feed(uint8_t c, const uint8_t *&out)
+{
+    // A $ always starts a new sentence, even if the last one was cut short
+    if (c == '$') {
+        if (state == PREFIX)
+            sentencesSkipped++;
+        state = PREFIX;
+        prefix[0] = c;
+        prefixLen = 1;
+        return 0;
+    }
+
+    switch (state) {
+    case PASS:
+        // Anything after the end of the line is binary or noise until the next $
+        if (c == '\n')
+            state = SKIP;
+        prefix[0] = c;
+        out = prefix;
+        return 1;
+
+    case PREFIX:
+        prefix[prefixLen++] = c;
+        if (prefixLen < PREFIX_LEN)
+            return 0;
+        // Proprietary sentences ($P...) have no talker ID
+        if (prefix[1] != 'P' && isWanted(prefix + 3)) {
+            state = PASS;
+            sentencesPassed++;
+            out = prefix;
+            return PREFIX_LEN;
+        }
+        state = SKIP;
+        sentencesSkipped++;
+        bytesSkipped += PREFIX_LEN;
+        return 0;
+
+    default:
+        bytesSkipped++;
+        return 0;
+    }
+}
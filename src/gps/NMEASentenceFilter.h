@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Picks the NMEA sentences we use (GGA, RMC, GSA and TXT) out of the GPS serial stream, so the rest (GSV, VTG, GLL,
+ * proprietary sentences and UBX binary) are skipped by their prefix and never reach TinyGPS++.  The talker ID is ignored,
+ * so $GPGGA and $GNGGA both get through.
+ */
+class NMEASentenceFilter
+{
+  public:
+    /**
+     * Feed the next byte from the GPS
+     * @param out set to the bytes to hand on to the parser.  Once a sentence is recognised its whole prefix is handed on at once.
+     * @return how many bytes of out to use
+     */
+    size_t feed(uint8_t c, const uint8_t *&out);
+
+    uint32_t sentencesPassed = 0;
+    uint32_t sentencesSkipped = 0;
+    uint32_t bytesSkipped = 0;
+
+  private:
+    static constexpr size_t PREFIX_LEN = 6; // $, talker ID and sentence type
+
+    enum State : uint8_t { SKIP, PREFIX, PASS };
+
+    State state = SKIP;
+    uint8_t prefix[PREFIX_LEN];
+    uint8_t prefixLen = 0;
+};
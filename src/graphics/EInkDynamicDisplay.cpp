@@ -376,14 +376,29 @@ void EInkDynamicDisplay::resetRateLimiting()
 }
 
 // Generate a hash of this frame, to compare against previous update
+// 64-bit FNV-1a, consuming the buffer a 32-bit word at a time
 void EInkDynamicDisplay::hashImage()
 {
-    imageHash = 0;
+    const uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+    const uint64_t FNV_PRIME = 0x100000001b3ULL;
 
-    // Sum all bytes of the image buffer together
-    for (uint16_t b = 0; b < (displayWidth / 8) * displayHeight; b++) {
-        imageHash ^= buffer[b] << b;
+    uint64_t hash = FNV_OFFSET_BASIS;
+    const uint32_t words = displayBufferSize / sizeof(uint32_t);
+
+    for (uint32_t w = 0; w < words; w++) {
+        uint32_t word;
+        memcpy(&word, buffer + (w * sizeof(uint32_t)), sizeof(word)); // Buffer is not guaranteed to be word-aligned
+        hash ^= word;
+        hash *= FNV_PRIME;
+    }
+
+    // Any bytes left over, if buffer size isn't a multiple of 4
+    for (uint32_t b = words * sizeof(uint32_t); b < displayBufferSize; b++) {
+        hash ^= buffer[b];
+        hash *= FNV_PRIME;
     }
+
+    imageHash = hash;
 }
 
 // Store the results of determineMode() for future use, and reset for next call
@@ -413,21 +428,25 @@ void EInkDynamicDisplay::countGhostPixels()
     // Start a new count
     ghostPixelCount = 0;
 
-    // Check new image, bit by bit, for any white pixels at locations marked "dirty"
-    for (uint16_t i = 0; i < displayBufferSize; i++) {
-        for (uint8_t bit = 0; bit < 7; bit++) {
+    // Check new image, a word at a time, for any white pixels at locations marked "dirty"
+    // A pixel is a ghost if it is (or has been) black since last full-refresh, and now is white
+    const uint32_t words = displayBufferSize / sizeof(uint32_t);
+    for (uint32_t w = 0; w < words; w++) {
+        uint32_t dirty, image;
+        memcpy(&dirty, dirtyPixels + (w * sizeof(uint32_t)), sizeof(dirty));
+        memcpy(&image, buffer + (w * sizeof(uint32_t)), sizeof(image));
 
-            const bool dirty = (dirtyPixels[i] >> bit) & 1;       // Has pixel location been drawn to since full-refresh?
-            const bool shouldBeBlank = !((buffer[i] >> bit) & 1); // Is pixel location white in the new image?
+        ghostPixelCount += __builtin_popcount(dirty & ~image);
 
-            // If pixel is (or has been) black since last full-refresh, and now is white: ghosting
-            if (dirty && shouldBeBlank)
-                ghostPixelCount++;
+        // Update the dirty status - any black pixel will become a ghost if set white in future
+        dirty |= image;
+        memcpy(dirtyPixels + (w * sizeof(uint32_t)), &dirty, sizeof(dirty));
+    }
 
-            // Update the dirty status for this pixel - will this location become a ghost if set white in future?
-            if (!dirty && !shouldBeBlank)
-                dirtyPixels[i] |= (1 << bit);
-        }
+    // Any bytes left over, if buffer size isn't a multiple of 4
+    for (uint32_t i = words * sizeof(uint32_t); i < displayBufferSize; i++) {
+        ghostPixelCount += __builtin_popcount((uint8_t)(dirtyPixels[i] & ~buffer[i]));
+        dirtyPixels[i] |= buffer[i];
     }
 
     LOG_DEBUG("ghostPixels=%hu, ", ghostPixelCount);
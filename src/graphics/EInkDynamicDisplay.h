@@ -108,8 +108,8 @@ class EInkDynamicDisplay : public EInkDisplay, protected concurrency::NotifiedWo
 
     bool initialized = false;          // Have we drawn at least one frame yet?
     uint32_t previousRunMs = -1;       // When did determineMode() last run (rather than rejecting for rate-limiting)
-    uint32_t imageHash = 0;            // Hash of the current frame. Don't bother updating if nothing has changed!
-    uint32_t previousImageHash = 0;    // Hash of the previous update's frame
+    uint64_t imageHash = 0;            // Hash of the current frame. Don't bother updating if nothing has changed!
+    uint64_t previousImageHash = 0;    // Hash of the previous update's frame
     uint32_t fastRefreshCount = 0;     // How many fast-refreshes consecutively since last full refresh?
     refreshTypes currentConfig = FULL; // Which refresh type is GxEPD2 currently configured for
 
@@ -1007,37 +1007,70 @@ TFTDisplay::TFTDisplay(uint8_t address, int sda, int scl, OLEDDISPLAY_GEOMETRY g
 #endif
 }
 
+TFTDisplay::~TFTDisplay()
+{
+    delete[] linePixels;
+}
+
 // Write the buffer to the display memory
 void TFTDisplay::display(bool fromBlank)
 {
+    concurrency::LockGuard g(spiLock);
+
     if (fromBlank)
         tft->fillScreen(TFT_BLACK);
-    // tft->clear();
-    concurrency::LockGuard g(spiLock);
 
-    uint16_t x, y;
-
-    for (y = 0; y < displayHeight; y++) {
-        for (x = 0; x < displayWidth; x++) {
-            auto isset = buffer[x + (y / 8) * displayWidth] & (1 << (y & 7));
-            if (!fromBlank) {
-                // get src pixel in the page based ordering the OLED lib uses FIXME, super inefficent
-                auto dblbuf_isset = buffer_back[x + (y / 8) * displayWidth] & (1 << (y & 7));
-                if (isset != dblbuf_isset) {
-                    tft->drawPixel(x, y, isset ? TFT_MESH : TFT_BLACK);
-                }
-            } else if (isset) {
-                tft->drawPixel(x, y, TFT_MESH);
+    if (!linePixels) {
+        // One 8 row page worth of RGB565 pixels, enough to push any dirty tile in a single transfer
+        linePixels = new uint16_t[displayWidth * 8];
+    }
+
+    tft->startWrite();
+
+    // The OLED lib keeps pixels in page based ordering: each byte is a vertical strip of 8 pixels, so walk the buffer one
+    // page at a time and only push the bounding box of what changed within that page.  Panels such as the 135 and 170 pixel
+    // ones end in a partial page, which is clipped to the rows the panel has.
+    const uint16_t pages = (displayHeight + 7) / 8;
+    for (uint16_t page = 0; page < pages; page++) {
+        const uint8_t *src = buffer + page * displayWidth;
+        const uint8_t *back = buffer_back + page * displayWidth;
+
+        int16_t x0 = -1, x1 = -1;
+        uint8_t rowMask = 0; // Which of the 8 rows in this page have at least one changed pixel
+        for (uint16_t x = 0; x < displayWidth; x++) {
+            uint8_t changed = fromBlank ? src[x] : (src[x] ^ back[x]);
+            if (changed) {
+                if (x0 < 0)
+                    x0 = x;
+                x1 = x;
+                rowMask |= changed;
             }
         }
-    }
-    // Copy the Buffer to the Back Buffer
-    for (y = 0; y < (displayHeight / 8); y++) {
-        for (x = 0; x < displayWidth; x++) {
-            uint16_t pos = x + y * displayWidth;
-            buffer_back[pos] = buffer[pos];
+        const uint16_t pageRows = displayHeight - page * 8;
+        if (pageRows < 8)
+            rowMask &= (1 << pageRows) - 1;
+        if (!rowMask)
+            continue;
+
+        uint8_t r0 = __builtin_ctz(rowMask);
+        uint8_t r1 = 31 - __builtin_clz(rowMask);
+        uint16_t w = x1 - x0 + 1;
+        uint16_t h = r1 - r0 + 1;
+
+        // Expand the dirty tile to RGB565, row major as pushImage expects
+        uint16_t *dst = linePixels;
+        for (uint8_t r = r0; r <= r1; r++) {
+            const uint8_t bit = 1 << r;
+            for (uint16_t x = x0; x <= x1; x++)
+                *dst++ = (src[x] & bit) ? TFT_MESH : TFT_BLACK;
         }
+        tft->pushImage(x0, page * 8 + r0, w, h, linePixels);
     }
+
+    tft->endWrite();
+
+    // Copy the Buffer to the Back Buffer
+    memcpy(buffer_back, buffer, displayBufferSize);
 }
 
 // Send a command to the display (low level function)
@@ -1177,7 +1210,6 @@ bool TFTDisplay::connect()
     tft->setRotation(0);
 #elif defined(RAK14014)
     tft->setRotation(1);
-    tft->setSwapBytes(true);
     //    tft->fillScreen(TFT_BLACK);
     ft6336u.begin();
     pinMode(SCREEN_TOUCH_INT, INPUT_PULLUP);
@@ -1191,6 +1223,8 @@ bool TFTDisplay::connect()
 #else
     tft->setRotation(3); // Orient horizontal and wide underneath the silkscreen name label
 #endif
+    // display() pushes native RGB565 pixels, let the library do the byte swap for the bus
+    tft->setSwapBytes(true);
     tft->fillScreen(TFT_BLACK);
 
     return true;
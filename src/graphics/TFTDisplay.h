@@ -6,8 +6,9 @@
 /**
  * An adapter class that allows using the LovyanGFX library as if it was an OLEDDisplay implementation.
  *
+ * display() only pushes the bounding box of changed pixels within each 8 row page, using bulk pushImage writes.
+ *
  * Remaining TODO:
- * optimize display() to only draw changed pixels (see other OLED subclasses for examples)
  * Use the fast NRF52 SPI API rather than the slow standard arduino version
  *
  * turn radio back on - currently with both on spi bus is fucked? or are we leaving chip select asserted?
@@ -19,6 +20,7 @@ class TFTDisplay : public OLEDDisplay
     FIXME - the parameters are not used, just a temporary hack to keep working like the old displays
     */
     TFTDisplay(uint8_t, int, int, OLEDDISPLAY_GEOMETRY, HW_I2C);
+    ~TFTDisplay();
 
     // Write the buffer to the display memory
     virtual void display() override { display(false); };
@@ -57,4 +59,8 @@ class TFTDisplay : public OLEDDisplay
 
     // Connect to the display
     virtual bool connect() override;
+
+  private:
+    // Scratch RGB565 pixels for one dirty tile (at most displayWidth x 8), allocated on first display() and freed with us
+    uint16_t *linePixels = nullptr;
 };
\ No newline at end of file
@@ -45,6 +45,12 @@ void drawScaledXBitmap16x16(int x, int y, int width, int height, const uint8_t *
 static NodeListMode currentMode = MODE_LAST_HEARD;
 static int scrollIndex = 0;
 
+// Distances and bearings of the nodes drawn recently, indexed by node number.  Enough for a couple of screens of the list,
+// so scrolling and redrawing only redo the math for nodes which have moved.
+#define NODE_GEOMETRY_CACHE_SIZE 32
+static NodeGeometry geometryCache[NODE_GEOMETRY_CACHE_SIZE];
+static int32_t geometryLatitude, geometryLongitude; // Our position the cache is for
+
 // =============================
 // Utility Functions
 // =============================
@@ -74,6 +80,27 @@ const char *getSafeNodeName(meshtastic_NodeInfoLite *node)
     return nodeName;
 }
 
+const NodeGeometry &getNodeGeometry(int32_t ourLatitude, int32_t ourLongitude, const meshtastic_NodeInfoLite *node)
+{
+    if (ourLatitude != geometryLatitude || ourLongitude != geometryLongitude) {
+        // We have moved, so everything is stale
+        memset(geometryCache, 0, sizeof(geometryCache));
+        geometryLatitude = ourLatitude;
+        geometryLongitude = ourLongitude;
+    }
+
+    const meshtastic_PositionLite &p = node->position;
+    NodeGeometry &g = geometryCache[node->num % NODE_GEOMETRY_CACHE_SIZE];
+    if (g.num != node->num || g.latitude != p.latitude_i || g.longitude != p.longitude_i) {
+        g.num = node->num;
+        g.latitude = p.latitude_i;
+        g.longitude = p.longitude_i;
+        g.distanceMeters = GeoCoord::latLongToMeterFast(ourLatitude, ourLongitude, p.latitude_i, p.longitude_i);
+        g.bearing = GeoCoord::bearingFast(ourLatitude, ourLongitude, p.latitude_i, p.longitude_i);
+    }
+    return g;
+}
+
 const char *getCurrentModeTitle(int screenWidth)
 {
     switch (currentMode) {
@@ -231,22 +258,11 @@ void drawNodeDistance(OLEDDisplay *display, meshtastic_NodeInfoLite *node, int16
 
     meshtastic_NodeInfoLite *ourNode = nodeDB->getMeshNode(nodeDB->getNodeNum());
     if (nodeDB->hasValidPosition(ourNode) && nodeDB->hasValidPosition(node)) {
-        double lat1 = ourNode->position.latitude_i * 1e-7;
-        double lon1 = ourNode->position.longitude_i * 1e-7;
-        double lat2 = node->position.latitude_i * 1e-7;
-        double lon2 = node->position.longitude_i * 1e-7;
-
-        double earthRadiusKm = 6371.0;
-        double dLat = (lat2 - lat1) * DEG_TO_RAD;
-        double dLon = (lon2 - lon1) * DEG_TO_RAD;
-
-        double a =
-            sin(dLat / 2) * sin(dLat / 2) + cos(lat1 * DEG_TO_RAD) * cos(lat2 * DEG_TO_RAD) * sin(dLon / 2) * sin(dLon / 2);
-        double c = 2 * atan2(sqrt(a), sqrt(1 - a));
-        double distanceKm = earthRadiusKm * c;
+        float distanceKm =
+            getNodeGeometry(ourNode->position.latitude_i, ourNode->position.longitude_i, node).distanceMeters / 1000;
 
         if (config.display.units == meshtastic_Config_DisplayConfig_DisplayUnits_IMPERIAL) {
-            double miles = distanceKm * 0.621371;
+            float miles = distanceKm * 0.621371f;
             if (miles < 0.1) {
                 int feet = (int)(miles * 5280);
                 if (feet < 1000)
@@ -347,9 +363,7 @@ void drawCompassArrow(OLEDDisplay *display, meshtastic_NodeInfoLite *node, int16
     int centerX = x + columnWidth - arrowXOffset;
     int centerY = y + FONT_HEIGHT_SMALL / 2;
 
-    double nodeLat = node->position.latitude_i * 1e-7;
-    double nodeLon = node->position.longitude_i * 1e-7;
-    float bearing = GeoCoord::bearing(userLat, userLon, nodeLat, nodeLon);
+    float bearing = getNodeGeometry(lround(userLat * 1e7), lround(userLon * 1e7), node).bearing;
     float bearingToNode = RAD_TO_DEG * bearing;
     float relativeBearing = fmod((bearingToNode - myHeading + 360), 360);
     float angle = relativeBearing * DEG_TO_RAD;
@@ -49,6 +49,17 @@ void drawDistanceScreen(OLEDDisplay *display, OLEDDisplayUiState *state, int16_t
 void drawDynamicNodeListScreen(OLEDDisplay *display, OLEDDisplayUiState *state, int16_t x, int16_t y);
 void drawNodeListWithCompasses(OLEDDisplay *display, OLEDDisplayUiState *state, int16_t x, int16_t y);
 
+// Distance and bearing from our position to a node's
+struct NodeGeometry {
+    uint32_t num;
+    int32_t latitude, longitude; // The node's position they were computed for
+    float distanceMeters;
+    float bearing; // Radians, 0 is north
+};
+
+// The distance and bearing from our position (in 1e-7 degrees) to node, only recomputed when either position has changed
+const NodeGeometry &getNodeGeometry(int32_t ourLatitude, int32_t ourLongitude, const meshtastic_NodeInfoLite *node);
+
 // Utility functions
 const char *getCurrentModeTitle(int screenWidth);
 const char *getSafeNodeName(meshtastic_NodeInfoLite *node);
@@ -94,6 +94,7 @@ NRF52Bluetooth *nrf52Bluetooth = nullptr;
 #include "linux/LinuxHardwareI2C.h"
 #include "mesh/raspihttp/PiWebServer.h"
 #include "platform/portduino/PortduinoGlue.h"
+#include "platform/portduino/TimeSource.h"
 #include "platform/portduino/USBHal.h"
 #include <cstdlib>
 #include <fstream>
@@ -1573,7 +1574,11 @@ void loop()
 
     // We want to sleep as long as possible here - because it saves power
     if (!runASAP && loopCanSleep()) {
+#ifdef ARCH_PORTDUINO
+        timeSource->idle(delayMsec);
+#else
         mainDelay.delay(delayMsec);
+#endif
     }
 }
 #endif
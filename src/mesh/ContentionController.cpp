@@ -0,0 +1,23 @@
+#include "ContentionController.h"
+
+void ContentionController::raise(float step)
+{
+    if (mode == CONTENTION_FIXED)
+        return;
+    backoff += step;
+    if (backoff > MAX_BACKOFF)
+        backoff = MAX_BACKOFF;
+}
+
+void ContentionController::onTxClean()
+{
+    backoff -= TX_CLEAN_STEP;
+    if (backoff < 0)
+        backoff = 0;
+}
+
+uint8_t ContentionController::adjust(uint8_t cwSize, uint8_t cwMax) const
+{
+    uint8_t adjusted = cwSize + (uint8_t)backoff;
+    return adjusted < cwMax ? adjusted : cwMax;
+}
@@ -233,24 +233,35 @@ void CryptoEngine::decrypt(uint32_t fromNode, uint64_t packetId, size_t numBytes
     encryptPacket(fromNode, packetId, numBytes, bytes);
 }
 
+void CryptoEngine::decrypt(uint32_t fromNode, uint64_t packetId, size_t numBytes, const uint8_t *in, uint8_t *out)
+{
+    if (key.length > 0 && numBytes <= MAX_BLOCKSIZE) {
+        initNonce(fromNode, packetId);
+        encryptAESCtr(key, nonce, numBytes, in, out);
+        return;
+    }
+    if (key.length > 0)
+        LOG_ERROR("Packet too large for crypto engine: %d. noop encryption!", numBytes);
+    memcpy(out, in, numBytes); // As encryptPacket, which leaves the bytes as they are
+}
+
 // Generic implementation of AES-CTR encryption.
-void CryptoEngine::encryptAESCtr(CryptoKey _key, uint8_t *_nonce, size_t numBytes, uint8_t *bytes)
+void CryptoEngine::encryptAESCtr(CryptoKey _key, uint8_t *_nonce, size_t numBytes, const uint8_t *in, uint8_t *out)
 {
-    delete ctr;
-    ctr = nullptr;
-    if (_key.length == 16)
-        ctr = new CTR<AES128>();
-    else
-        ctr = new CTR<AES256>();
+    // Keep the cipher between packets, only the key length decides which one we need
+    if (!ctr || ctrKeyLength != _key.length) {
+        delete ctr;
+        if (_key.length == 16)
+            ctr = new CTR<AES128>();
+        else
+            ctr = new CTR<AES256>();
+        ctrKeyLength = _key.length;
+    }
     ctr->setKey(_key.bytes, _key.length);
-    static uint8_t scratch[MAX_BLOCKSIZE];
-    memcpy(scratch, bytes, numBytes);
-    memset(scratch + numBytes, 0,
-           sizeof(scratch) - numBytes); // Fill rest of buffer with zero (in case cypher looks at it)
-
     ctr->setIV(_nonce, 16);
     ctr->setCounterSize(4);
-    ctr->encrypt(bytes, scratch, numBytes);
+    // CTR only XORs the key stream over numBytes, so it can work in place and never reads past the end
+    ctr->encrypt(out, in, numBytes);
 }
 
 /**
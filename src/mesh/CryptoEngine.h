@@ -71,7 +71,20 @@ class CryptoEngine
      */
     virtual void encryptPacket(uint32_t fromNode, uint64_t packetId, size_t numBytes, uint8_t *bytes);
     virtual void decrypt(uint32_t fromNode, uint64_t packetId, size_t numBytes, uint8_t *bytes);
-    virtual void encryptAESCtr(CryptoKey key, uint8_t *nonce, size_t numBytes, uint8_t *bytes);
+
+    /**
+     * Decrypt a packet into another buffer
+     *
+     * @param in is left untouched, so the ciphertext is still there if the plaintext turns out to be garbage
+     */
+    virtual void decrypt(uint32_t fromNode, uint64_t packetId, size_t numBytes, const uint8_t *in, uint8_t *out);
+
+    void encryptAESCtr(CryptoKey key, uint8_t *nonce, size_t numBytes, uint8_t *bytes)
+    {
+        encryptAESCtr(key, nonce, numBytes, bytes, bytes);
+    }
+    /// AES-CTR from in to out, which may be the same buffer
+    virtual void encryptAESCtr(CryptoKey key, uint8_t *nonce, size_t numBytes, const uint8_t *in, uint8_t *out);
 #ifndef PIO_UNIT_TESTING
   protected:
 #endif
@@ -79,6 +92,7 @@ class CryptoEngine
     uint8_t nonce[16] = {0};
     CryptoKey key = {};
     CTRCommon *ctr = NULL;
+    uint8_t ctrKeyLength = 0; // The key length ctr was made for
 #if !(MESHTASTIC_EXCLUDE_PKI)
     uint8_t shared_key[32] = {0};
     uint8_t private_key[32] = {0};
@@ -43,24 +43,48 @@ bool FloodingRouter::shouldFilterReceived(const meshtastic_MeshPacket *p)
     return Router::shouldFilterReceived(p);
 }
 
-void FloodingRouter::perhapsCancelDupe(const meshtastic_MeshPacket *p)
+bool FloodingRouter::shouldFilterDupeHeader(const RxHeader &h)
 {
-    if (config.device.role != meshtastic_Config_DeviceConfig_Role_ROUTER &&
-        config.device.role != meshtastic_Config_DeviceConfig_Role_REPEATER &&
-        config.device.role != meshtastic_Config_DeviceConfig_Role_ROUTER_LATE) {
-        // cancel rebroadcast of this message *if* there was already one, unless we're a router/repeater!
-        if (Router::cancelSending(p->from, p->id))
-            txRelayCanceled++;
+    // A repeated reliable transmission might need relaying again, which takes the whole packet
+    if (h.hop_start > 0 && h.hop_start == h.hop_limit)
+        return false;
+    if (!recordIfSeenRecently(h.from, h.id, h.next_hop, h.relay_node))
+        return false;
+
+    rxDupe++;
+    perhapsCancelDupe(h.from, h.id, h.relay_node);
+    return true;
+}
+
+void FloodingRouter::perhapsCancelDupe(NodeNum from, PacketId id, uint8_t relayNode)
+{
+    if (iface)
+        iface->onDuplicateHeard();
+    // cancel rebroadcast of this message *if* there was already one, unless enough others have relayed it for us
+    if (suppressor.onDuplicate(from, id, relayNode, isRouterRole(config.device.role)) && Router::cancelSending(from, id)) {
+        txRelayCanceled++;
+        return;
     }
     if (config.device.role == meshtastic_Config_DeviceConfig_Role_ROUTER_LATE && iface) {
-        iface->clampToLateRebroadcastWindow(getFrom(p), p->id);
+        iface->clampToLateRebroadcastWindow(from, id);
     }
 }
 
 bool FloodingRouter::isRebroadcaster()
 {
-    return config.device.role != meshtastic_Config_DeviceConfig_Role_CLIENT_MUTE &&
-           config.device.rebroadcast_mode != meshtastic_Config_DeviceConfig_RebroadcastMode_NONE;
+    return isRebroadcaster(config.device.role, config.device.rebroadcast_mode);
+}
+
+bool FloodingRouter::isRebroadcaster(meshtastic_Config_DeviceConfig_Role role,
+                                     meshtastic_Config_DeviceConfig_RebroadcastMode mode)
+{
+    return role != meshtastic_Config_DeviceConfig_Role_CLIENT_MUTE && mode != meshtastic_Config_DeviceConfig_RebroadcastMode_NONE;
+}
+
+bool FloodingRouter::isRouterRole(meshtastic_Config_DeviceConfig_Role role)
+{
+    return role == meshtastic_Config_DeviceConfig_Role_ROUTER || role == meshtastic_Config_DeviceConfig_Role_REPEATER ||
+           role == meshtastic_Config_DeviceConfig_Role_ROUTER_LATE;
 }
 
 void FloodingRouter::perhapsRebroadcast(const meshtastic_MeshPacket *p)
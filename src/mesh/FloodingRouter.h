@@ -1,5 +1,6 @@
 #pragma once
 
+#include "RebroadcastSuppressor.h"
 #include "Router.h"
 
 /**
@@ -28,6 +29,9 @@
 class FloodingRouter : public Router
 {
   private:
+    /// Decides whether duplicates we overhear cancel our pending rebroadcasts
+    RebroadcastSuppressor suppressor;
+
     /* Check if we should rebroadcast this packet, and do so if needed */
     void perhapsRebroadcast(const meshtastic_MeshPacket *p);
 
@@ -45,6 +49,12 @@ class FloodingRouter : public Router
      */
     virtual ErrorCode send(meshtastic_MeshPacket *p) override;
 
+    /// Routers and repeaters, which are placed to cover more than a client, so keep relaying when others already have
+    static bool isRouterRole(meshtastic_Config_DeviceConfig_Role role);
+
+    /// Whether a node with this role and rebroadcast mode relays packets from other nodes at all
+    static bool isRebroadcaster(meshtastic_Config_DeviceConfig_Role role, meshtastic_Config_DeviceConfig_RebroadcastMode mode);
+
   protected:
     /**
      * Should this incoming filter be dropped?
@@ -54,13 +64,16 @@ class FloodingRouter : public Router
      */
     virtual bool shouldFilterReceived(const meshtastic_MeshPacket *p) override;
 
+    virtual bool shouldFilterDupeHeader(const RxHeader &h) override;
+
     /**
      * Look for broadcasts we need to rebroadcast
      */
     virtual void sniffReceived(const meshtastic_MeshPacket *p, const meshtastic_Routing *c) override;
 
     /* Call when receiving a duplicate packet to check whether we should cancel a packet in the Tx queue */
-    void perhapsCancelDupe(const meshtastic_MeshPacket *p);
+    void perhapsCancelDupe(const meshtastic_MeshPacket *p) { perhapsCancelDupe(getFrom(p), p->id, p->relay_node); }
+    void perhapsCancelDupe(NodeNum from, PacketId id, uint8_t relayNode);
 
     // Return true if we are a rebroadcaster
     bool isRebroadcaster();
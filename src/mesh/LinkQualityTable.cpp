@@ -0,0 +1,105 @@
+#include "LinkQualityTable.h"
+#include <string.h>
+
+static_assert(LINK_QUALITY_MAX_NEIGHBOURS < 0xff, "LinkQualityTable indexes its entries with a byte");
+
+LinkQualityTable linkQuality;
+
+LinkQualityTable::LinkQualityTable()
+{
+    clear();
+}
+
+void LinkQualityTable::clear()
+{
+    numLinks = 0;
+    memset(index, NO_LINK, sizeof(index));
+}
+
+void LinkQualityTable::onReceive(uint8_t relayNode, NodeNum direct, float snr, int32_t rssi, uint32_t nowMs)
+{
+    if (direct)
+        relayNode = getRelayByte(direct);
+    if (relayNode == NO_RELAY_NODE)
+        return; // Old firmware, we can't tell who transmitted it
+
+    LinkQuality *l = find(relayNode);
+    if (l && direct && l->num && l->num != direct)
+        l = NULL; // Another node with the same last byte, which we now hear instead
+    if (!l) {
+        l = add(relayNode, nowMs);
+        l->snr = snr;
+        l->rssi = rssi;
+    } else {
+        l->snr += (snr - l->snr) * EWMA_WEIGHT;
+        l->rssi += (rssi - l->rssi) * EWMA_WEIGHT;
+    }
+    if (direct)
+        l->num = direct;
+    if (l->heard < UINT16_MAX)
+        l->heard++;
+    l->lastHeardMs = nowMs;
+}
+
+void LinkQualityTable::onDelivered(uint8_t relayNode)
+{
+    LinkQuality *l = find(relayNode);
+    if (!l)
+        return;
+    if (l->delivered < UINT16_MAX)
+        l->delivered++;
+    l->failed = 0;
+}
+
+void LinkQualityTable::onFailed(uint8_t relayNode)
+{
+    LinkQuality *l = find(relayNode);
+    if (l && l->failed < UINT8_MAX)
+        l->failed++;
+}
+
+const LinkQuality *LinkQualityTable::get(uint8_t relayNode) const
+{
+    uint8_t i = index[relayNode];
+    return i == NO_LINK ? NULL : &links[i];
+}
+
+const LinkQuality *LinkQualityTable::getNode(NodeNum num) const
+{
+    const LinkQuality *l = get(getRelayByte(num));
+    return l && l->num == num ? l : NULL;
+}
+
+bool LinkQualityTable::isUnreliable(uint8_t relayNode, uint32_t nowMs) const
+{
+    const LinkQuality *l = get(relayNode);
+    return l && (l->failed >= MAX_FAILURES || nowMs - l->lastHeardMs > STALE_MS);
+}
+
+LinkQuality *LinkQualityTable::find(uint8_t relayNode)
+{
+    uint8_t i = index[relayNode];
+    return i == NO_LINK ? NULL : &links[i];
+}
+
+/// A fresh entry for relayNode, replacing any it had, or the least recently heard one if we are full
+LinkQuality *LinkQualityTable::add(uint8_t relayNode, uint32_t nowMs)
+{
+    uint8_t i = index[relayNode];
+    if (i == NO_LINK) {
+        if (numLinks < LINK_QUALITY_MAX_NEIGHBOURS) {
+            i = numLinks++;
+        } else {
+            i = 0;
+            for (uint8_t j = 1; j < numLinks; j++)
+                if (nowMs - links[j].lastHeardMs > nowMs - links[i].lastHeardMs)
+                    i = j;
+            index[links[i].relayNode] = NO_LINK;
+        }
+        index[relayNode] = i;
+    }
+    LinkQuality *l = &links[i];
+    memset(l, 0, sizeof(*l));
+    l->relayNode = relayNode;
+    return l;
+}
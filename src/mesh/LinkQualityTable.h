@@ -0,0 +1,100 @@
+#pragma once
+
+#include "MeshTypes.h"
+
+// How many neighbours we keep link estimates for, the least recently heard is forgotten to make room
+#ifndef LINK_QUALITY_MAX_NEIGHBOURS
+#define LINK_QUALITY_MAX_NEIGHBOURS 32
+#endif
+
+/// What we know of the link from a neighbour, i.e. a node whose transmissions we hear directly
+struct LinkQuality {
+    NodeNum num;          // 0 if we have only heard it relaying, so only know the last byte of its node number
+    uint8_t relayNode;    // The last byte of its node number, as it appears in relay_node and next_hop
+    uint8_t failed;       // Packets we gave it as next hop which it never relayed, since the last one it did
+    uint16_t heard;       // Frames heard from it, saturating
+    uint16_t delivered;   // Packets we gave it as next hop which we then heard it relay, saturating
+    uint32_t lastHeardMs; // millis() of the last frame heard from it
+    float snr;            // Smoothed SNR (dB) and RSSI (dBm) of its frames
+    float rssi;
+};
+
+/**
+ * Link estimates for our neighbours, keyed by relay byte and node number, and updated from every frame the radio receives.
+ *
+ * The last byte of a node number is all most frames tell us about the node that transmitted them, so entries are found
+ * through a 256 entry index on that byte, and every update and lookup is O(1).  SNR and RSSI are exponentially weighted moving
+ * averages, so a single faded or lucky frame doesn't decide how we route or how long we wait to rebroadcast.
+ */
+class LinkQualityTable
+{
+  public:
+    LinkQualityTable();
+
+    /**
+     * Note a frame heard from the radio
+     * @param relayNode the relay_node of the frame, NO_RELAY_NODE if it didn't have one
+     * @param direct the full node number of the transmitter if the frame wasn't relayed (hop_start == hop_limit), else 0
+     * @param nowMs the time it was heard, millis() unless the caller keeps its own clock
+     */
+    void onReceive(uint8_t relayNode, NodeNum direct, float snr, int32_t rssi, uint32_t nowMs);
+    void onReceive(uint8_t relayNode, NodeNum direct, float snr, int32_t rssi)
+    {
+        onReceive(relayNode, direct, snr, rssi, millis());
+    }
+
+    void onReceive(const meshtastic_MeshPacket *p)
+    {
+        bool isDirect = p->hop_start != 0 && p->hop_start == p->hop_limit;
+        onReceive(p->relay_node, isDirect ? p->from : 0, p->rx_snr, p->rx_rssi);
+    }
+
+    /// A neighbour relayed a packet we gave it as next hop
+    void onDelivered(uint8_t relayNode);
+
+    /// A neighbour never relayed a packet we gave it as next hop
+    void onFailed(uint8_t relayNode);
+
+    /// @return the neighbour with this relay byte, or NULL if we haven't heard it
+    const LinkQuality *get(uint8_t relayNode) const;
+
+    /// @return the neighbour with this node number, or NULL if we haven't heard it directly
+    const LinkQuality *getNode(NodeNum num) const;
+
+    /**
+     * The SNR to weight our relay delay for a frame by: the smoothed SNR of the neighbour it came from if that was its sender,
+     * otherwise sample, the SNR of the frame itself.  A relay byte alone could stand for any node ending in it.
+     */
+    float getRelayWeightSnr(NodeNum from, bool fromSender, float sample) const
+    {
+        const LinkQuality *l = fromSender ? getNode(from) : NULL;
+        return l ? l->snr : sample;
+    }
+
+    /// True if we know this neighbour and have stopped hearing it, or it keeps failing to relay for us
+    bool isUnreliable(uint8_t relayNode, uint32_t nowMs) const;
+    bool isUnreliable(uint8_t relayNode) const { return isUnreliable(relayNode, millis()); }
+
+    size_t size() const { return numLinks; }
+
+    /// For walking the whole table, in no particular order
+    const LinkQuality &at(size_t i) const { return links[i]; }
+
+    void clear();
+
+  private:
+    static constexpr float EWMA_WEIGHT = 0.25f;              // How much each new frame moves the averages
+    static constexpr uint8_t MAX_FAILURES = 2;               // Failures in a row before we stop trusting a next hop
+    static constexpr uint32_t STALE_MS = 2 * 60 * 60 * 1000; // A neighbour silent this long has probably gone
+
+    static constexpr uint8_t NO_LINK = 0xff;
+
+    LinkQuality links[LINK_QUALITY_MAX_NEIGHBOURS];
+    uint8_t numLinks = 0;
+    uint8_t index[256]; // links[] position by relay byte, or NO_LINK
+
+    LinkQuality *find(uint8_t relayNode);
+    LinkQuality *add(uint8_t relayNode, uint32_t nowMs);
+};
+
+extern LinkQualityTable linkQuality;
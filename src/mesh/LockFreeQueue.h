@@ -0,0 +1,259 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+#include "concurrency/OSThread.h"
+#include "configuration.h"
+#include "freertosinc.h"
+
+// Indices written by different threads are kept this far apart, so a producer and a consumer on different cores don't keep
+// stealing the same cache line from each other
+#ifndef QUEUE_CACHE_LINE_SIZE
+#if defined(ARCH_PORTDUINO)
+#define QUEUE_CACHE_LINE_SIZE 64
+#elif defined(ARCH_ESP32)
+#define QUEUE_CACHE_LINE_SIZE 32
+#else
+#define QUEUE_CACHE_LINE_SIZE 4 // No data cache
+#endif
+#endif
+
+// MPMCTypedQueue needs compare-and-swap.  Cortex-M0+ (no LDREX/STREX) and RISC-V cores without the A extension (ESP32-C3)
+// don't have it, so std::atomic turns it into library calls which mask interrupts, and MPMCPointerQueue uses TypedQueue there.
+// The RP2350 is treated like the RP2040, as both build as ARCH_RP2040.
+#ifndef QUEUE_HAS_NATIVE_CAS
+#if defined(ARCH_RP2040) || defined(__ARM_ARCH_6M__) || (defined(__riscv) && !defined(__riscv_atomic))
+#define QUEUE_HAS_NATIVE_CAS 0
+#else
+#define QUEUE_HAS_NATIVE_CAS 1
+#endif
+#endif
+
+/**
+ * A TypedQueue for exactly one producer thread and exactly one consumer thread, without locks or critical sections.
+ *
+ * Each side only writes its own index and keeps a cached copy of the other one, so in the common case an enqueue or dequeue
+ * touches no memory the other thread writes.  Only plain atomic loads and stores are used, which every core we run on has.
+ *
+ * Nothing here blocks: maxWait is accepted for compatibility with TypedQueue, but a full or empty queue fails at once.
+ */
+template <class T> class SPSCTypedQueue
+{
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+  public:
+    explicit SPSCTypedQueue(int maxElements) : capacity(maxElements), mask(slotsFor(maxElements) - 1)
+    {
+        assert(maxElements > 0);
+        slots = new T[mask + 1];
+    }
+
+    ~SPSCTypedQueue() { delete[] slots; }
+
+    SPSCTypedQueue(const SPSCTypedQueue &) = delete;
+    SPSCTypedQueue &operator=(const SPSCTypedQueue &) = delete;
+
+    int numFree() { return (int)capacity - numUsed(); }
+
+    bool isEmpty() { return numUsed() == 0; }
+
+    /** Exact from the producer or consumer, a snapshot from anywhere else */
+    int numUsed()
+    {
+        // head never passes tail, so reading it first can't give a negative depth
+        size_t dequeued = head.load(std::memory_order_acquire);
+        return (int)(tail.load(std::memory_order_acquire) - dequeued);
+    }
+
+    /** Producer side */
+    bool enqueue(T x, TickType_t maxWait = 0)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - headCache >= capacity) {
+            headCache = head.load(std::memory_order_acquire);
+            if (t - headCache >= capacity)
+                return false;
+        }
+        slots[t & mask] = x;
+        tail.store(t + 1, std::memory_order_release);
+
+        if ((int)(t + 1 - headCache) > highWater)
+            highWater = t + 1 - headCache;
+        if (reader) {
+            reader->setInterval(0);
+            concurrency::mainDelay.interrupt();
+        }
+        return true;
+    }
+
+    /** Consumer side */
+    bool dequeue(T *p, TickType_t maxWait = 0)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tailCache) {
+            tailCache = tail.load(std::memory_order_acquire);
+            if (h == tailCache)
+                return false;
+        }
+        *p = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** The most elements the queue has held, for sizing it.  Can overestimate, as the producer only looks at its cached head */
+    int highWaterMark() const { return highWater; }
+
+    void setReader(concurrency::OSThread *t) { reader = t; }
+
+  private:
+    static size_t slotsFor(int maxElements)
+    {
+        size_t n = 1;
+        while (n < (size_t)maxElements)
+            n <<= 1;
+        return n;
+    }
+
+    // Set up once, then only read
+    const size_t capacity;
+    const size_t mask;
+    T *slots;
+    concurrency::OSThread *reader = NULL;
+
+    // Written by the consumer.  head and tail count every element ever dequeued / enqueued, so tail - head is the depth.
+    alignas(QUEUE_CACHE_LINE_SIZE) std::atomic<size_t> head{0};
+    size_t tailCache = 0;
+
+    // Written by the producer
+    alignas(QUEUE_CACHE_LINE_SIZE) std::atomic<size_t> tail{0};
+    size_t headCache = 0;
+    int highWater = 0;
+};
+
+/**
+ * A TypedQueue any number of threads may enqueue to and dequeue from, without locks.
+ *
+ * Dmitry Vyukov's bounded queue: every slot carries a sequence number saying whose turn it is, so a thread only has to win a
+ * compare-and-swap on the shared position to own a slot.  Use it where the queue is fed from more than one thread, or where
+ * the producer drops the oldest element itself when the queue is full.
+ *
+ * Nothing here blocks: maxWait is accepted for compatibility with TypedQueue, but a full or empty queue fails at once.
+ * Only use it directly where QUEUE_HAS_NATIVE_CAS, MPMCPointerQueue takes care of that.
+ */
+template <class T> class MPMCTypedQueue
+{
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+  public:
+    explicit MPMCTypedQueue(int maxElements) : capacity(maxElements), mask(slotsFor(maxElements) - 1)
+    {
+        assert(maxElements > 0);
+        cells = new Cell[mask + 1];
+        for (size_t i = 0; i <= mask; i++)
+            cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    ~MPMCTypedQueue() { delete[] cells; }
+
+    MPMCTypedQueue(const MPMCTypedQueue &) = delete;
+    MPMCTypedQueue &operator=(const MPMCTypedQueue &) = delete;
+
+    int numFree() { return (int)capacity - numUsed(); }
+
+    bool isEmpty() { return numUsed() == 0; }
+
+    /** A snapshot, other threads may have changed it by the time it returns */
+    int numUsed()
+    {
+        // dequeuePos never passes enqueuePos, so reading it first can't give a negative depth
+        size_t dequeued = dequeuePos.load(std::memory_order_acquire);
+        size_t used = enqueuePos.load(std::memory_order_acquire) - dequeued;
+        return used > capacity ? (int)capacity : (int)used;
+    }
+
+    bool enqueue(T x, TickType_t maxWait = 0)
+    {
+        Cell *c;
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            c = &cells[pos & mask];
+            intptr_t dif = (intptr_t)(c->seq.load(std::memory_order_acquire) - pos);
+            if (dif == 0) {
+                // The slot is free, but we also keep to the capacity we were asked for, which may be less than the slots
+                if (pos - dequeuePos.load(std::memory_order_relaxed) >= capacity)
+                    return false;
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (dif < 0) {
+                return false; // Full
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        c->value = x;
+        c->seq.store(pos + 1, std::memory_order_release);
+
+        int used = numUsed();
+        if (used > highWater.load(std::memory_order_relaxed))
+            highWater.store(used, std::memory_order_relaxed); // Racy, but only ever a statistic
+        if (reader) {
+            reader->setInterval(0);
+            concurrency::mainDelay.interrupt();
+        }
+        return true;
+    }
+
+    bool dequeue(T *p, TickType_t maxWait = 0)
+    {
+        Cell *c;
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            c = &cells[pos & mask];
+            intptr_t dif = (intptr_t)(c->seq.load(std::memory_order_acquire) - (pos + 1));
+            if (dif == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (dif < 0) {
+                return false; // Empty
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        *p = c->value;
+        c->seq.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** The most elements the queue has held, for sizing it */
+    int highWaterMark() const { return highWater.load(std::memory_order_relaxed); }
+
+    void setReader(concurrency::OSThread *t) { reader = t; }
+
+  private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    static size_t slotsFor(int maxElements)
+    {
+        size_t n = 2; // A single slot can't tell "ready to read" from "ready to write" apart
+        while (n < (size_t)maxElements)
+            n <<= 1;
+        return n;
+    }
+
+    // Set up once, then only read
+    const size_t capacity;
+    const size_t mask;
+    Cell *cells;
+    concurrency::OSThread *reader = NULL;
+    std::atomic<int> highWater{0};
+
+    alignas(QUEUE_CACHE_LINE_SIZE) std::atomic<size_t> enqueuePos{0};
+    alignas(QUEUE_CACHE_LINE_SIZE) std::atomic<size_t> dequeuePos{0};
+};
@@ -166,6 +166,22 @@ NodeNum MeshService::getNodenumFromRequestId(uint32_t request_id)
     return nodenum;
 }
 
+void MeshService::returnToPhone(meshtastic_MeshPacket *const *packets, size_t count)
+{
+    int queued = toPhoneQueue.numUsed();
+    for (size_t i = 0; i < count; i++) {
+        if (toPhoneQueue.enqueue(packets[i], 0) == false) {
+            LOG_WARN("ToPhone queue is full, drop returned packet");
+            releaseToPool(packets[i]);
+        }
+    }
+    // Then cycle what was already waiting round behind them, as getNodenumFromRequestId does
+    for (int i = 0; i < queued; i++)
+        toPhoneQueue.enqueue(toPhoneQueue.dequeuePtr(0), 0);
+    if (count)
+        fromNum++;
+}
+
 /**
  *  Given a ToRadio buffer parse it and properly handle it (setup radio, owner or send packet into the mesh)
  * Called by PhoneAPI.handleToRadio.  Note: p is a scratch buffer, this function is allowed to write to it but it can not keep a
@@ -37,13 +37,13 @@ class MeshService
     /// FIXME, change to a DropOldestQueue and keep a count of the number of dropped packets to ensure
     /// we never hang because android hasn't been there in a while
     /// FIXME - save this to flash on deep sleep
-    PointerQueue<meshtastic_MeshPacket> toPhoneQueue;
+    MPMCPointerQueue<meshtastic_MeshPacket> toPhoneQueue;
 
     // keep list of QueueStatus packets to be send to the phone
     PointerQueue<meshtastic_QueueStatus> toPhoneQueueStatusQueue;
 
     // keep list of MqttClientProxyMessages to be send to the client for delivery
-    PointerQueue<meshtastic_MqttClientProxyMessage> toPhoneMqttProxyQueue;
+    MPMCPointerQueue<meshtastic_MqttClientProxyMessage> toPhoneMqttProxyQueue;
 
     // keep list of ClientNotifications to be send to the client (phone)
     PointerQueue<meshtastic_ClientNotification> toPhoneClientNotificationQueue;
@@ -84,6 +84,9 @@ class MeshService
     /// last few packets if needs to.
     meshtastic_MeshPacket *getForPhone() { return toPhoneQueue.dequeuePtr(0); }
 
+    /// Put packets a phone was handed but never read back at the front of the queue, oldest first
+    void returnToPhone(meshtastic_MeshPacket *const *packets, size_t count);
+
     /// Allows the bluetooth handler to free packets after they have been sent
     void releaseToPool(meshtastic_MeshPacket *p) { packetPool.release(p); }
 
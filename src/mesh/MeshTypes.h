@@ -45,6 +45,12 @@ enum RxSource {
 // For old firmware there is no relay node set
 #define NO_RELAY_NODE 0
 
+/// The last byte of a NodeNum, as used for relay_node and next_hop.  0 means neither is set, so 0x00 becomes 0xFF.
+inline uint8_t getRelayByte(NodeNum num)
+{
+    return (uint8_t)((num & 0xFF) ? (num & 0xFF) : 0xFF);
+}
+
 typedef int ErrorCode;
 
 /// Alloc and free packets to our global, ISR safe pool
@@ -1,4 +1,5 @@
 #include "NextHopRouter.h"
+#include "LinkQualityTable.h"
 
 NextHopRouter::NextHopRouter() {}
 
@@ -20,9 +21,7 @@ ErrorCode NextHopRouter::send(meshtastic_MeshPacket *p)
     p->next_hop = getNextHop(p->to, p->relay_node); // set the next hop
     LOG_DEBUG("Setting next hop for packet with dest %x to %x", p->to, p->next_hop);
 
-    // If it's from us, ReliableRouter already handles retransmissions if want_ack is set. If a next hop is set and hop limit is
-    // not 0 or want_ack is set, start retransmissions
-    if ((!isFromUs(p) || !p->want_ack) && p->next_hop != NO_NEXT_HOP_PREFERENCE && (p->hop_limit > 0 || p->want_ack))
+    if (needsRetransmission(isFromUs(p), p->want_ack, p->next_hop, p->hop_limit))
         startRetransmission(packetPool.allocCopy(*p)); // start retransmission for relayed packet
 
     return Router::send(p);
@@ -35,23 +34,26 @@ bool NextHopRouter::shouldFilterReceived(const meshtastic_MeshPacket *p)
     if (wasSeenRecently(p, true, &wasFallback, &weWereNextHop)) { // Note: this will also add a recent packet record
         printPacket("Ignore dupe incoming msg", p);
         rxDupe++;
+        noteRelayed(p->from, p->id, p->relay_node);
         stopRetransmission(p->from, p->id);
 
-        // If it was a fallback to flooding, try to relay again
-        if (wasFallback) {
+        switch (getDupeAction(wasFallback, weWereNextHop, p->hop_start, p->hop_limit)) {
+        case DUPE_RELAY_AGAIN:
             LOG_INFO("Fallback to flooding from relay_node=0x%x", p->relay_node);
             // Check if it's still in the Tx queue, if not, we have to relay it again
             if (!findInTxQueue(p->from, p->id))
                 perhapsRelay(p);
-        } else {
-            bool isRepeated = p->hop_start > 0 && p->hop_start == p->hop_limit;
-            // If repeated and not in Tx queue anymore, try relaying again, or if we are the destination, send the ACK again
-            if (isRepeated) {
-                if (!findInTxQueue(p->from, p->id) && !perhapsRelay(p) && isToUs(p) && p->want_ack)
-                    sendAckNak(meshtastic_Routing_Error_NONE, getFrom(p), p->id, p->channel, 0);
-            } else if (!weWereNextHop) {
-                perhapsCancelDupe(p); // If it's a dupe, cancel relay if we were not explicitly asked to relay
-            }
+            break;
+        case DUPE_RELAY_OR_ACK_AGAIN:
+            // If not in Tx queue anymore, try relaying again, or if we are the destination, send the ACK again
+            if (!findInTxQueue(p->from, p->id) && !perhapsRelay(p) && isToUs(p) && p->want_ack)
+                sendAckNak(meshtastic_Routing_Error_NONE, getFrom(p), p->id, p->channel, 0);
+            break;
+        case DUPE_CANCEL:
+            perhapsCancelDupe(p); // If it's a dupe, cancel relay if we were not explicitly asked to relay
+            break;
+        case DUPE_IGNORE:
+            break;
         }
         return true;
     }
@@ -59,6 +61,24 @@ bool NextHopRouter::shouldFilterReceived(const meshtastic_MeshPacket *p)
     return Router::shouldFilterReceived(p);
 }
 
+bool NextHopRouter::shouldFilterDupeHeader(const RxHeader &h)
+{
+    // Repeated transmissions and fallbacks to flooding might need relaying or acknowledging again, which takes the whole packet
+    if (h.hop_start > 0 && h.hop_start == h.hop_limit)
+        return false;
+    bool wasFallback = false;
+    bool weWereNextHop = false;
+    if (!recordIfSeenRecently(h.from, h.id, h.next_hop, h.relay_node, &wasFallback, &weWereNextHop) || wasFallback)
+        return false;
+
+    rxDupe++;
+    noteRelayed(h.from, h.id, h.relay_node);
+    stopRetransmission(h.from, h.id);
+    if (!weWereNextHop)
+        perhapsCancelDupe(h.from, h.id, h.relay_node);
+    return true;
+}
+
 void NextHopRouter::sniffReceived(const meshtastic_MeshPacket *p, const meshtastic_Routing *c)
 {
     NodeNum ourNodeNum = getNodeNum();
@@ -71,10 +91,9 @@ void NextHopRouter::sniffReceived(const meshtastic_MeshPacket *p, const meshtast
         if (p->from != 0) {
             meshtastic_NodeInfoLite *origTx = nodeDB->getMeshNode(p->from);
             if (origTx) {
-                // Either relayer of ACK was also a relayer of the packet, or we were the relayer and the ACK came directly from
-                // the destination
-                if (wasRelayer(p->relay_node, p->decoded.request_id, p->to) ||
-                    (wasRelayer(ourRelayID, p->decoded.request_id, p->to) && p->hop_start != 0 && p->hop_start == p->hop_limit)) {
+                if (shouldLearnNextHop(wasRelayer(p->relay_node, p->decoded.request_id, p->to),
+                                       wasRelayer(ourRelayID, p->decoded.request_id, p->to), p->hop_start, p->hop_limit)) {
+                    linkQuality.onDelivered(p->relay_node); // It carried the packet both ways
                     if (origTx->next_hop != p->relay_node) { // Not already set
                         LOG_INFO("Update next hop of 0x%x to 0x%x based on ACK/reply", p->from, p->relay_node);
                         origTx->next_hop = p->relay_node;
@@ -98,19 +117,17 @@ void NextHopRouter::sniffReceived(const meshtastic_MeshPacket *p, const meshtast
 /* Check if we should be relaying this packet if so, do so. */
 bool NextHopRouter::perhapsRelay(const meshtastic_MeshPacket *p)
 {
-    if (!isToUs(p) && !isFromUs(p) && p->hop_limit > 0) {
-        if (p->next_hop == NO_NEXT_HOP_PREFERENCE || p->next_hop == nodeDB->getLastByteOfNodeNum(getNodeNum())) {
-            if (isRebroadcaster()) {
-                meshtastic_MeshPacket *tosend = packetPool.allocCopy(*p); // keep a copy because we will be sending it
-                LOG_INFO("Relaying received message coming from %x", p->relay_node);
+    if (isForUsToRelay(isToUs(p), isFromUs(p), p->hop_limit, p->next_hop, nodeDB->getLastByteOfNodeNum(getNodeNum()))) {
+        if (isRebroadcaster()) {
+            meshtastic_MeshPacket *tosend = packetPool.allocCopy(*p); // keep a copy because we will be sending it
+            LOG_INFO("Relaying received message coming from %x", p->relay_node);
 
-                tosend->hop_limit--; // bump down the hop count
-                NextHopRouter::send(tosend);
+            tosend->hop_limit--; // bump down the hop count
+            NextHopRouter::send(tosend);
 
-                return true;
-            } else {
-                LOG_DEBUG("Not rebroadcasting: Role = CLIENT_MUTE or Rebroadcast Mode = NONE");
-            }
+            return true;
+        } else {
+            LOG_DEBUG("Not rebroadcasting: Role = CLIENT_MUTE or Rebroadcast Mode = NONE");
         }
     }
 
@@ -128,15 +145,66 @@ uint8_t NextHopRouter::getNextHop(NodeNum to, uint8_t relay_node)
         return NO_NEXT_HOP_PREFERENCE;
 
     meshtastic_NodeInfoLite *node = nodeDB->getMeshNode(to);
-    if (node && node->next_hop) {
-        // We are careful not to return the relay node as the next hop
-        if (node->next_hop != relay_node) {
-            // LOG_DEBUG("Next hop for 0x%x is 0x%x", to, node->next_hop);
-            return node->next_hop;
-        } else
-            LOG_WARN("Next hop for 0x%x is 0x%x, same as relayer; set no pref", to, node->next_hop);
-    }
-    return NO_NEXT_HOP_PREFERENCE;
+    if (!node)
+        return NO_NEXT_HOP_PREFERENCE;
+    uint8_t nextHop = chooseNextHop(node->next_hop, relay_node, linkQuality, millis());
+    if (node->next_hop && nextHop == NO_NEXT_HOP_PREFERENCE)
+        LOG_INFO("Next hop for 0x%x is 0x%x, which is the relayer or no longer reliable; set no pref", to, node->next_hop);
+    return nextHop;
+}
+
+uint8_t NextHopRouter::chooseNextHop(uint8_t learntNextHop, uint8_t relayNode, const LinkQualityTable &links, uint32_t nowMs)
+{
+    // We are careful not to return the relay node as the next hop, or one we have lost touch with
+    if (learntNextHop == NO_NEXT_HOP_PREFERENCE || learntNextHop == relayNode || links.isUnreliable(learntNextHop, nowMs))
+        return NO_NEXT_HOP_PREFERENCE;
+    return learntNextHop;
+}
+
+NextHopRouter::DupeAction NextHopRouter::getDupeAction(bool wasFallback, bool weWereNextHop, uint8_t hopStart, uint8_t hopLimit)
+{
+    if (wasFallback)
+        return DUPE_RELAY_AGAIN;
+    if (hopStart > 0 && hopStart == hopLimit)
+        return DUPE_RELAY_OR_ACK_AGAIN;
+    return weWereNextHop ? DUPE_IGNORE : DUPE_CANCEL;
+}
+
+bool NextHopRouter::isForUsToRelay(bool toUs, bool fromUs, uint8_t hopLimit, uint8_t nextHop, uint8_t ourRelayID)
+{
+    return !toUs && !fromUs && hopLimit > 0 && (nextHop == NO_NEXT_HOP_PREFERENCE || nextHop == ourRelayID);
+}
+
+bool NextHopRouter::shouldLearnNextHop(bool relayerRelayedRequest, bool weRelayedRequest, uint8_t hopStart, uint8_t hopLimit)
+{
+    // Either relayer of ACK was also a relayer of the packet, or we were the relayer and the ACK came directly from the
+    // destination
+    return relayerRelayedRequest || (weRelayedRequest && hopStart != 0 && hopStart == hopLimit);
+}
+
+bool NextHopRouter::needsRetransmission(bool fromUs, bool wantAck, uint8_t nextHop, uint8_t hopLimit)
+{
+    // If it's from us, ReliableRouter already handles retransmissions if want_ack is set. If a next hop is set and hop limit is
+    // not 0 or want_ack is set, start retransmissions
+    return (!fromUs || !wantAck) && nextHop != NO_NEXT_HOP_PREFERENCE && (hopLimit > 0 || wantAck);
+}
+
+bool NextHopRouter::cancelsQueuedOnStop(uint8_t numRetransmissions, bool fromUs, meshtastic_Config_DeviceConfig_Role role)
+{
+    /* Only when we already transmitted a packet via LoRa, we will cancel the packet in the Tx queue
+      to avoid canceling a transmission if it was ACKed super fast via MQTT */
+    // We only cancel it if we are the original sender or if we're not a router(_late)/repeater
+    return numRetransmissions < NUM_RELIABLE_RETX - 1 && (fromUs || !isRouterRole(role));
+}
+
+/**
+ * If we are retransmitting this packet through relayNode as next hop, hearing it relay the packet means the link works
+ */
+void NextHopRouter::noteRelayed(NodeNum from, PacketId id, uint8_t relayNode)
+{
+    PendingPacket *pending = findPendingPacket(from, id);
+    if (pending && pending->packet->next_hop != NO_NEXT_HOP_PREFERENCE && pending->packet->next_hop == relayNode)
+        linkQuality.onDelivered(relayNode);
 }
 
 PendingPacket *NextHopRouter::findPendingPacket(GlobalPacketId key)
@@ -162,18 +230,11 @@ bool NextHopRouter::stopRetransmission(GlobalPacketId key)
     auto old = findPendingPacket(key);
     if (old) {
         auto p = old->packet;
-        /* Only when we already transmitted a packet via LoRa, we will cancel the packet in the Tx queue
-          to avoid canceling a transmission if it was ACKed super fast via MQTT */
-        if (old->numRetransmissions < NUM_RELIABLE_RETX - 1) {
-            // We only cancel it if we are the original sender or if we're not a router(_late)/repeater
-            if (isFromUs(p) || (config.device.role != meshtastic_Config_DeviceConfig_Role_ROUTER &&
-                                config.device.role != meshtastic_Config_DeviceConfig_Role_REPEATER &&
-                                config.device.role != meshtastic_Config_DeviceConfig_Role_ROUTER_LATE)) {
-                // remove the 'original' (identified by originator and packet->id) from the txqueue and free it
-                cancelSending(getFrom(p), p->id);
-                // now free the pooled copy for retransmission too
-                packetPool.release(p);
-            }
+        if (cancelsQueuedOnStop(old->numRetransmissions, isFromUs(p), config.device.role)) {
+            // remove the 'original' (identified by originator and packet->id) from the txqueue and free it
+            cancelSending(getFrom(p), p->id);
+            // now free the pooled copy for retransmission too
+            packetPool.release(p);
         }
         auto numErased = pending.erase(key);
         assert(numErased == 1);
@@ -232,6 +293,8 @@ int32_t NextHopRouter::doRetransmissions()
                 if (!isBroadcast(p.packet->to)) {
                     if (p.numRetransmissions == 1) {
                         // Last retransmission, reset next_hop (fallback to FloodingRouter)
+                        if (p.packet->next_hop != NO_NEXT_HOP_PREFERENCE)
+                            linkQuality.onFailed(p.packet->next_hop);
                         p.packet->next_hop = NO_NEXT_HOP_PREFERENCE;
                         // Also reset it in the nodeDB
                         meshtastic_NodeInfoLite *sentTo = nodeDB->getMeshNode(p.packet->to);
@@ -269,7 +332,9 @@ int32_t NextHopRouter::doRetransmissions()
 void NextHopRouter::setNextTx(PendingPacket *pending)
 {
     assert(iface);
-    auto d = iface->getRetransmissionMsec(pending->packet);
+    if (!pending->airtimeMsec)
+        pending->airtimeMsec = iface->getPacketTime(pending->packet);
+    auto d = iface->getRetransmissionMsec(pending->airtimeMsec);
     pending->nextTxMsec = millis() + d;
     LOG_DEBUG("Setting next retransmission in %u msecs: ", d);
     printPacket("", pending->packet);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "FloodingRouter.h"
+#include "LinkQualityTable.h"
 #include <unordered_map>
 
 /**
@@ -38,6 +39,9 @@ struct PendingPacket {
     /** Starts at NUM_RETRANSMISSIONS -1 and counts down.  Once zero it will be removed from the list */
     uint8_t numRetransmissions = 0;
 
+    /** How long the packet takes to send, worked out once rather than by encoding it again for every retransmission */
+    uint32_t airtimeMsec = 0;
+
     PendingPacket() {}
     explicit PendingPacket(meshtastic_MeshPacket *p, uint8_t numRetransmissions);
 };
@@ -91,6 +95,37 @@ class NextHopRouter : public FloodingRouter
     // The number of retransmissions the original sender will do
     constexpr static uint8_t NUM_RELIABLE_RETX = 3;
 
+    /*
+      The decisions below are kept free of the singletons, so that the mesh simulator makes them with exactly the same rules
+    */
+
+    /// What to do with a duplicate, given what PacketHistory::wasSeenRecently() told us about it
+    enum DupeAction {
+        DUPE_IGNORE,            // We were asked to relay it, so keep our rebroadcast
+        DUPE_CANCEL,            // Someone else relayed it, so perhaps cancel ours
+        DUPE_RELAY_AGAIN,       // A fallback to flooding, relay it again unless we still have it queued
+        DUPE_RELAY_OR_ACK_AGAIN // Repeated by its sender, relay it again unless queued, or ACK it again if it's for us
+    };
+    static DupeAction getDupeAction(bool wasFallback, bool weWereNextHop, uint8_t hopStart, uint8_t hopLimit);
+
+    /// Whether a packet heard with this header is one we should relay, if our role and rebroadcast mode allow it
+    static bool isForUsToRelay(bool toUs, bool fromUs, uint8_t hopLimit, uint8_t nextHop, uint8_t ourRelayID);
+
+    /**
+     * The next hop to send to, given the one we learnt for the destination and the node that relayed the packet to us
+     * @return the next hop, NO_NEXT_HOP_PREFERENCE to flood
+     */
+    static uint8_t chooseNextHop(uint8_t learntNextHop, uint8_t relayNode, const LinkQualityTable &links, uint32_t nowMs);
+
+    /// Whether an ACK or reply teaches us its relayer as next hop towards its sender
+    static bool shouldLearnNextHop(bool relayerRelayedRequest, bool weRelayedRequest, uint8_t hopStart, uint8_t hopLimit);
+
+    /// Whether we retransmit a packet we send through nextHop ourselves (ReliableRouter handles our own want_ack packets)
+    static bool needsRetransmission(bool fromUs, bool wantAck, uint8_t nextHop, uint8_t hopLimit);
+
+    /// Whether stopping the retransmissions of a packet also takes the copy still waiting in the TX queue off it
+    static bool cancelsQueuedOnStop(uint8_t numRetransmissions, bool fromUs, meshtastic_Config_DeviceConfig_Role role);
+
   protected:
     /**
      * Pending retransmissions
@@ -105,6 +140,8 @@ class NextHopRouter : public FloodingRouter
      */
     virtual bool shouldFilterReceived(const meshtastic_MeshPacket *p) override;
 
+    virtual bool shouldFilterDupeHeader(const RxHeader &h) override;
+
     /**
      * Look for packets we need to relay
      */
@@ -138,6 +175,9 @@ class NextHopRouter : public FloodingRouter
 
     void setNextTx(PendingPacket *pending);
 
+    /** Credit the link to relayNode if we heard it relay a packet we gave it as next hop */
+    void noteRelayed(NodeNum from, PacketId id, uint8_t relayNode);
+
   private:
     /**
      * Get the next hop for a destination, given the relay node
@@ -33,6 +33,7 @@
 #include "mesh/wifi/WiFiAPClient.h"
 #endif
 #include "SPILock.h"
+#include "modules/RangeTestModule.h"
 #include "modules/StoreForwardModule.h"
 #include <Preferences.h>
 #include <esp_efuse.h>
@@ -480,9 +481,16 @@ bool NodeDB::factoryReset(bool eraseBleBonds)
     rmDir("/prefs"); // this uses spilock internally...
 
 #ifdef FSCom
+#ifdef ARCH_ESP32
+    if (rangeTestModuleRadio)
+        rangeTestModuleRadio->closeFile();
+#endif
     if (FSCom.exists("/static/rangetest.csv") && !FSCom.remove("/static/rangetest.csv")) {
         LOG_ERROR("Could not remove rangetest.csv file");
     }
+    if (FSCom.exists("/static/rangetest.bin") && !FSCom.remove("/static/rangetest.bin")) {
+        LOG_ERROR("Could not remove rangetest.bin file");
+    }
 #endif
     spiLock->unlock();
     // second, install default state (this will deal with the duplicate mac address issue)
@@ -517,6 +525,7 @@ void NodeDB::installDefaultNodeDatabase()
     nodeDatabase.nodes = std::vector<meshtastic_NodeInfoLite>(MAX_NUM_NODES);
     numMeshNodes = 0;
     meshNodes = &nodeDatabase.nodes;
+    spatialIndexValid = false;
 }
 
 void NodeDB::installDefaultConfig(bool preserveKey = false)
@@ -977,6 +986,7 @@ void NodeDB::resetNodes()
     std::fill(nodeDatabase.nodes.begin() + 1, nodeDatabase.nodes.end(), meshtastic_NodeInfoLite());
     devicestate.has_rx_text_message = false;
     devicestate.has_rx_waypoint = false;
+    spatialIndexValid = false;
     saveNodeDatabaseToDisk();
     saveDeviceStateToDisk();
     if (neighborInfoModule && moduleConfig.neighbor_info.enabled)
@@ -995,6 +1005,7 @@ void NodeDB::removeNodeByNum(NodeNum nodeNum)
     numMeshNodes -= removed;
     std::fill(nodeDatabase.nodes.begin() + numMeshNodes, nodeDatabase.nodes.begin() + numMeshNodes + 1,
               meshtastic_NodeInfoLite());
+    spatialIndex.remove(nodeNum);
     LOG_DEBUG("NodeDB::removeNodeByNum purged %d entries. Save changes", removed);
     saveNodeDatabaseToDisk();
 }
@@ -1006,6 +1017,7 @@ void NodeDB::clearLocalPosition()
     node->position.longitude_i = 0;
     node->position.altitude = 0;
     node->position.time = 0;
+    spatialIndex.remove(node->num);
     setLocalPosition(meshtastic_Position_init_default);
 }
 
@@ -1030,6 +1042,7 @@ void NodeDB::cleanupMeshDB()
     numMeshNodes -= removed;
     std::fill(nodeDatabase.nodes.begin() + numMeshNodes, nodeDatabase.nodes.begin() + numMeshNodes + removed,
               meshtastic_NodeInfoLite());
+    spatialIndexValid = false;
     LOG_DEBUG("cleanupMeshDB purged %d entries", removed);
 }
 
@@ -1557,6 +1570,12 @@ void NodeDB::updatePosition(uint32_t nodeId, const meshtastic_Position &p, RxSou
             info->position.time = tmp_time;
     }
     info->has_position = true;
+    if (spatialIndexValid) {
+        if (hasValidPosition(info))
+            spatialIndex.update(info->num, info->position.latitude_i, info->position.longitude_i);
+        else
+            spatialIndex.remove(info->num);
+    }
     updateGUIforNode = info;
     notifyObservers(true); // Force an update whether or not our node counts have changed
 }
@@ -1602,6 +1621,7 @@ void NodeDB::addFromContact(meshtastic_SharedContact contact)
         info->is_ignored = true;
         info->has_device_metrics = false;
         info->has_position = false;
+        spatialIndex.remove(info->num);
         info->user.public_key.size = 0;
         info->user.public_key.bytes[0] = 0;
     } else {
@@ -1824,6 +1844,7 @@ meshtastic_NodeInfoLite *NodeDB::getOrCreateMeshNode(NodeNum n)
             }
 
             if (oldestIndex != -1) {
+                spatialIndex.remove(meshNodes->at(oldestIndex).num);
                 // Shove the remaining nodes down the chain
                 for (int i = oldestIndex; i < numMeshNodes - 1; i++) {
                     meshNodes->at(i) = meshNodes->at(i + 1);
@@ -1850,6 +1871,20 @@ bool NodeDB::hasValidPosition(const meshtastic_NodeInfoLite *n)
     return n->has_position && (n->position.latitude_i != 0 || n->position.longitude_i != 0);
 }
 
+size_t NodeDB::getNearestNodes(int32_t lat, int32_t lon, NodeDistance *out, size_t maxCount, float maxMeters)
+{
+    if (!spatialIndexValid) {
+        spatialIndex.clear();
+        for (int i = 0; i < numMeshNodes; i++) {
+            const meshtastic_NodeInfoLite *n = &meshNodes->at(i);
+            if (hasValidPosition(n))
+                spatialIndex.update(n->num, n->position.latitude_i, n->position.longitude_i);
+        }
+        spatialIndexValid = true;
+    }
+    return spatialIndex.nearest(lat, lon, out, maxCount, maxMeters);
+}
+
 /// If we have a node / user and they report is_licensed = true
 /// we consider them licensed
 UserLicenseStatus NodeDB::getLicenseStatus(uint32_t nodeNum)
@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "MeshTypes.h"
+#include "NodeSpatialIndex.h"
 #include "NodeStatus.h"
 #include "configuration.h"
 #include "mesh-pb-constants.h"
@@ -194,7 +195,7 @@ class NodeDB
     NodeNum getNodeNum() { return myNodeInfo.my_node_num; }
 
     // @return last byte of a NodeNum, 0xFF if it ended at 0x00
-    uint8_t getLastByteOfNodeNum(NodeNum num) { return (uint8_t)((num & 0xFF) ? (num & 0xFF) : 0xFF); }
+    uint8_t getLastByteOfNodeNum(NodeNum num) { return getRelayByte(num); }
 
     /// if returns false, that means our node should send a DenyNodeNum response.  If true, we think the number is okay for use
     // bool handleWantNodeNum(NodeNum n);
@@ -268,6 +269,15 @@ class NodeDB
 
     bool hasValidPosition(const meshtastic_NodeInfoLite *n);
 
+    /**
+     * Find the nodes with a valid position nearest to lat/lon (in 1e-7 degrees), closest first.  Our own node is included.
+     * @return how many nodes were written to out, at most maxCount and none further than maxMeters
+     */
+    size_t getNearestNodes(int32_t lat, int32_t lon, NodeDistance *out, size_t maxCount, float maxMeters = INFINITY);
+
+    /// Call after changing a node position other than through updatePosition(), so getNearestNodes() sees the change
+    void invalidateSpatialIndex() { spatialIndexValid = false; }
+
     bool checkLowEntropyPublicKey(const meshtastic_Config_SecurityConfig_public_key_t &keyToTest);
 
     bool backupPreferences(meshtastic_AdminMessage_BackupLocation location);
@@ -287,6 +297,8 @@ class NodeDB
     uint32_t lastNodeDbSave = 0;    // when we last saved our db to flash
     uint32_t lastBackupAttempt = 0; // when we last tried a backup automatically or manually
     uint32_t lastSort = 0;          // When last sorted the nodeDB
+    NodeSpatialIndex spatialIndex;  // Node positions, for getNearestNodes()
+    bool spatialIndexValid = false; // If false spatialIndex is rebuilt from meshNodes on the next query
     /// Find a node in our DB, create an empty NodeInfoLite if missing
     meshtastic_NodeInfoLite *getOrCreateMeshNode(NodeNum n);
 
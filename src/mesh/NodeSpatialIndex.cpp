@@ -0,0 +1,60 @@
+#include "NodeSpatialIndex.h"
+#include "gps/GeoCoord.h"
+#include <algorithm>
+
+// Meters per 1e-7 degree of latitude, on the sphere GeoCoord::latLongToMeter() uses
+#define METERS_PER_LAT_E7 (6366000 * PI / 180 / 1e7)
+
+void NodeSpatialIndex::update(NodeNum num, int32_t lat, int32_t lon)
+{
+    remove(num);
+    Entry e = {lat, lon, num};
+    auto pos = std::upper_bound(entries.begin(), entries.end(), e, [](const Entry &a, const Entry &b) { return a.lat < b.lat; });
+    entries.insert(pos, e);
+}
+
+void NodeSpatialIndex::remove(NodeNum num)
+{
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (it->num == num) {
+            entries.erase(it);
+            return;
+        }
+    }
+}
+
+size_t NodeSpatialIndex::nearest(int32_t lat, int32_t lon, NodeDistance *out, size_t maxCount, float maxMeters) const
+{
+    if (!maxCount)
+        return 0;
+
+    size_t count = 0;
+    auto below = std::lower_bound(entries.begin(), entries.end(), lat, [](const Entry &e, int32_t l) { return e.lat < l; });
+    auto above = below;
+
+    while (below != entries.begin() || above != entries.end()) {
+        // Take whichever side is closer in latitude
+        int64_t belowGap = below != entries.begin() ? (int64_t)lat - (below - 1)->lat : INT64_MAX;
+        int64_t aboveGap = above != entries.end() ? (int64_t)above->lat - lat : INT64_MAX;
+        const Entry &e = belowGap <= aboveGap ? *--below : *above++;
+
+        // Nothing further out in latitude can be closer than this
+        float bound = std::min(belowGap, aboveGap) * METERS_PER_LAT_E7;
+        float limit = count == maxCount ? out[count - 1].meters : maxMeters;
+        if (bound > limit)
+            break;
+
+        float meters = GeoCoord::latLongToMeterFast(lat, lon, e.lat, e.lon);
+        if (meters > limit)
+            continue;
+
+        // Insert in order, dropping the furthest if we are full
+        size_t i = count < maxCount ? count++ : count - 1;
+        while (i > 0 && out[i - 1].meters > meters) {
+            out[i] = out[i - 1];
+            i--;
+        }
+        out[i] = NodeDistance{e.num, meters};
+    }
+    return count;
+}
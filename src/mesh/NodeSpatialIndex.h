@@ -0,0 +1,47 @@
+#pragma once
+
+#include "MeshTypes.h"
+#include <math.h>
+#include <vector>
+
+/// A node and how far it is from the point asked about
+struct NodeDistance {
+    NodeNum num;
+    float meters;
+};
+
+/**
+ * The positions of the nodes in the NodeDB, sorted by latitude, for "which nodes are near here" questions.
+ *
+ * Every node is at least as far from a point as the latitude difference alone says, so a query walks outwards from the
+ * point's latitude and stops once that bound passes the radius (or the k-th nearest node found so far).  Only the nodes in
+ * that band have their distance computed.  Positions are in 1e-7 degrees, as in meshtastic_PositionLite.
+ */
+class NodeSpatialIndex
+{
+  public:
+    /// Add num at lat/lon, or move it there if it is already indexed
+    void update(NodeNum num, int32_t lat, int32_t lon);
+
+    void remove(NodeNum num);
+
+    void clear() { entries.clear(); }
+
+    size_t size() const { return entries.size(); }
+
+    /**
+     * Find the nodes nearest to lat/lon, closest first
+     * @param out filled with up to maxCount nodes
+     * @param maxMeters only nodes at most this far away are returned
+     * @return how many nodes were written to out
+     */
+    size_t nearest(int32_t lat, int32_t lon, NodeDistance *out, size_t maxCount, float maxMeters = INFINITY) const;
+
+  private:
+    struct Entry {
+        int32_t lat, lon;
+        NodeNum num;
+    };
+
+    std::vector<Entry> entries; // Sorted by lat
+};
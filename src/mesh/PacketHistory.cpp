@@ -46,13 +46,19 @@ PacketHistory::~PacketHistory()
 
 /** Update recentPackets and return true if we have already seen this packet */
 bool PacketHistory::wasSeenRecently(const meshtastic_MeshPacket *p, bool withUpdate, bool *wasFallback, bool *weWereNextHop)
+{
+    return wasSeenRecently(getFrom(p), p->id, p->next_hop, p->relay_node, withUpdate, wasFallback, weWereNextHop);
+}
+
+bool PacketHistory::wasSeenRecently(NodeNum sender, PacketId id, uint8_t next_hop, uint8_t relay_node, bool withUpdate,
+                                    bool *wasFallback, bool *weWereNextHop)
 {
     if (!initOk()) {
         LOG_ERROR("Packet History - Was Seen Recently: NOT INITIALIZED!");
         return false;
     }
 
-    if (p->id == 0) {
+    if (id == 0) {
 #if VERBOSE_PACKET_HISTORY
         LOG_DEBUG("Packet History - Was Seen Recently: ID is 0, not a floodable message");
 #endif
@@ -63,18 +69,18 @@ bool PacketHistory::wasSeenRecently(const meshtastic_MeshPacket *p, bool withUpd
     memset(&r, 0, sizeof(PacketRecord)); // Initialize the record to zero
 
     // Save basic info from checked packet
-    r.id = p->id;
-    r.sender = getFrom(p); // If 0 then use our ID
-    r.next_hop = p->next_hop;
-    r.relayed_by[0] = p->relay_node;
+    r.id = id;
+    r.sender = sender;
+    r.next_hop = next_hop;
+    r.relayed_by[0] = relay_node;
 
     r.rxTimeMsec = millis(); //
     if (r.rxTimeMsec == 0)   // =0 every 49.7 days? 0 is special
         r.rxTimeMsec = 1;
 
 #if VERBOSE_PACKET_HISTORY
-    LOG_DEBUG("Packet History - Was Seen Recently: @start s=%08x id=%08x / to=%08x nh=%02x rn=%02x / wUpd=%s / wasFb?%d wWNH?%d",
-              r.sender, r.id, p->to, p->next_hop, p->relay_node, withUpdate ? "YES" : "NO", wasFallback ? *wasFallback : -1,
+    LOG_DEBUG("Packet History - Was Seen Recently: @start s=%08x id=%08x / nh=%02x rn=%02x / wUpd=%s / wasFb?%d wWNH?%d",
+              r.sender, r.id, next_hop, relay_node, withUpdate ? "YES" : "NO", wasFallback ? *wasFallback : -1,
               weWereNextHop ? *weWereNextHop : -1);
 #endif
 
@@ -85,25 +91,18 @@ bool PacketHistory::wasSeenRecently(const meshtastic_MeshPacket *p, bool withUpd
         uint8_t ourRelayID = nodeDB->getLastByteOfNodeNum(nodeDB->getNodeNum()); // Get our relay ID from our node number
 
         if (wasFallback) {
-            // If it was seen with a next-hop not set to us and now it's NO_NEXT_HOP_PREFERENCE, and the relayer relayed already
-            // before, it's a fallback to flooding. If we didn't already relay and the next-hop neither, we might need to handle
-            // it now.
-            if (found->sender != nodeDB->getNodeNum() && found->next_hop != NO_NEXT_HOP_PREFERENCE &&
-                found->next_hop != ourRelayID && p->next_hop == NO_NEXT_HOP_PREFERENCE && wasRelayer(p->relay_node, *found) &&
-                !wasRelayer(ourRelayID, *found) &&
-                !wasRelayer(
-                    found->next_hop,
-                    *found)) { // If we were not the next hop and the next hop is not us, and we are not relaying this packet
+            if (found->sender != nodeDB->getNodeNum() &&
+                isFallbackToFlooding(found->next_hop, found->relayed_by, next_hop, relay_node, ourRelayID)) {
 #if VERBOSE_PACKET_HISTORY
                 LOG_DEBUG("Packet History - Was Seen Recently: f=%08x id=%08x nh=%02x rn=%02x oID=%02x, wasFbk=%d-set TRUE",
-                          p->from, p->id, p->next_hop, p->relay_node, ourRelayID, wasFallback ? *wasFallback : -1);
+                          sender, id, next_hop, relay_node, ourRelayID, wasFallback ? *wasFallback : -1);
 #endif
                 *wasFallback = true;
             } else {
                 // debug log only
 #if VERBOSE_PACKET_HISTORY
                 LOG_DEBUG("Packet History - Was Seen Recently: f=%08x id=%08x nh=%02x rn=%02x oID=%02x, wasFbk=%d-no change",
-                          p->from, p->id, p->next_hop, p->relay_node, ourRelayID, wasFallback ? *wasFallback : -1);
+                          sender, id, next_hop, relay_node, ourRelayID, wasFallback ? *wasFallback : -1);
 #endif
             }
         }
@@ -113,7 +112,7 @@ bool PacketHistory::wasSeenRecently(const meshtastic_MeshPacket *p, bool withUpd
             *weWereNextHop = (found->next_hop == ourRelayID);
 #if VERBOSE_PACKET_HISTORY
             LOG_DEBUG("Packet History - Was Seen Recently: f=%08x id=%08x nh=%02x rn=%02x foundnh=%02x oID=%02x -> wWNH=%s",
-                      p->from, p->id, p->next_hop, p->relay_node, found->next_hop, ourRelayID, (*weWereNextHop) ? "YES" : "NO");
+                      sender, id, next_hop, relay_node, found->next_hop, ourRelayID, (*weWereNextHop) ? "YES" : "NO");
 #endif
         }
     }
@@ -141,15 +140,42 @@ bool PacketHistory::wasSeenRecently(const meshtastic_MeshPacket *p, bool withUpd
         insert(r); // Insert or update the packet record in the history
     }
 #if VERBOSE_PACKET_HISTORY
-    LOG_DEBUG("Packet History - Was Seen Recently: @exit s=%08x id=%08x (to=%08x) relby=%02x %02x %02x nxthop=%02x rxT=%d "
+    LOG_DEBUG("Packet History - Was Seen Recently: @exit s=%08x id=%08x relby=%02x %02x %02x nxthop=%02x rxT=%d "
               "found?%s seenRecently?%s wUpd?%s",
-              r.sender, r.id, p->to, r.relayed_by[0], r.relayed_by[1], r.relayed_by[2], r.next_hop, r.rxTimeMsec,
+              r.sender, r.id, r.relayed_by[0], r.relayed_by[1], r.relayed_by[2], r.next_hop, r.rxTimeMsec,
               found ? "YES" : "NO ", seenRecently ? "YES" : "NO ", withUpdate ? "YES" : "NO ");
 #endif
 
     return seenRecently;
 }
 
+bool PacketHistory::recordIfSeenRecently(NodeNum sender, PacketId id, uint8_t next_hop, uint8_t relay_node, bool *wasFallback,
+                                         bool *weWereNextHop)
+{
+    if (!initOk() || id == 0)
+        return false;
+
+    PacketRecord *found = find(sender, id);
+    if (found == NULL)
+        return false;
+
+    uint8_t ourRelayID = nodeDB->getLastByteOfNodeNum(nodeDB->getNodeNum());
+    if (weWereNextHop)
+        *weWereNextHop = (found->next_hop == ourRelayID);
+    if (wasFallback && found->sender != nodeDB->getNodeNum() &&
+        isFallbackToFlooding(found->next_hop, found->relayed_by, next_hop, relay_node, ourRelayID)) {
+        *wasFallback = true;
+        return true;
+    }
+
+    // What an update in wasSeenRecently() stores, done in place: the newest relayer first and the next hop first asked for
+    memmove(&found->relayed_by[1], &found->relayed_by[0], NUM_RELAYERS - 1);
+    found->relayed_by[0] = relay_node;
+    uint32_t now = millis();
+    found->rxTimeMsec = now ? now : 1; // 0 is special
+    return true;
+}
+
 /** Find a packet record in history.
  * @return pointer to PacketRecord if found, NULL if not found */
 PacketHistory::PacketRecord *PacketHistory::find(NodeNum sender, PacketId id)
@@ -325,6 +351,22 @@ bool PacketHistory::wasRelayer(const uint8_t relayer, const uint32_t id, const N
     return wasRelayer(relayer, *found);
 }
 
+bool PacketHistory::isFallbackToFlooding(uint8_t recordedNextHop, const uint8_t relayedBy[NUM_RELAYERS], uint8_t next_hop,
+                                         uint8_t relay_node, uint8_t ourRelayID)
+{
+    auto relayed = [relayedBy](uint8_t relayer) {
+        for (uint8_t i = 0; i < NUM_RELAYERS; i++) {
+            if (relayedBy[i] == relayer)
+                return true;
+        }
+        return false;
+    };
+    // If it was seen with a next-hop not set to us and now it's NO_NEXT_HOP_PREFERENCE, and the relayer relayed already
+    // before, it's a fallback to flooding. If we didn't already relay and the next-hop neither, we might need to handle it now.
+    return recordedNextHop != NO_NEXT_HOP_PREFERENCE && recordedNextHop != ourRelayID && next_hop == NO_NEXT_HOP_PREFERENCE &&
+           relayed(relay_node) && !relayed(ourRelayID) && !relayed(recordedNextHop);
+}
+
 /* Check if a certain node was a relayer of a packet in the history given iterator
  * @return true if node was indeed a relayer, false if not */
 bool PacketHistory::wasRelayer(const uint8_t relayer, const PacketRecord &r)
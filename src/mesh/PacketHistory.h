@@ -53,6 +53,20 @@ class PacketHistory
     bool wasSeenRecently(const meshtastic_MeshPacket *p, bool withUpdate = true, bool *wasFallback = nullptr,
                          bool *weWereNextHop = nullptr);
 
+    /// The same, for a packet we only have the routing fields of.  sender must already be resolved as with getFrom()
+    bool wasSeenRecently(NodeNum sender, PacketId id, uint8_t next_hop, uint8_t relay_node, bool withUpdate = true,
+                         bool *wasFallback = nullptr, bool *weWereNextHop = nullptr);
+
+    /**
+     * For a duplicate we might drop on its header alone: return true if we have already seen this packet, and if so record
+     * relay_node on the record found, with a single lookup.  A packet we haven't seen, or a fallback to flooding, is not
+     * recorded, as its whole packet will go through wasSeenRecently().
+     *
+     * @param wasFallback, weWereNextHop as for wasSeenRecently()
+     */
+    bool recordIfSeenRecently(NodeNum sender, PacketId id, uint8_t next_hop, uint8_t relay_node, bool *wasFallback = nullptr,
+                              bool *weWereNextHop = nullptr);
+
     /* Check if a certain node was a relayer of a packet in the history given an ID and sender
      * @return true if node was indeed a relayer, false if not */
     bool wasRelayer(const uint8_t relayer, const uint32_t id, const NodeNum sender);
@@ -62,4 +76,12 @@ class PacketHistory
 
     // To check if the PacketHistory was initialized correctly by constructor
     bool initOk(void) { return recentPackets != NULL && recentPacketsCapacity != 0; }
+
+    /**
+     * The rule wasSeenRecently() spots a fallback to flooding with: a packet first heard with a next hop other than us comes
+     * again with none, from a node which already relayed it, and neither we nor that next hop have relayed it yet.
+     * @param recordedNextHop, relayedBy what we recorded on first hearing the packet
+     */
+    static bool isFallbackToFlooding(uint8_t recordedNextHop, const uint8_t relayedBy[NUM_RELAYERS], uint8_t next_hop,
+                                     uint8_t relay_node, uint8_t ourRelayID);
 };
@@ -1,14 +1,16 @@
 #pragma once
 
+#include "LockFreeQueue.h"
 #include "TypedQueue.h"
 
 /**
- * A wrapper for freertos queues that assumes each element is a pointer
+ * A wrapper for freertos queues that assumes each element is a pointer.  Queue picks the implementation: TypedQueue (a
+ * freertos queue), SPSCTypedQueue or MPMCTypedQueue.
  */
-template <class T> class PointerQueue : public TypedQueue<T *>
+template <class T, class Queue = TypedQueue<T *>> class PointerQueue : public Queue
 {
   public:
-    explicit PointerQueue(int maxElements) : TypedQueue<T *>(maxElements) {}
+    explicit PointerQueue(int maxElements) : Queue(maxElements) {}
 
     // returns a ptr or null if the queue was empty
     T *dequeuePtr(TickType_t maxWait = portMAX_DELAY)
@@ -28,3 +30,14 @@ template <class T> class PointerQueue : public TypedQueue<T *>
     }
 #endif
 };
+
+/// A PointerQueue for one producer and one consumer thread, see SPSCTypedQueue
+template <class T> using SPSCPointerQueue = PointerQueue<T, SPSCTypedQueue<T *>>;
+
+#if QUEUE_HAS_NATIVE_CAS
+/// A lock-free PointerQueue for any number of threads, see MPMCTypedQueue
+template <class T> using MPMCPointerQueue = PointerQueue<T, MPMCTypedQueue<T *>>;
+#else
+/// No compare-and-swap on this core, so a PointerQueue for any number of threads is the TypedQueue one
+template <class T> using MPMCPointerQueue = PointerQueue<T>;
+#endif
@@ -1,6 +1,7 @@
 #include "RadioInterface.h"
 #include "Channels.h"
 #include "DisplayFormatters.h"
+#include "LinkQualityTable.h"
 #include "MeshRadio.h"
 #include "MeshService.h"
 #include "NodeDB.h"
@@ -236,6 +237,28 @@ separated by 2.16 MHz with respect to the adjacent channels. Channel zero starts
  * @return num msecs for the packet
  */
 uint32_t RadioInterface::getPacketTime(uint32_t pl)
+{
+    // Some radios change the preamble length after applyModemConfig(), so check the table is still for these settings
+    if (packetTimeBw != bw || packetTimeSf != sf || packetTimeCr != cr || packetTimePreambleLength != preambleLength)
+        buildPacketTimeTable();
+    if (pl < sizeof(packetTimeMsec) / sizeof(packetTimeMsec[0]) && packetTimeMsec[pl])
+        return packetTimeMsec[pl];
+    return getPacketTime(pl, bw, sf, cr, preambleLength);
+}
+
+void RadioInterface::buildPacketTimeTable()
+{
+    for (uint32_t pl = 0; pl < sizeof(packetTimeMsec) / sizeof(packetTimeMsec[0]); pl++) {
+        uint32_t msecs = getPacketTime(pl, bw, sf, cr, preambleLength);
+        packetTimeMsec[pl] = msecs <= UINT16_MAX ? msecs : 0; // Absurdly slow custom settings are left to getPacketTime()
+    }
+    packetTimeBw = bw;
+    packetTimeSf = sf;
+    packetTimeCr = cr;
+    packetTimePreambleLength = preambleLength;
+}
+
+uint32_t RadioInterface::getPacketTime(uint32_t pl, float bw, uint8_t sf, uint8_t cr, uint16_t preambleLength)
 {
     float bandwidthHz = bw * 1000.0f;
     bool headDisable = false; // we currently always use the header
@@ -267,14 +290,17 @@ uint32_t RadioInterface::getPacketTime(const meshtastic_MeshPacket *p)
 }
 
 /** The delay to use for retransmitting dropped packets */
-uint32_t RadioInterface::getRetransmissionMsec(const meshtastic_MeshPacket *p)
+uint32_t RadioInterface::getRetransmissionMsec(uint32_t packetAirtime)
+{
+    return getRetransmissionMsec(packetAirtime, airTime->channelUtilizationPercent(), contention, slotTimeMsec);
+}
+
+uint32_t RadioInterface::getRetransmissionMsec(uint32_t packetAirtime, float channelUtil, const ContentionController &contention,
+                                               uint32_t slotTimeMsec)
 {
-    size_t numbytes = pb_encode_to_bytes(bytes, sizeof(bytes), &meshtastic_Data_msg, &p->decoded);
-    uint32_t packetAirtime = getPacketTime(numbytes + sizeof(PacketHeader));
     // Make sure enough time has elapsed for this packet to be sent and an ACK is received.
     // LOG_DEBUG("Waiting for flooding message with airtime %d and slotTime is %d", packetAirtime, slotTimeMsec);
-    float channelUtil = airTime->channelUtilizationPercent();
-    uint8_t CWsize = map(channelUtil, 0, 100, CWmin, CWmax);
+    uint8_t CWsize = contention.adjust(map(channelUtil, 0, 100, CWmin, CWmax), CWmax);
     // Assuming we pick max. of CWsize and there will be a client with SNR at half the range
     return 2 * packetAirtime + (pow_of_2(CWsize) + 2 * CWmax + pow_of_2(int((CWmax + CWmin) / 2))) * slotTimeMsec +
            PROCESSING_TIME_MSEC;
@@ -282,18 +308,27 @@ uint32_t RadioInterface::getRetransmissionMsec(const meshtastic_MeshPacket *p)
 
 /** The delay to use when we want to send something */
 uint32_t RadioInterface::getTxDelayMsec()
+{
+    return getTxDelayMsec(airTime->channelUtilizationShortPercent(), contention, slotTimeMsec);
+}
+
+uint32_t RadioInterface::getTxDelayMsec(float channelUtilShort, const ContentionController &contention, uint32_t slotTimeMsec)
 {
     /** We wait a random multiple of 'slotTimes' (see definition in header file) in order to avoid collisions.
     The pool to take a random multiple from is the contention window (CW), which size depends on the
-    current channel utilization. */
-    float channelUtil = airTime->channelUtilizationPercent();
-    uint8_t CWsize = map(channelUtil, 0, 100, CWmin, CWmax);
-    // LOG_DEBUG("Current channel utilization is %f so setting CWsize to %d", channelUtil, CWsize);
+    current channel utilization, taken over a short enough time to follow bursts. */
+    uint8_t CWsize = contention.adjust(map(channelUtilShort, 0, 100, CWmin, CWmax), CWmax);
+    // LOG_DEBUG("Current channel utilization is %f so setting CWsize to %d", channelUtilShort, CWsize);
     return random(0, pow_of_2(CWsize)) * slotTimeMsec;
 }
 
 /** The CW size to use when calculating SNR_based delays */
 uint8_t RadioInterface::getCWsize(float snr)
+{
+    return getCWsize(snr, contention);
+}
+
+uint8_t RadioInterface::getCWsize(float snr, const ContentionController &contention)
 {
     // The minimum value for a LoRa SNR
     const uint32_t SNR_MIN = -20;
@@ -301,36 +336,50 @@ uint8_t RadioInterface::getCWsize(float snr)
     // The maximum value for a LoRa SNR
     const uint32_t SNR_MAX = 10;
 
-    return map(snr, SNR_MIN, SNR_MAX, CWmin, CWmax);
+    return contention.adjust(map(snr, SNR_MIN, SNR_MAX, CWmin, CWmax), CWmax);
 }
 
 /** The worst-case SNR_based packet delay */
 uint32_t RadioInterface::getTxDelayMsecWeightedWorst(float snr)
 {
-    uint8_t CWsize = getCWsize(snr);
+    return getTxDelayMsecWeightedWorst(getCWsize(snr), slotTimeMsec);
+}
+
+uint32_t RadioInterface::getTxDelayMsecWeightedWorst(uint8_t CWsize, uint32_t slotTimeMsec)
+{
     // offset the maximum delay for routers: (2 * CWmax * slotTimeMsec)
     return (2 * CWmax * slotTimeMsec) + pow_of_2(CWsize) * slotTimeMsec;
 }
 
 /** The delay to use when we want to flood a message */
 uint32_t RadioInterface::getTxDelayMsecWeighted(float snr)
+{
+    uint32_t delay = getTxDelayMsecWeighted(getCWsize(snr), config.device.role, slotTimeMsec);
+    LOG_DEBUG("rx_snr found in packet. Setting tx delay:%d", delay);
+    return delay;
+}
+
+float RadioInterface::getTxDelaySnr(const meshtastic_MeshPacket *p)
+{
+    return linkQuality.getRelayWeightSnr(p->from, wasHeardFromSender(p->hop_start, p->hop_limit), p->rx_snr);
+}
+
+uint32_t RadioInterface::getTxDelayMsecWeighted(uint8_t CWsize, meshtastic_Config_DeviceConfig_Role role, uint32_t slotTimeMsec)
 {
     //  high SNR = large CW size (Long Delay)
     //  low SNR = small CW size (Short Delay)
-    uint32_t delay = 0;
-    uint8_t CWsize = getCWsize(snr);
     // LOG_DEBUG("rx_snr of %f so setting CWsize to:%d", snr, CWsize);
-    if (config.device.role == meshtastic_Config_DeviceConfig_Role_ROUTER ||
-        config.device.role == meshtastic_Config_DeviceConfig_Role_REPEATER) {
-        delay = random(0, 2 * CWsize) * slotTimeMsec;
-        LOG_DEBUG("rx_snr found in packet. Router: setting tx delay:%d", delay);
+    if (role == meshtastic_Config_DeviceConfig_Role_ROUTER || role == meshtastic_Config_DeviceConfig_Role_REPEATER) {
+        return random(0, 2 * CWsize) * slotTimeMsec;
     } else {
         // offset the maximum delay for routers: (2 * CWmax * slotTimeMsec)
-        delay = (2 * CWmax * slotTimeMsec) + random(0, pow_of_2(CWsize)) * slotTimeMsec;
-        LOG_DEBUG("rx_snr found in packet. Setting tx delay:%d", delay);
+        return (2 * CWmax * slotTimeMsec) + random(0, pow_of_2(CWsize)) * slotTimeMsec;
     }
+}
 
-    return delay;
+uint32_t RadioInterface::getLateTxAfter(uint32_t txAfter, uint32_t nowMsec, uint32_t addDelayMsec, uint32_t worstDelayMsec)
+{
+    return min(max(txAfter + addDelayMsec, nowMsec + addDelayMsec), nowMsec + 2 * worstDelayMsec);
 }
 
 void printPacket(const char *prefix, const meshtastic_MeshPacket *p)
@@ -603,6 +652,9 @@ void RadioInterface::applyModemConfig()
     saveChannelNum(channel_num);
     saveFreq(freq + loraConfig.frequency_offset);
 
+    // Work out the airtime of every packet length now, so sending and airtime accounting only have to look it up
+    buildPacketTimeTable();
+
     slotTimeMsec = computeSlotTimeMsec();
     preambleTimeMsec = getPacketTime((uint32_t)0);
     maxPacketTimeMsec = getPacketTime(meshtastic_Constants_DATA_PAYLOAD_LEN + sizeof(PacketHeader));
@@ -624,11 +676,16 @@ void RadioInterface::applyModemConfig()
   - Tx/Rx turnaround time (maximum of SX126x and SX127x);
   - MAC processing time (measured on T-beam) */
 uint32_t RadioInterface::computeSlotTimeMsec()
+{
+    return computeSlotTimeMsec(bw, sf, myRegion->wideLora);
+}
+
+uint32_t RadioInterface::computeSlotTimeMsec(float bw, uint8_t sf, bool wideLora)
 {
     float sumPropagationTurnaroundMACTime = 0.2 + 0.4 + 7; // in milliseconds
     float symbolTime = pow_of_2(sf) / bw;                  // in milliseconds
 
-    if (myRegion->wideLora) {
+    if (wideLora) {
         // CAD duration derived from AN1200.22 of SX1280
         return (NUM_SYM_CAD_24GHZ + (2 * sf + 3) / 32) * symbolTime + sumPropagationTurnaroundMACTime;
     } else {
@@ -667,7 +724,7 @@ void RadioInterface::limitPower(int8_t loraMaxPower)
 void RadioInterface::deliverToReceiver(meshtastic_MeshPacket *p)
 {
     if (router)
-        router->enqueueReceivedMessage(p);
+        router->deliverFromRadio(p);
 }
 
 /***
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ContentionController.h"
 #include "MemoryPool.h"
 #include "MeshTypes.h"
 #include "Observer.h"
@@ -66,7 +67,8 @@ typedef struct {
  */
 class RadioInterface
 {
-    friend class MeshRadio; // for debugging we let that class touch pool
+    friend class MeshRadio;     // for debugging we let that class touch pool
+    friend class MeshSimulator; // runs many virtual radios in one process, using our timing rules
 
     CallbackObserver<RadioInterface, void *> configChangedObserver =
         CallbackObserver<RadioInterface, void *>(this, &RadioInterface::reloadConfig);
@@ -84,22 +86,46 @@ class RadioInterface
     uint8_t sf = 9;
     uint8_t cr = 5;
 
-    const uint8_t NUM_SYM_CAD = 2;       // Number of symbols used for CAD, 2 is the default since RadioLib 6.3.0 as per AN1200.48
-    const uint8_t NUM_SYM_CAD_24GHZ = 4; // Number of symbols used for CAD in 2.4 GHz, 4 is recommended in AN1200.22 of SX1280
+    // Number of symbols used for CAD, 2 is the default since RadioLib 6.3.0 as per AN1200.48
+    static constexpr uint8_t NUM_SYM_CAD = 2;
+    // Number of symbols used for CAD in 2.4 GHz, 4 is recommended in AN1200.22 of SX1280
+    static constexpr uint8_t NUM_SYM_CAD_24GHZ = 4;
     uint32_t slotTimeMsec = computeSlotTimeMsec();
     uint16_t preambleLength = 16;      // 8 is default, but we use longer to increase the amount of sleep time when receiving
     uint32_t preambleTimeMsec = 165;   // calculated on startup, this is the default for LongFast
     uint32_t maxPacketTimeMsec = 3246; // calculated on startup, this is the default for LongFast
-    const uint32_t PROCESSING_TIME_MSEC =
-        4500;                // time to construct, process and construct a packet again (empirically determined)
-    const uint8_t CWmin = 3; // minimum CWsize
-    const uint8_t CWmax = 8; // maximum CWsize
+    static constexpr uint32_t PROCESSING_TIME_MSEC =
+        4500;                           // time to construct, process and construct a packet again (empirically determined)
+    static constexpr uint8_t CWmin = 3; // minimum CWsize
+    static constexpr uint8_t CWmax = 8; // maximum CWsize
+
+    ContentionController contention; // Widens the CW after collisions, if ADAPTIVE_CONTENTION_WINDOW
 
     meshtastic_MeshPacket *sendingPacket = NULL; // The packet we are currently sending
     uint32_t lastTxStart = 0L;
 
     uint32_t computeSlotTimeMsec();
 
+    /** Slot time for the given modem settings, see computeSlotTimeMsec() */
+    static uint32_t computeSlotTimeMsec(float bw, uint8_t sf, bool wideLora);
+
+    /*
+     * The timing rules behind getTxDelayMsec() and friends, for a given radio state rather than ours, so MeshSimulator runs the
+     * same code for each of its nodes.  Random draws come from random(), which the simulator seeds.
+     */
+    static uint8_t getCWsize(float snr, const ContentionController &contention);
+    static uint32_t getTxDelayMsec(float channelUtilShort, const ContentionController &contention, uint32_t slotTimeMsec);
+    static uint32_t getTxDelayMsecWeighted(uint8_t CWsize, meshtastic_Config_DeviceConfig_Role role, uint32_t slotTimeMsec);
+    static uint32_t getTxDelayMsecWeightedWorst(uint8_t CWsize, uint32_t slotTimeMsec);
+    static uint32_t getRetransmissionMsec(uint32_t packetAirtime, float channelUtil, const ContentionController &contention,
+                                          uint32_t slotTimeMsec);
+
+    /** True if a relay we queued, with its hop limit already decremented, was heard straight from its sender */
+    static bool wasHeardFromSender(uint8_t hopStart, uint8_t hopLimit) { return hopStart != 0 && hopStart == hopLimit + 1; }
+
+    /** When a packet waiting in the late rebroadcast window may go, once we wait addDelayMsec more, capped by the worst case */
+    static uint32_t getLateTxAfter(uint32_t txAfter, uint32_t nowMsec, uint32_t addDelayMsec, uint32_t worstDelayMsec);
+
     /**
      * A temporary buffer used for sending/receiving packets, sized to hold the biggest buffer we might need
      * */
@@ -169,11 +195,15 @@ class RadioInterface
     virtual bool reconfigure();
 
     /** The delay to use for retransmitting dropped packets */
-    uint32_t getRetransmissionMsec(const meshtastic_MeshPacket *p);
+    uint32_t getRetransmissionMsec(const meshtastic_MeshPacket *p) { return getRetransmissionMsec(getPacketTime(p)); }
+    uint32_t getRetransmissionMsec(uint32_t packetAirtimeMsec);
 
     /** The delay to use when we want to send something */
     uint32_t getTxDelayMsec();
 
+    /** The router heard another copy of a packet it already had, a hint that our neighbours are contending for the channel */
+    void onDuplicateHeard() { contention.onDuplicate(); }
+
     /** The CW to use when calculating SNR_based delays */
     uint8_t getCWsize(float snr);
 
@@ -183,6 +213,12 @@ class RadioInterface
     /** The delay to use when we want to flood a message. Use a weighted scale based on SNR */
     uint32_t getTxDelayMsecWeighted(float snr);
 
+    /**
+     * The SNR to weight the delay of a packet we are relaying by, which is the smoothed SNR of our link to its sender if we
+     * heard it straight from them, otherwise the packet's own rx_snr.  See LinkQualityTable::getRelayWeightSnr().
+     */
+    float getTxDelaySnr(const meshtastic_MeshPacket *p);
+
     /** If the packet is not already in the late rebroadcast window, move it there */
     virtual void clampToLateRebroadcastWindow(NodeNum from, PacketId id) { return; }
 
@@ -196,6 +232,9 @@ class RadioInterface
     uint32_t getPacketTime(const meshtastic_MeshPacket *p);
     uint32_t getPacketTime(uint32_t totalPacketLen);
 
+    /** Airtime of totalPacketLen bytes for arbitrary modem settings, rather than the ones we are configured with */
+    static uint32_t getPacketTime(uint32_t totalPacketLen, float bw, uint8_t sf, uint8_t cr, uint16_t preambleLength);
+
     /**
      * Get the channel we saved.
      */
@@ -243,6 +282,15 @@ class RadioInterface
     virtual void saveChannelNum(uint32_t savedChannelNum);
 
   private:
+    /// getPacketTime() of each total packet length for the settings below, filled by buildPacketTimeTable().  0 if unknown.
+    uint16_t packetTimeMsec[MAX_LORA_PAYLOAD_LEN + 1] = {};
+    float packetTimeBw = 0;
+    uint8_t packetTimeSf = 0, packetTimeCr = 0;
+    uint16_t packetTimePreambleLength = 0;
+
+    /// Fill packetTimeMsec for the current bw, sf, cr and preambleLength
+    void buildPacketTimeTable();
+
     /**
      * Convert our modemConfig enum into wf, sf, etc...
      *
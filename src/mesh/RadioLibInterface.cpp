@@ -1,7 +1,9 @@
 #include "RadioLibInterface.h"
+#include "LinkQualityTable.h"
 #include "MeshTypes.h"
 #include "NodeDB.h"
 #include "PowerMon.h"
+#include "Router.h"
 #include "SPILock.h"
 #include "Throttle.h"
 #include "configuration.h"
@@ -171,7 +173,7 @@ ErrorCode RadioLibInterface::send(meshtastic_MeshPacket *p)
 #ifndef LORA_DISABLE_SENDING
     printPacket("enqueue for send", p);
 
-    LOG_DEBUG("txGood=%d,txRelay=%d,rxGood=%d,rxBad=%d", txGood, txRelay, rxGood, rxBad);
+    LOG_DEBUG("txGood=%d,txRelay=%d,rxGood=%d,rxBad=%d,rxDupeEarly=%d", txGood, txRelay, rxGood, rxBad, rxDupeEarly);
     ErrorCode res = txQueue.enqueue(p) ? ERRNO_OK : ERRNO_UNKNOWN;
 
     if (res != ERRNO_OK) { // we weren't able to queue it, so we must drop it to prevent leaks
@@ -272,7 +274,8 @@ void RadioLibInterface::onNotify(uint32_t notification)
                     notifyLater(delay_remaining, TRANSMIT_DELAY_COMPLETED, false);
                 } else {
                     if (isChannelActive()) { // check if there is currently a LoRa packet on the channel
-                        startReceive();      // try receiving this packet, afterwards we'll be trying to transmit again
+                        contention.onChannelBusy();
+                        startReceive(); // try receiving this packet, afterwards we'll be trying to transmit again
                         setTransmitDelay();
                     } else {
                         // Send any outgoing packets we have ready as fast as possible to keep the time between channel scan and
@@ -284,6 +287,7 @@ void RadioLibInterface::onNotify(uint32_t notification)
                             // Packet has been sent, count it toward our TX airtime utilization.
                             uint32_t xmitMsec = getPacketTime(txp);
                             airTime->logAirtime(TX_LOG, xmitMsec);
+                            contention.onTxClean();
                         }
                         LOG_DEBUG("%d packets remain in the TX queue", txQueue.getMaxLen() - txQueue.getFree());
                     }
@@ -310,9 +314,10 @@ void RadioLibInterface::setTransmitDelay()
     // So we want to make sure the other side has had a chance to reconfigure its radio.
 
     if (p->tx_after) {
-        unsigned long add_delay = p->rx_rssi ? getTxDelayMsecWeighted(p->rx_snr) : getTxDelayMsec();
+        float snr = getTxDelaySnr(p);
+        unsigned long add_delay = p->rx_rssi ? getTxDelayMsecWeighted(snr) : getTxDelayMsec();
         unsigned long now = millis();
-        p->tx_after = min(max(p->tx_after + add_delay, now + add_delay), now + 2 * getTxDelayMsecWeightedWorst(p->rx_snr));
+        p->tx_after = getLateTxAfter(p->tx_after, now, add_delay, getTxDelayMsecWeightedWorst(snr));
         notifyLater(p->tx_after - now, TRANSMIT_DELAY_COMPLETED, false);
     } else if (p->rx_snr == 0 && p->rx_rssi == 0) {
         /* We assume if rx_snr = 0 and rx_rssi = 0, the packet was generated locally.
@@ -323,7 +328,7 @@ void RadioLibInterface::setTransmitDelay()
     } else {
         // If there is a SNR, start a timer scaled based on that SNR.
         LOG_DEBUG("rx_snr found. hop_limit:%d rx_snr:%f", p->hop_limit, p->rx_snr);
-        startTransmitTimerSNR(p->rx_snr);
+        startTransmitTimerSNR(getTxDelaySnr(p));
     }
 }
 
@@ -353,7 +358,7 @@ void RadioLibInterface::clampToLateRebroadcastWindow(NodeNum from, PacketId id)
     // Look for non-late packets only, so we don't do this twice!
     meshtastic_MeshPacket *p = txQueue.remove(from, id, true, false);
     if (p) {
-        p->tx_after = millis() + getTxDelayMsecWeightedWorst(p->rx_snr);
+        p->tx_after = millis() + getTxDelayMsecWeightedWorst(getTxDelaySnr(p));
         if (txQueue.enqueue(p)) {
             LOG_DEBUG("Move existing queued packet to the late rebroadcast window %dms from now", p->tx_after - millis());
         } else {
@@ -424,6 +429,7 @@ void RadioLibInterface::handleReceiveInterrupt()
     if (state != RADIOLIB_ERR_NONE) {
         LOG_ERROR("Ignore received packet due to error=%d", state);
         rxBad++;
+        contention.onCrcError();
 
         airTime->logAirtime(RX_ALL_LOG, xmitMsec);
 
@@ -444,6 +450,19 @@ void RadioLibInterface::handleReceiveInterrupt()
                 return;
             }
 
+            // Most frames in a busy mesh are rebroadcasts of packets we already have.  Let the router deal with those from the
+            // header, rather than allocating, logging and later decrypting a packet for each.
+            if (router && router->handleDupeHeader(radioBuffer.header, xmitMsec)) {
+                rxDupeEarly++;
+                // Copies relayed by our neighbours are most of what tells us about their links, so still note this one
+                uint8_t hopStart = (radioBuffer.header.flags & PACKET_FLAGS_HOP_START_MASK) >> PACKET_FLAGS_HOP_START_SHIFT;
+                bool isDirect = hopStart != 0 && hopStart == (radioBuffer.header.flags & PACKET_FLAGS_HOP_LIMIT_MASK);
+                linkQuality.onReceive(hopStart == 0 ? NO_RELAY_NODE : radioBuffer.header.relay_node,
+                                      isDirect ? radioBuffer.header.from : 0, iface->getSNR(), lround(iface->getRSSI()));
+                airTime->logAirtime(RX_LOG, xmitMsec);
+                return;
+            }
+
             // Note: we deliver _all_ packets to our router (i.e. our interface is intentionally promiscuous).
             // This allows the router and other apps on our node to sniff packets (usually routing) between other
             // nodes.
@@ -464,6 +483,7 @@ void RadioLibInterface::handleReceiveInterrupt()
             mp->relay_node = mp->hop_start == 0 ? NO_RELAY_NODE : radioBuffer.header.relay_node;
 
             addReceiveMetadata(mp);
+            linkQuality.onReceive(mp);
 
             mp->which_payload_variant =
                 meshtastic_MeshPacket_encrypted_tag; // Mark that the payload is still encrypted at this point
@@ -0,0 +1,41 @@
+#include "RebroadcastSuppressor.h"
+#include <string.h>
+
+bool RebroadcastSuppressor::onDuplicate(NodeNum from, PacketId id, uint8_t relayNode, bool isRouter)
+{
+    if (mode == SUPPRESS_FIRST_DUPLICATE)
+        return !isRouter;
+
+    return countRelayer(from, id, relayNode) >= (isRouter ? ROUTER_RELAYERS : CLIENT_RELAYERS);
+}
+
+void RebroadcastSuppressor::clear()
+{
+    memset(entries, 0, sizeof(entries));
+    nextEntry = 0;
+}
+
+uint8_t RebroadcastSuppressor::countRelayer(NodeNum from, PacketId id, uint8_t relayNode)
+{
+    Entry *e = NULL;
+    for (Entry &candidate : entries) {
+        if (candidate.from == from && candidate.id == id) {
+            e = &candidate;
+            break;
+        }
+    }
+    if (!e) {
+        e = &entries[nextEntry];
+        nextEntry = (nextEntry + 1) % TRACKED_PACKETS;
+        e->from = from;
+        e->id = id;
+        e->numRelayers = 0;
+    }
+
+    for (uint8_t i = 0; i < e->numRelayers; i++)
+        if (e->relayers[i] == relayNode)
+            return e->numRelayers;
+    if (e->numRelayers < ROUTER_RELAYERS)
+        e->relayers[e->numRelayers++] = relayNode;
+    return e->numRelayers;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "MeshTypes.h"
+
+// Set to 1 to let routers cancel a rebroadcast once enough distinct relayers have covered the packet
+#ifndef COUNTING_REBROADCAST_SUPPRESSION
+#define COUNTING_REBROADCAST_SUPPRESSION 0
+#endif
+
+/**
+ * Decides whether hearing someone else rebroadcast a packet should cancel our own pending rebroadcast of it.
+ *
+ * By default any duplicate cancels it, except for routers and repeaters, which always rebroadcast.  The counting policy works
+ * like the Trickle algorithm instead: we count the distinct relayers heard during our contention window and give up once that
+ * reaches a threshold.  Clients keep a threshold of one, as before.  Routers use two, since one other relayer may not have
+ * covered what a well placed router does, but two in the same window nearly always have.
+ */
+class RebroadcastSuppressor
+{
+  public:
+    enum Mode : uint8_t {
+        SUPPRESS_FIRST_DUPLICATE, // Cancel on any duplicate, routers never cancel
+        SUPPRESS_COUNTING         // Cancel by the number of distinct relayers heard
+    };
+
+    explicit RebroadcastSuppressor(Mode mode = COUNTING_REBROADCAST_SUPPRESSION ? SUPPRESS_COUNTING : SUPPRESS_FIRST_DUPLICATE)
+        : mode(mode)
+    {
+    }
+
+    Mode getMode() const { return mode; }
+    void setMode(Mode m)
+    {
+        mode = m;
+        clear();
+    }
+
+    /**
+     * We heard relayNode rebroadcast a packet we may be waiting to rebroadcast ourselves
+     * @param isRouter we are a router or repeater, which cover more than a client so need more evidence that we aren't needed
+     * @return true to cancel our rebroadcast
+     */
+    bool onDuplicate(NodeNum from, PacketId id, uint8_t relayNode, bool isRouter);
+
+    void clear();
+
+  private:
+    static constexpr uint8_t CLIENT_RELAYERS = 1;  // Relayers heard before a client gives up
+    static constexpr uint8_t ROUTER_RELAYERS = 2;  // Relayers heard before a router gives up
+    static constexpr uint8_t TRACKED_PACKETS = 16; // Packets we count relayers for, about as many as wait in the TX queue
+
+    struct Entry {
+        NodeNum from;
+        PacketId id;
+        uint8_t numRelayers;
+        uint8_t relayers[ROUTER_RELAYERS];
+    };
+
+    Mode mode;
+    Entry entries[TRACKED_PACKETS] = {};
+    uint8_t nextEntry = 0; // Replaced next, the oldest
+
+    /// How many distinct relayers we have now heard for this packet
+    uint8_t countRelayer(NodeNum from, PacketId id, uint8_t relayNode);
+};
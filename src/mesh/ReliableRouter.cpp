@@ -29,9 +29,12 @@ ErrorCode ReliableRouter::send(meshtastic_MeshPacket *p)
     /* If we have pending retransmissions, add the airtime of this packet to it, because during that time we cannot receive an
        (implicit) ACK. Otherwise, we might retransmit too early.
      */
+    uint32_t airtimeMsec = 0;
     for (auto i = pending.begin(); i != pending.end(); i++) {
         if (i->first.id != p->id) {
-            i->second.nextTxMsec += iface->getPacketTime(p);
+            if (!airtimeMsec)
+                airtimeMsec = iface->getPacketTime(p);
+            i->second.nextTxMsec += airtimeMsec;
         }
     }
 
@@ -76,6 +79,21 @@ bool ReliableRouter::shouldFilterReceived(const meshtastic_MeshPacket *p)
     return isBroadcast(p->to) ? FloodingRouter::shouldFilterReceived(p) : NextHopRouter::shouldFilterReceived(p);
 }
 
+bool ReliableRouter::shouldFilterDupeHeader(const RxHeader &h)
+{
+    // Someone rebroadcasting one of ours might be an implicit ack, which shouldFilterReceived() has to see
+    if (h.from == getNodeNum())
+        return false;
+    if (!(isBroadcast(h.to) ? FloodingRouter::shouldFilterDupeHeader(h) : NextHopRouter::shouldFilterDupeHeader(h)))
+        return false;
+
+    // As in shouldFilterReceived(), we could not hear an ack while this was on the air
+    for (auto i = pending.begin(); i != pending.end(); i++) {
+        i->second.nextTxMsec += h.airtimeMsec;
+    }
+    return true;
+}
+
 /**
  * If we receive a want_ack packet (do not check for wasSeenRecently), send back an ack (this might generate multiple ack sends in
  * case the our first ack gets lost)
@@ -31,4 +31,6 @@ class ReliableRouter : public NextHopRouter
      * We hook this method so we can see packets before FloodingRouter says they should be discarded
      */
     virtual bool shouldFilterReceived(const meshtastic_MeshPacket *p) override;
+
+    virtual bool shouldFilterDupeHeader(const RxHeader &h) override;
 };
\ No newline at end of file
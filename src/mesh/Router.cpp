@@ -5,6 +5,7 @@
 #include "MeshService.h"
 #include "NodeDB.h"
 #include "RTC.h"
+#include "Throttle.h"
 #include "configuration.h"
 #include "detect/LoRaRadioType.h"
 #include "main.h"
@@ -25,6 +26,8 @@
 #define MAX_RX_FROMRADIO                                                                                                         \
     4 // max number of packets destined to our queue, we dispatch packets quickly so it doesn't need to be big
 
+#define RX_STATS_INTERVAL_MS (5 * 60 * 1000) // How often to log the receive handoff histograms
+
 // I think this is right, one packet for each of the three fifos + one packet being currently assembled for TX or RX
 // And every TX packet might have a retransmission packet or an ack alive at any moment
 #define MAX_PACKETS                                                                                                              \
@@ -43,7 +46,7 @@ static uint8_t bytes[MAX_LORA_PAYLOAD_LEN + 1] __attribute__((__aligned__));
  *
  * Currently we only allow one interface, that may change in the future
  */
-Router::Router() : concurrency::OSThread("Router"), fromRadioQueue(MAX_RX_FROMRADIO)
+Router::Router() : concurrency::OSThread("Router"), fromRadioQueue(MAX_RX_FROMRADIO), rxRing(RX_RING_SIZE)
 {
     // This is called pre main(), don't touch anything here, the following code is not safe
 
@@ -65,11 +68,32 @@ Router::Router() : concurrency::OSThread("Router"), fromRadioQueue(MAX_RX_FROMRA
 int32_t Router::runOnce()
 {
     meshtastic_MeshPacket *mp;
+
+    // Clear this first, so anything the radio pushes from here on wakes us again
+    rxWakePending = false;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint32_t batch = 0;
+    while ((mp = rxRing.dequeuePtr(0)) != NULL) {
+        perhapsHandleReceived(mp);
+        batch++;
+    }
+    if (batch)
+        rxBatchSizes.add(batch);
+
     while ((mp = fromRadioQueue.dequeuePtr(0)) != NULL) {
         // printPacket("handle fromRadioQ", mp);
         perhapsHandleReceived(mp);
     }
 
+    if (batch && !Throttle::isWithinTimespanMs(lastRxStatsMs, RX_STATS_INTERVAL_MS)) {
+        lastRxStatsMs = millis();
+        const uint32_t *b = rxBatchSizes.counts, *d = rxRingDepths.counts;
+        LOG_DEBUG("RX batch sizes 1:%u 2-3:%u 4-7:%u 8-15:%u 16+:%u, ring depth 0:%u 1:%u 2-3:%u 4-7:%u 8+:%u, %u overflows", b[1],
+                  b[2], b[3], b[4], b[5], d[0], d[1], d[2], d[3], d[4] + d[5], rxRingOverflows);
+        LOG_DEBUG("RX queue high water: ring %d/%d, fromRadioQueue %d/%d", rxRing.highWaterMark(), RX_RING_SIZE,
+                  fromRadioQueue.highWaterMark(), MAX_RX_FROMRADIO);
+    }
+
     // LOG_DEBUG("Sleep forever!");
     return INT32_MAX; // Wait a long time - until we get woken for the message queue
 }
@@ -93,6 +117,53 @@ void Router::enqueueReceivedMessage(meshtastic_MeshPacket *p)
     setReceivedMessage();
 }
 
+void Router::deliverFromRadio(meshtastic_MeshPacket *p)
+{
+    rxRingDepths.add(rxRing.numUsed());
+    if (!rxRing.enqueue(p, 0)) {
+        // We have fallen well behind, let the shared queue drop the oldest packet
+        rxRingOverflows++;
+        enqueueReceivedMessage(p);
+        return;
+    }
+
+    // One wakeup per batch: the router clears this before it starts draining
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!rxWakePending) {
+        rxWakePending = true;
+        setReceivedMessage();
+        concurrency::mainDelay.interrupt();
+    }
+}
+
+bool Router::handleDupeHeader(const PacketHeader &header, uint32_t airtimeMsec)
+{
+#if ENABLE_JSON_LOGGING
+    return false; // Every packet goes in the trace, duplicates included
+#elif ARCH_PORTDUINO
+    if (settingsStrings[traceFilename] != "" || settingsMap[logoutputlevel] == level_trace)
+        return false;
+#endif
+    // Leave anything perhapsHandleReceived() would drop before shouldFilterReceived() to it
+    if (header.from == NODENUM_BROADCAST || is_in_repeated(config.lora.ignore_incoming, header.from) ||
+        (config.lora.ignore_mqtt && (header.flags & PACKET_FLAGS_VIA_MQTT_MASK)))
+        return false;
+    meshtastic_NodeInfoLite const *node = nodeDB->getMeshNode(header.from);
+    if (node != NULL && node->is_ignored)
+        return false;
+
+    RxHeader h;
+    h.from = header.from;
+    h.to = header.to;
+    h.id = header.id;
+    h.hop_limit = header.flags & PACKET_FLAGS_HOP_LIMIT_MASK;
+    h.hop_start = (header.flags & PACKET_FLAGS_HOP_START_MASK) >> PACKET_FLAGS_HOP_START_SHIFT;
+    h.next_hop = h.hop_start == 0 ? NO_NEXT_HOP_PREFERENCE : header.next_hop;
+    h.relay_node = h.hop_start == 0 ? NO_RELAY_NODE : header.relay_node;
+    h.airtimeMsec = airtimeMsec;
+    return shouldFilterDupeHeader(h);
+}
+
 /// Generate a unique packet id
 // FIXME, move this someplace better
 PacketId generatePacketId()
@@ -392,11 +463,9 @@ DecodeState perhapsDecode(meshtastic_MeshPacket *p)
         for (chIndex = 0; chIndex < channels.getNumChannels(); chIndex++) {
             // Try to use this hash/channel pair
             if (channels.decryptForHash(chIndex, p->channel)) {
-                // we have to copy into a scratch buffer, because these bytes are a union with the decoded protobuf. Create a
-                // fresh copy for each decrypt attempt.
-                memcpy(bytes, p->encrypted.bytes, rawSize);
-                // Try to decrypt the packet if we can
-                crypto->decrypt(p->from, p->id, rawSize, bytes);
+                // These bytes are a union with the decoded protobuf, so decrypt them into our scratch buffer rather than in
+                // place. The ciphertext stays as it was, for the next channel to try or for forwarding the packet as is.
+                crypto->decrypt(p->from, p->id, rawSize, p->encrypted.bytes, bytes);
 
                 // printBytes("plaintext", bytes, p->encrypted.size);
 
@@ -604,8 +673,12 @@ void Router::handleReceived(meshtastic_MeshPacket *p, RxSource src)
     bool skipHandle = false;
     // Also, we should set the time from the ISR and it should have msec level resolution
     p->rx_time = getValidTime(RTCQualityFromNet); // store the arrival timestamp for the phone
-    // Store a copy of encrypted packet for MQTT
-    meshtastic_MeshPacket *p_encrypted = packetPool.allocCopy(*p);
+    // Store a copy of encrypted packet for MQTT, decoding overwrites it.  Without MQTT there's no need to copy every packet.
+    meshtastic_MeshPacket *p_encrypted = NULL;
+#if !MESHTASTIC_EXCLUDE_MQTT
+    if (moduleConfig.mqtt.enabled && mqtt)
+        p_encrypted = packetPool.allocCopy(*p);
+#endif
 
     // Take those raw bytes and convert them back into a well structured protobuf we can understand
     auto decodedState = perhapsDecode(p);
@@ -658,17 +731,17 @@ void Router::handleReceived(meshtastic_MeshPacket *p, RxSource src)
 #if !MESHTASTIC_EXCLUDE_MQTT
         // Mark as pki_encrypted if it is not yet decoded and MQTT encryption is also enabled, hash matches and it's a DM not to
         // us (because we would be able to decrypt it)
-        if (decodedState == DecodeState::DECODE_FAILURE && moduleConfig.mqtt.encryption_enabled && p->channel == 0x00 &&
-            !isBroadcast(p->to) && !isToUs(p))
+        if (p_encrypted && decodedState == DecodeState::DECODE_FAILURE && moduleConfig.mqtt.encryption_enabled &&
+            p->channel == 0x00 && !isBroadcast(p->to) && !isToUs(p))
             p_encrypted->pki_encrypted = true;
         // After potentially altering it, publish received message to MQTT if we're not the original transmitter of the packet
-        if ((decodedState == DecodeState::DECODE_SUCCESS || p_encrypted->pki_encrypted) && moduleConfig.mqtt.enabled &&
-            !isFromUs(p) && mqtt)
+        if (p_encrypted && (decodedState == DecodeState::DECODE_SUCCESS || p_encrypted->pki_encrypted) && !isFromUs(p))
             mqtt->onSend(*p_encrypted, *p, p->channel);
 #endif
     }
 
-    packetPool.release(p_encrypted); // Release the encrypted packet
+    if (p_encrypted)
+        packetPool.release(p_encrypted); // Release the encrypted packet
 }
 
 void Router::perhapsHandleReceived(meshtastic_MeshPacket *p)
@@ -8,6 +8,35 @@
 #include "PointerQueue.h"
 #include "RadioInterface.h"
 #include "concurrency/OSThread.h"
+#include <atomic>
+
+// Packets the radio can hand to the router before it has to fall back on fromRadioQueue
+#define RX_RING_SIZE 16
+
+/// The routing fields of a frame from the radio, read from its PacketHeader the same way they are put in a MeshPacket
+struct RxHeader {
+    NodeNum from, to;
+    PacketId id;
+    uint8_t hop_limit, hop_start;
+    uint8_t next_hop, relay_node; // Only valid if hop_start is set
+    uint32_t airtimeMsec;         // How long the frame was on the air
+};
+
+/// Counts of values in power of two buckets: 0, 1, 2-3, 4-7, 8-15 and 16 or more
+struct Log2Histogram {
+    static constexpr uint8_t NUM_BUCKETS = 6;
+    uint32_t counts[NUM_BUCKETS] = {0};
+
+    void add(uint32_t v)
+    {
+        uint8_t b = 0;
+        while (v && b < NUM_BUCKETS - 1) {
+            v >>= 1;
+            b++;
+        }
+        counts[b]++;
+    }
+};
 
 /**
  * A mesh aware router that supports multiple interfaces.
@@ -16,8 +45,19 @@ class Router : protected concurrency::OSThread, protected PacketHistory
 {
   private:
     /// Packets which have just arrived from the radio, ready to be processed by this service and possibly
-    /// forwarded to the phone.
-    PointerQueue<meshtastic_MeshPacket> fromRadioQueue;
+    /// forwarded to the phone.  Fed from MQTT, UDP and local sends as well, and the producer drops the oldest when it is full.
+    MPMCPointerQueue<meshtastic_MeshPacket> fromRadioQueue;
+
+    /// Packets from our radio, which is the only producer, so they can be handed over without locking.  Drained completely
+    /// each time the router runs.
+    SPSCPointerQueue<meshtastic_MeshPacket> rxRing;
+    std::atomic<bool> rxWakePending{false}; // The radio has already woken us for what is in rxRing
+
+    // Receive handoff statistics, logged now and then by runOnce()
+    Log2Histogram rxBatchSizes; // Packets drained from rxRing per run
+    Log2Histogram rxRingDepths; // Packets already waiting in rxRing when the radio pushed another
+    uint32_t rxRingOverflows = 0;
+    uint32_t lastRxStatsMs = 0;
 
   protected:
     RadioInterface *iface = NULL;
@@ -77,6 +117,20 @@ class Router : protected concurrency::OSThread, protected PacketHistory
      */
     virtual void enqueueReceivedMessage(meshtastic_MeshPacket *p);
 
+    /**
+     * Like enqueueReceivedMessage(), but only for our RadioInterface: it must only ever be called from the radio's thread.
+     * Wakes the router once per batch rather than once per packet.
+     */
+    void deliverFromRadio(meshtastic_MeshPacket *p);
+
+    /**
+     * RadioInterface calls this with the header of each frame it receives, before making a MeshPacket of it.  In a busy mesh
+     * most frames are rebroadcasts of packets we already have, and those can be dealt with from the header alone.
+     *
+     * @return true if the frame was a duplicate and has been handled, so the radio can drop it
+     */
+    bool handleDupeHeader(const PacketHeader &header, uint32_t airtimeMsec);
+
     /**
      * Send a packet on a suitable interface.  This routine will
      * later free() the packet to pool.  This routine is not allowed to stall.
@@ -104,6 +158,14 @@ class Router : protected concurrency::OSThread, protected PacketHistory
      */
     virtual bool shouldFilterReceived(const meshtastic_MeshPacket *p) { return false; }
 
+    /**
+     * Do what shouldFilterReceived() would do for a duplicate we only have the header of.  Duplicates that need the whole packet
+     * (to relay or acknowledge it again) must return false, and will then go through shouldFilterReceived() as usual.
+     *
+     * @return true if h was a duplicate and has been handled
+     */
+    virtual bool shouldFilterDupeHeader(const RxHeader &h) { return false; }
+
     /**
      * Every (non duplicate) packet this node receives will be passed through this method.  This allows subclasses to
      * update routing tables etc... based on what we overhear (even for messages not destined to our node)
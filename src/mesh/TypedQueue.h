@@ -17,6 +17,7 @@ template <class T> class TypedQueue
     static_assert(std::is_standard_layout<T>::value, "T must be standard layout");
     QueueHandle_t h;
     concurrency::OSThread *reader = NULL;
+    int highWater = 0;
 
   public:
     explicit TypedQueue(int maxElements) : h(xQueueCreate(maxElements, sizeof(T))) { assert(h); }
@@ -37,7 +38,12 @@ template <class T> class TypedQueue
             reader->setInterval(0);
             concurrency::mainDelay.interrupt();
         }
-        return xQueueSendToBack(h, &x, maxWait) == pdTRUE;
+        if (xQueueSendToBack(h, &x, maxWait) != pdTRUE)
+            return false;
+        int used = numUsed();
+        if (used > highWater)
+            highWater = used;
+        return true;
     }
 
     bool enqueueFromISR(T x, BaseType_t *higherPriWoken)
@@ -53,6 +59,9 @@ template <class T> class TypedQueue
 
     bool dequeueFromISR(T *p, BaseType_t *higherPriWoken) { return xQueueReceiveFromISR(h, p, higherPriWoken); }
 
+    /** The most elements the queue has held, for sizing it */
+    int highWaterMark() const { return highWater; }
+
     /**
      * Set a thread that is reading from this queue
      * If a message is pushed to this queue that thread will be scheduled to run ASAP.
@@ -75,6 +84,7 @@ template <class T> class TypedQueue
     std::queue<T> q;
     concurrency::OSThread *reader = NULL;
     int maxElements;
+    int highWater = 0;
 
   public:
     explicit TypedQueue(int _maxElements) : maxElements(_maxElements) {}
@@ -101,6 +111,9 @@ template <class T> class TypedQueue
         }
 
         q.push(x);
+        int used = numUsed();
+        if (used > highWater)
+            highWater = used;
         return true;
     }
 
@@ -119,6 +132,9 @@ template <class T> class TypedQueue
 
     // bool dequeueFromISR(T *p, BaseType_t *higherPriWoken) { return xQueueReceiveFromISR(h, p, higherPriWoken); }
 
+    /** The most elements the queue has held, for sizing it */
+    int highWaterMark() const { return highWater; }
+
     void setReader(concurrency::OSThread *t) { reader = t; }
 };
 #endif
\ No newline at end of file
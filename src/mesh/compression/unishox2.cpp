@@ -122,6 +122,11 @@ const int UTF8_PREFIX[] = {0xC0, 0xE0, 0xF0};
 /// global to indicate whether initialization is complete or not
 uint8_t is_inited = 0;
 
+/// Vertical decoder lookup table indexed by the next 8 bits of the stream, filled by init_coder() \n
+/// 3 bits code len (one less, as 8 cannot be accommodated in 3 bits), 5 bits vertical pos
+uint8_t usx_vcode_lookup_full[256];
+void init_vcode_lookup_full();
+
 /// Fills the usx_code_94 94 letter array based on sets of characters at usx_sets \n
 /// For each element in usx_code_94, first 3 msb bits is set (USX_ALPHA / USX_SYM / USX_NUM) \n
 /// and the rest 5 bits indicate the vertical position in the corresponding set
@@ -140,6 +145,7 @@ void init_coder()
             }
         }
     }
+    init_vcode_lookup_full();
     is_inited = 1;
 }
 
@@ -148,34 +154,30 @@ unsigned int usx_mask[] = {0x80, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC, 0xFE, 0xFF};
 
 /// Appends specified number of bits to the output (out) \n
 /// If maximum limit (olen) is reached, -1 is returned \n
-/// Otherwise clen bits in code are appended to out starting with MSB
+/// Otherwise clen bits in code are appended to out starting with MSB \n
+/// At most 8 bits are appended, so they are written as one 16 bit word spanning at most two bytes
 int append_bits(char *out, int olen, int ol, uint8_t code, int clen)
 {
 
     // printf("%d,%x,%d,%d\n", ol, code, clen, state);
 
-    while (clen > 0) {
-        int oidx;
-        unsigned char a_byte;
-
-        uint8_t cur_bit = ol % 8;
-        uint8_t blen = clen;
-        a_byte = code & usx_mask[blen - 1];
-        a_byte >>= cur_bit;
-        if (blen + cur_bit > 8)
-            blen = (8 - cur_bit);
-        oidx = ol / 8;
-        if (oidx < 0 || olen <= oidx)
+    if (clen <= 0)
+        return ol;
+    const uint8_t cur_bit = ol & 0x07;
+    const int oidx = ol >> 3;
+    const uint16_t word = ((code & usx_mask[clen - 1]) << 8) >> cur_bit;
+    if (oidx < 0 || olen <= oidx)
+        return -1;
+    if (cur_bit == 0)
+        out[oidx] = word >> 8;
+    else
+        out[oidx] |= word >> 8;
+    if (cur_bit + clen > 8) {
+        if (olen <= oidx + 1)
             return -1;
-        if (cur_bit == 0)
-            out[oidx] = a_byte;
-        else
-            out[oidx] |= a_byte;
-        code <<= blen;
-        ol += blen;
-        clen -= blen;
+        out[oidx + 1] = word & 0xFF;
     }
-    return ol;
+    return ol + clen;
 }
 
 /// This is a safe call to append_bits() making sure it does not write past olen
@@ -346,6 +348,9 @@ int matchOccurance(const char *in, int len, int l, char *out, int olen, int *ol,
     int longest_dist = 0;
     int longest_len = 0;
     for (j = l - NICE_LEN; j >= 0; j--) {
+        // Anything shorter than NICE_LEN is ignored, so most candidates can be rejected on their first and last byte
+        if (in[j] != in[l] || in[j + NICE_LEN - 1] != in[l + NICE_LEN - 1])
+            continue;
         for (k = l; k < len && j + k - l < l; k++) {
             if (in[k] != in[j + k - l])
                 break;
@@ -552,6 +557,14 @@ int unishox2_compress_lines(const char *in, int len, UNISHOX_API_OUT_AND_LEN(cha
     prev_uni = 0;
     state = USX_ALPHA;
     is_all_upper = 0;
+
+    // Lengths of the templates and frequent sequences, which are tried at every position
+    int template_lens[5] = {0};
+    int freq_seq_lens[6] = {0};
+    for (int i = 0; usx_templates != NULL && i < 5; i++)
+        template_lens[i] = usx_templates[i] ? (int)strlen(usx_templates[i]) : 0;
+    for (int i = 0; usx_freq_seq != NULL && i < 6; i++)
+        freq_seq_lens[i] = (int)strlen(usx_freq_seq[i]);
     SAFE_APPEND_BITS2(rawolen, ol = append_bits(out, olen, ol, UNISHOX_MAGIC_BITS, UNISHOX_MAGIC_BIT_LEN)); // magic bit(s)
     for (l = 0; l < len; l++) {
 
@@ -656,7 +669,7 @@ int unishox2_compress_lines(const char *in, int len, UNISHOX_API_OUT_AND_LEN(cha
             int i;
             for (i = 0; i < 5; i++) {
                 if (usx_templates[i]) {
-                    int rem = (int)strlen(usx_templates[i]);
+                    int rem = template_lens[i];
                     int j = 0;
                     for (; j < rem && l + j < len; j++) {
                         char c_t = usx_templates[i][j];
@@ -702,7 +715,7 @@ int unishox2_compress_lines(const char *in, int len, UNISHOX_API_OUT_AND_LEN(cha
         if (usx_freq_seq != NULL) {
             int i;
             for (i = 0; i < 6; i++) {
-                int seq_len = (int)strlen(usx_freq_seq[i]);
+                int seq_len = freq_seq_lens[i];
                 if (len - seq_len >= 0 && l <= len - seq_len) {
                     if (memcmp(usx_freq_seq[i], in + l, seq_len) == 0 && usx_hcode_lens[usx_freq_codes[i] >> 5]) {
                         SAFE_APPEND_BITS2(rawolen,
@@ -897,15 +910,15 @@ int read8bitCode(const char *in, int len, int bit_no)
     return code;
 }
 
-/// The list of veritical codes is split into 5 sections. Used by readVCodeIdx()
+/// The list of veritical codes is split into 5 sections. Used by init_vcode_lookup_full()
 #define SECTION_COUNT 5
-/// Used by readVCodeIdx() for finding the section under which the code read using read8bitCode() falls
+/// Used by init_vcode_lookup_full() for finding the section under which the code read using read8bitCode() falls
 uint8_t usx_vsections[] = {0x7F, 0xBF, 0xDF, 0xEF, 0xFF};
-/// Used by readVCodeIdx() for finding the section vertical position offset
+/// Used by init_vcode_lookup_full() for finding the section vertical position offset
 uint8_t usx_vsection_pos[] = {0, 4, 8, 12, 20};
-/// Used by readVCodeIdx() for masking the code read by read8bitCode()
+/// Used by init_vcode_lookup_full() for masking the code read by read8bitCode()
 uint8_t usx_vsection_mask[] = {0x7F, 0x3F, 0x1F, 0x0F, 0x0F};
-/// Used by readVCodeIdx() for shifting the code read by read8bitCode() to obtain the vpos
+/// Used by init_vcode_lookup_full() for shifting the code read by read8bitCode() to obtain the vpos
 uint8_t usx_vsection_shift[] = {5, 4, 3, 1, 0};
 
 /// Vertical decoder lookup table - 3 bits code len, 5 bytes vertical pos
@@ -919,27 +932,31 @@ uint8_t usx_vcode_lookup[36] = {(1 << 5) + 0,  (1 << 5) + 0,  (2 << 5) + 1,  (2
                                 (6 << 5) + 17, (6 << 5) + 17, (7 << 5) + 18, (7 << 5) + 19, (7 << 5) + 20, (7 << 5) + 21,
                                 (7 << 5) + 22, (7 << 5) + 23, (7 << 5) + 24, (7 << 5) + 25, (7 << 5) + 26, (7 << 5) + 27};
 
+/// Expands the sectioned usx_vcode_lookup into usx_vcode_lookup_full, so that readVCodeIdx() \n
+/// needs a single lookup rather than a search through the sections
+void init_vcode_lookup_full()
+{
+    for (int code = 0; code < 256; code++) {
+        int i = 0;
+        while (code > usx_vsections[i])
+            i++;
+        usx_vcode_lookup_full[code] =
+            usx_vcode_lookup[usx_vsection_pos[i] + ((code & usx_vsection_mask[i]) >> usx_vsection_shift[i])];
+    }
+}
+
 /// Decodes the vertical code from the given bitstream at in \n
-/// This is designed to use less memory using a 36 uint8_t buffer \n
-/// compared to using a 256 uint8_t buffer to decode the next 8 bits read by read8bitCode() \n
-/// by splitting the list of vertical codes. \n
-/// Decoder is designed for using less memory, not speed. \n
+/// using the next 8 bits read by read8bitCode() as an index into usx_vcode_lookup_full. \n
 /// Returns the veritical code index or 99 if match could not be found. \n
 /// Also updates bit_no_p with how many ever bits used by the vertical code.
 int readVCodeIdx(const char *in, int len, int *bit_no_p)
 {
     if (*bit_no_p < len) {
-        uint8_t code = read8bitCode(in, len, *bit_no_p);
-        int i = 0;
-        do {
-            if (code <= usx_vsections[i]) {
-                uint8_t vcode = usx_vcode_lookup[usx_vsection_pos[i] + ((code & usx_vsection_mask[i]) >> usx_vsection_shift[i])];
-                (*bit_no_p) += ((vcode >> 5) + 1);
-                if (*bit_no_p > len)
-                    return 99;
-                return vcode & 0x1F;
-            }
-        } while (++i < SECTION_COUNT);
+        uint8_t vcode = usx_vcode_lookup_full[read8bitCode(in, len, *bit_no_p)];
+        (*bit_no_p) += ((vcode >> 5) + 1);
+        if (*bit_no_p > len)
+            return 99;
+        return vcode & 0x1F;
     }
     return 99;
 }
@@ -967,32 +984,39 @@ int readHCodeIdx(const char *in, int len, int *bit_no_p, const uint8_t usx_hcode
     return 99;
 }
 
-// TODO: Last value check.. Also len check in readBit
-/// Returns the position of step code (0, 10, 110, etc.) encountered in the stream
+/// Returns the position of step code (0, 10, 110, etc.) encountered in the stream \n
+/// The run of 1 bits is counted from the next 8 bits at once, limit is at most 5
 int getStepCodeIdx(const char *in, int len, int *bit_no_p, int limit)
 {
-    int idx = 0;
-    while (*bit_no_p < len && readBit(in, *bit_no_p)) {
-        idx++;
-        (*bit_no_p)++;
-        if (idx == limit)
-            return idx;
-    }
     if (*bit_no_p >= len)
         return 99;
-    (*bit_no_p)++;
+    // read8bitCode() pads past the end with 1 bits, so a 0 bit found here is always in the stream
+    const uint8_t code = read8bitCode(in, len, *bit_no_p);
+    int idx = __builtin_clz(((uint32_t)(uint8_t)~code << 24) | (1 << 23));
+    if (idx > limit)
+        idx = limit;
+    if (idx > len - *bit_no_p) {
+        *bit_no_p = len;
+        return 99;
+    }
+    *bit_no_p += (idx == limit ? idx : idx + 1);
     return idx;
 }
 
-/// Reads specified number of bits and builds the corresponding integer
+/// Reads specified number of bits and builds the corresponding integer \n
+/// count is at most 24, so the bytes spanned are read into one word and shifted into place
 int32_t getNumFromBits(const char *in, int len, int bit_no, int count)
 {
-    int32_t ret = 0;
-    while (count-- && bit_no < len) {
-        ret += (readBit(in, bit_no) ? 1 << count : 0);
-        bit_no++;
-    }
-    return count < 0 ? ret : -1;
+    if (count <= 0)
+        return 0;
+    if (bit_no + count > len)
+        return -1;
+    const int first = bit_no >> 3;
+    const int last = (bit_no + count - 1) >> 3;
+    uint32_t word = 0;
+    for (int i = first; i <= last; i++)
+        word = (word << 8) | (uint8_t)in[i];
+    return (word >> ((last - first + 1) * 8 - (bit_no & 0x07) - count)) & ((1UL << count) - 1);
 }
 
 /// Decodes the count from the given bit stream at in. Also updates bit_no_p
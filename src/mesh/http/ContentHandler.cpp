@@ -6,6 +6,8 @@
 #include "main.h"
 #include "mesh/http/ContentHelper.h"
 #include "mesh/http/WebServer.h"
+#include "modules/RangeTestModule.h"
+#include "modules/Telemetry/TelemetryHistory.h"
 #if HAS_WIFI
 #include "mesh/wifi/WiFiAPClient.h"
 #endif
@@ -95,6 +97,10 @@ void registerHandlers(HTTPServer *insecureServer, HTTPSServer *secureServer)
     ResourceNode *nodeJsonBlinkLED = new ResourceNode("/json/blink", "POST", &handleBlinkLED);
     ResourceNode *nodeJsonReport = new ResourceNode("/json/report", "GET", &handleReport);
     ResourceNode *nodeJsonNodes = new ResourceNode("/json/nodes", "GET", &handleNodes);
+    ResourceNode *nodeJsonTelemetry = new ResourceNode("/json/telemetry", "GET", &handleTelemetryHistory);
+#if RANGETEST_LOG_BINARY
+    ResourceNode *nodeRangeTestCsv = new ResourceNode("/rangetest.csv", "GET", &handleRangeTestCsv);
+#endif
     ResourceNode *nodeJsonFsBrowseStatic = new ResourceNode("/json/fs/browse/static", "GET", &handleFsBrowseStatic);
     ResourceNode *nodeJsonDelete = new ResourceNode("/json/fs/delete/static", "DELETE", &handleFsDeleteStatic);
 
@@ -115,6 +121,10 @@ void registerHandlers(HTTPServer *insecureServer, HTTPSServer *secureServer)
     secureServer->registerNode(nodeJsonDelete);
     secureServer->registerNode(nodeJsonReport);
     secureServer->registerNode(nodeJsonNodes);
+    secureServer->registerNode(nodeJsonTelemetry);
+#if RANGETEST_LOG_BINARY
+    secureServer->registerNode(nodeRangeTestCsv);
+#endif
     //    secureServer->registerNode(nodeUpdateFs);
     //    secureServer->registerNode(nodeDeleteFs);
     secureServer->registerNode(nodeAdmin);
@@ -137,6 +147,10 @@ void registerHandlers(HTTPServer *insecureServer, HTTPSServer *secureServer)
     insecureServer->registerNode(nodeJsonFsBrowseStatic);
     insecureServer->registerNode(nodeJsonDelete);
     insecureServer->registerNode(nodeJsonReport);
+    insecureServer->registerNode(nodeJsonTelemetry);
+#if RANGETEST_LOG_BINARY
+    insecureServer->registerNode(nodeRangeTestCsv);
+#endif
     //    insecureServer->registerNode(nodeUpdateFs);
     //    insecureServer->registerNode(nodeDeleteFs);
     insecureServer->registerNode(nodeAdmin);
@@ -356,6 +370,8 @@ void handleFsDeleteStatic(HTTPRequest *req, HTTPResponse *res)
     if (params->getQueryParameter("delete", paramValDelete)) {
         std::string pathDelete = "/" + paramValDelete;
         concurrency::LockGuard g(spiLock);
+        if (rangeTestModuleRadio)
+            rangeTestModuleRadio->closeFile(); // In case this is its log, it's opened again on the next write
         if (FSCom.remove(pathDelete.c_str())) {
 
             LOG_INFO("%s", pathDelete.c_str());
@@ -638,6 +654,8 @@ void handleReport(HTTPRequest *req, HTTPResponse *res)
     jsonObjAirtime["rx_log"] = new JSONValue(rxLogValues);
     jsonObjAirtime["rx_all_log"] = new JSONValue(rxAllLogValues);
     jsonObjAirtime["channel_utilization"] = new JSONValue(airTime->channelUtilizationPercent());
+    jsonObjAirtime["channel_utilization_short"] = new JSONValue(airTime->channelUtilizationShortPercent());
+    jsonObjAirtime["channel_utilization_long"] = new JSONValue(airTime->channelUtilizationLongPercent());
     jsonObjAirtime["utilization_tx"] = new JSONValue(airTime->utilizationTXPercent());
     jsonObjAirtime["seconds_since_boot"] = new JSONValue(int(airTime->getSecondsSinceBoot()));
     jsonObjAirtime["seconds_per_period"] = new JSONValue(int(airTime->getSecondsPerPeriod()));
@@ -696,10 +714,47 @@ void handleReport(HTTPRequest *req, HTTPResponse *res)
     delete value;
 }
 
+static JSONObject nodeToJSON(const meshtastic_NodeInfoLite *tempNodeInfo)
+{
+    JSONObject node;
+
+    char id[16];
+    snprintf(id, sizeof(id), "!%08x", tempNodeInfo->num);
+
+    node["id"] = new JSONValue(id);
+    node["snr"] = new JSONValue(tempNodeInfo->snr);
+    node["via_mqtt"] = new JSONValue(BoolToString(tempNodeInfo->via_mqtt));
+    node["last_heard"] = new JSONValue((int)tempNodeInfo->last_heard);
+    node["position"] = new JSONValue();
+
+    if (nodeDB->hasValidPosition(tempNodeInfo)) {
+        JSONObject position;
+        position["latitude"] = new JSONValue((float)tempNodeInfo->position.latitude_i * 1e-7);
+        position["longitude"] = new JSONValue((float)tempNodeInfo->position.longitude_i * 1e-7);
+        position["altitude"] = new JSONValue((int)tempNodeInfo->position.altitude);
+        node["position"] = new JSONValue(position);
+    }
+
+    node["long_name"] = new JSONValue(tempNodeInfo->user.long_name);
+    node["short_name"] = new JSONValue(tempNodeInfo->user.short_name);
+    char macStr[18];
+    snprintf(macStr, sizeof(macStr), "%02X:%02X:%02X:%02X:%02X:%02X", tempNodeInfo->user.macaddr[0],
+             tempNodeInfo->user.macaddr[1], tempNodeInfo->user.macaddr[2], tempNodeInfo->user.macaddr[3],
+             tempNodeInfo->user.macaddr[4], tempNodeInfo->user.macaddr[5]);
+    node["mac_address"] = new JSONValue(macStr);
+    node["hw_model"] = new JSONValue(tempNodeInfo->user.hw_model);
+    return node;
+}
+
+/*
+    The nodes we know about.  ?near=<lat>,<lon> (in degrees) lists only the nodes with a position, nearest to that point first
+    and with their "distance" in meters.  ?count=<n> (default 10) and ?radius=<meters> limit how many are returned.  Malformed or
+    out of range values get a 400.
+*/
 void handleNodes(HTTPRequest *req, HTTPResponse *res)
 {
     ResourceParameters *params = req->getParams();
-    std::string content;
+    std::string content, nearParam;
 
     if (!params->getQueryParameter("content", content)) {
         content = "json";
@@ -716,41 +771,51 @@ void handleNodes(HTTPRequest *req, HTTPResponse *res)
 
     JSONArray nodesArray;
 
-    uint32_t readIndex = 0;
-    const meshtastic_NodeInfoLite *tempNodeInfo = nodeDB->readNextMeshNode(readIndex);
-    while (tempNodeInfo != NULL) {
-        if (tempNodeInfo->has_user) {
-            JSONObject node;
-
-            char id[16];
-            snprintf(id, sizeof(id), "!%08x", tempNodeInfo->num);
-
-            node["id"] = new JSONValue(id);
-            node["snr"] = new JSONValue(tempNodeInfo->snr);
-            node["via_mqtt"] = new JSONValue(BoolToString(tempNodeInfo->via_mqtt));
-            node["last_heard"] = new JSONValue((int)tempNodeInfo->last_heard);
-            node["position"] = new JSONValue();
-
-            if (nodeDB->hasValidPosition(tempNodeInfo)) {
-                JSONObject position;
-                position["latitude"] = new JSONValue((float)tempNodeInfo->position.latitude_i * 1e-7);
-                position["longitude"] = new JSONValue((float)tempNodeInfo->position.longitude_i * 1e-7);
-                position["altitude"] = new JSONValue((int)tempNodeInfo->position.altitude);
-                node["position"] = new JSONValue(position);
-            }
-
-            node["long_name"] = new JSONValue(tempNodeInfo->user.long_name);
-            node["short_name"] = new JSONValue(tempNodeInfo->user.short_name);
-            char macStr[18];
-            snprintf(macStr, sizeof(macStr), "%02X:%02X:%02X:%02X:%02X:%02X", tempNodeInfo->user.macaddr[0],
-                     tempNodeInfo->user.macaddr[1], tempNodeInfo->user.macaddr[2], tempNodeInfo->user.macaddr[3],
-                     tempNodeInfo->user.macaddr[4], tempNodeInfo->user.macaddr[5]);
-            node["mac_address"] = new JSONValue(macStr);
-            node["hw_model"] = new JSONValue(tempNodeInfo->user.hw_model);
+    if (params->getQueryParameter("near", nearParam)) {
+        std::string countParam, radiusParam;
+        size_t comma = nearParam.find(',');
+        double lat, lon, count = 10, radius = INFINITY;
+        const char *error = NULL;
+        if (comma == std::string::npos || !parseNumber(nearParam.substr(0, comma), lat) ||
+            !parseNumber(nearParam.substr(comma + 1), lon) || lat < -90 || lat > 90 || lon < -180 || lon > 180)
+            error = "near must be <latitude>,<longitude> in degrees";
+        else if (params->getQueryParameter("count", countParam) &&
+                 (!parseNumber(countParam, count) || count < 1 || count != floor(count)))
+            error = "count must be a whole number of nodes";
+        else if (params->getQueryParameter("radius", radiusParam) && (!parseNumber(radiusParam, radius) || radius < 0))
+            error = "radius must be a distance in meters";
+
+        if (error) {
+            res->setStatusCode(400);
+            JSONObject jsonObjOuter;
+            jsonObjOuter["status"] = new JSONValue("Error");
+            jsonObjOuter["error"] = new JSONValue(error);
+            JSONValue *value = new JSONValue(jsonObjOuter);
+            res->print(value->Stringify().c_str());
+            delete value;
+            return;
+        }
 
-            nodesArray.push_back(new JSONValue(node));
+        // Nodes without a user aren't listed, so go through every node with a position until we have count of the rest
+        std::vector<NodeDistance> nearest(nodeDB->getNumMeshNodes());
+        size_t found = nodeDB->getNearestNodes((int32_t)lround(lat * 1e7), (int32_t)lround(lon * 1e7), nearest.data(),
+                                               nearest.size(), radius);
+        for (size_t i = 0; i < found && nodesArray.size() < count; i++) {
+            const meshtastic_NodeInfoLite *tempNodeInfo = nodeDB->getMeshNode(nearest[i].num);
+            if (tempNodeInfo && tempNodeInfo->has_user) {
+                JSONObject node = nodeToJSON(tempNodeInfo);
+                node["distance"] = new JSONValue(nearest[i].meters);
+                nodesArray.push_back(new JSONValue(node));
+            }
+        }
+    } else {
+        uint32_t readIndex = 0;
+        const meshtastic_NodeInfoLite *tempNodeInfo = nodeDB->readNextMeshNode(readIndex);
+        while (tempNodeInfo != NULL) {
+            if (tempNodeInfo->has_user)
+                nodesArray.push_back(new JSONValue(nodeToJSON(tempNodeInfo)));
+            tempNodeInfo = nodeDB->readNextMeshNode(readIndex);
         }
-        tempNodeInfo = nodeDB->readNextMeshNode(readIndex);
     }
 
     // collect data to inner data object
@@ -767,6 +832,78 @@ void handleNodes(HTTPRequest *req, HTTPResponse *res)
     delete value;
 }
 
+/*
+    Our recorded telemetry history, oldest first.  ?since=<unix time> limits it to samples taken since then, and
+    ?type=device|environment|power to one kind of telemetry.  Records are written out one at a time, so a long history doesn't
+    have to fit in memory as JSON.
+*/
+void handleTelemetryHistory(HTTPRequest *req, HTTPResponse *res)
+{
+    ResourceParameters *params = req->getParams();
+    std::string sinceParam, typeParam;
+    uint32_t since = 0;
+
+    if (params->getQueryParameter("since", sinceParam)) {
+        since = strtoul(sinceParam.c_str(), NULL, 10);
+    }
+    params->getQueryParameter("type", typeParam);
+
+    res->setHeader("Content-Type", "application/json");
+    res->setHeader("Access-Control-Allow-Origin", "*");
+    res->setHeader("Access-Control-Allow-Methods", "GET");
+
+    const struct {
+        const char *name;
+        pb_size_t variant;
+    } types[] = {{"device", meshtastic_Telemetry_device_metrics_tag},
+                 {"environment", meshtastic_Telemetry_environment_metrics_tag},
+                 {"power", meshtastic_Telemetry_power_metrics_tag}};
+
+    res->print("{\"data\":{\"telemetry\":[");
+    bool first = true;
+    for (const auto &type : types) {
+        if (!telemetryHistory || (!typeParam.empty() && typeParam != type.name))
+            continue;
+
+        meshtastic_Telemetry t;
+        uint32_t after = since ? since - 1 : 0;
+        while (telemetryHistory->next(type.variant, after, t)) {
+            after = t.time;
+
+            JSONObject record;
+            record["time"] = new JSONValue((int)t.time);
+            record["type"] = new JSONValue(type.name);
+            TelemetryHistory::forEachMetric(t,
+                                            [&record](const char *name, float value) { record[name] = new JSONValue(value); });
+
+            JSONValue *value = new JSONValue(record);
+            if (!first)
+                res->print(",");
+            res->print(value->Stringify().c_str());
+            delete value;
+            first = false;
+        }
+    }
+    res->print("]},\"status\":\"ok\"}");
+}
+
+#if RANGETEST_LOG_BINARY
+/*
+    The range test log, converted from its binary form to the CSV it would otherwise have been saved as
+*/
+void handleRangeTestCsv(HTTPRequest *req, HTTPResponse *res)
+{
+    res->setHeader("Content-Type", "text/csv");
+    res->setHeader("Access-Control-Allow-Origin", "*");
+    res->setHeader("Access-Control-Allow-Methods", "GET");
+
+    if (!rangeTestModuleRadio || !rangeTestModuleRadio->exportCsv(*res)) {
+        res->setStatusCode(404);
+        res->println("No range test log");
+    }
+}
+#endif
+
 /*
     This supports the Apple Captive Network Assistant (CNA) Portal
 */
@@ -801,6 +938,8 @@ void handleDeleteFsContent(HTTPRequest *req, HTTPResponse *res)
     LOG_INFO("Delete files from /static/* : ");
 
     concurrency::LockGuard g(spiLock);
+    if (rangeTestModuleRadio)
+        rangeTestModuleRadio->closeFile();
     htmlDeleteDir("/static");
 
     res->println("<p><hr><p><a href=/admin>Back to admin</a>");
@@ -1,4 +1,6 @@
 #include "mesh/http/ContentHelper.h"
+#include <math.h>
+#include <stdlib.h>
 // #include <Arduino.h>
 // #include "main.h"
 
@@ -12,3 +14,10 @@ void replaceAll(std::string &str, const std::string &from, const std::string &to
         start_pos += to.length(); // In case 'to' contains 'from', like replacing 'x' with 'yx'
     }
 }
+
+bool parseNumber(const std::string &str, double &out)
+{
+    char *end;
+    out = strtod(str.c_str(), &end);
+    return !str.empty() && *end == '\0' && isfinite(out);
+}
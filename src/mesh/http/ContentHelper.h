@@ -5,3 +5,6 @@
 #define BoolToString(x) ((x) ? "true" : "false")
 
 void replaceAll(std::string &str, const std::string &from, const std::string &to);
+
+/// Parse the whole of str as a finite number.  @return false if it is empty, isn't a number or has anything after it
+bool parseNumber(const std::string &str, double &out);
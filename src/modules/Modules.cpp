@@ -61,6 +61,7 @@
 #endif
 #if HAS_TELEMETRY
 #include "modules/Telemetry/DeviceTelemetry.h"
+#include "modules/Telemetry/TelemetryHistory.h"
 #endif
 #if HAS_SENSOR && !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR
 #include "main.h"
@@ -216,6 +217,7 @@ void setupModules()
         new HostMetricsModule();
 #endif
 #if HAS_TELEMETRY
+        telemetryHistory = new TelemetryHistory();
         new DeviceTelemetryModule();
 #endif
 // TODO: How to improve this?
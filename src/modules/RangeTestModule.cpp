@@ -25,6 +25,18 @@
 RangeTestModule *rangeTestModule;
 RangeTestModuleRadio *rangeTestModuleRadio;
 
+#if RANGETEST_LOG_BINARY
+#define RANGETEST_LOG_FILE "/static/rangetest.bin"
+#else
+#define RANGETEST_LOG_FILE "/static/rangetest.csv"
+#endif
+
+static const char rangeTestCsvHeader[] =
+    "time,from,sender name,sender lat,sender long,rx lat,rx long,rx elevation,rx snr,distance,hop limit,payload";
+
+// Start of the binary log: magic, format version and record size
+static const uint8_t rangeTestLogHeader[8] = {'M', 'T', 'R', 'T', 1, sizeof(RangeTestRecord), 0, 0};
+
 RangeTestModule::RangeTestModule() : concurrency::OSThread("RangeTest") {}
 
 uint32_t packetSequence = 0;
@@ -182,120 +194,217 @@ ProcessMessage RangeTestModuleRadio::handleReceived(const meshtastic_MeshPacket
 bool RangeTestModuleRadio::appendFile(const meshtastic_MeshPacket &mp)
 {
 #ifdef ARCH_ESP32
-    auto &p = mp.decoded;
-
-    meshtastic_NodeInfoLite *n = nodeDB->getMeshNode(getFrom(&mp));
-    /*
-        LOG_DEBUG("-----------------------------------------");
-        LOG_DEBUG("p.payload.bytes  \"%s\"", p.payload.bytes);
-        LOG_DEBUG("p.payload.size   %d", p.payload.size);
-        LOG_DEBUG("---- Received Packet:");
-        LOG_DEBUG("mp.from          %d", mp.from);
-        LOG_DEBUG("mp.rx_snr        %f", mp.rx_snr);
-        LOG_DEBUG("mp.hop_limit     %d", mp.hop_limit);
-        LOG_DEBUG("---- Node Information of Received Packet (mp.from):");
-        LOG_DEBUG("n->user.long_name         %s", n->user.long_name);
-        LOG_DEBUG("n->user.short_name        %s", n->user.short_name);
-        LOG_DEBUG("n->has_position           %d", n->has_position);
-        LOG_DEBUG("n->position.latitude_i    %d", n->position.latitude_i);
-        LOG_DEBUG("n->position.longitude_i   %d", n->position.longitude_i);
-        LOG_DEBUG("---- Current device location information:");
-        LOG_DEBUG("gpsStatus->getLatitude()     %d", gpsStatus->getLatitude());
-        LOG_DEBUG("gpsStatus->getLongitude()    %d", gpsStatus->getLongitude());
-        LOG_DEBUG("gpsStatus->getHasLock()      %d", gpsStatus->getHasLock());
-        LOG_DEBUG("gpsStatus->getDOP()          %d", gpsStatus->getDOP());
-        LOG_DEBUG("-----------------------------------------");
-    */
-    concurrency::LockGuard g(spiLock);
-    if (!FSBegin()) {
-        LOG_DEBUG("An Error has occurred while mounting the filesystem");
+    if (logCount >= RANGETEST_LOG_BUFFER) {
+        // The flush is overdue, but the radio mustn't wait for it
+        logDropped++;
+        setIntervalFromNow(0);
         return 0;
     }
 
-    if (FSCom.totalBytes() - FSCom.usedBytes() < 51200) {
-        LOG_DEBUG("Filesystem doesn't have enough free space. Aborting write");
-        return 0;
+    RangeTestRecord &r = logBuffer[logCount++];
+    memset(&r, 0, sizeof(r));
+
+    struct timeval tv;
+    if (!gettimeofday(&tv, NULL)) {
+        r.time = tv.tv_sec;
+    }
+
+    r.from = getFrom(&mp);
+    meshtastic_NodeInfoLite *n = nodeDB->getMeshNode(r.from);
+    if (n) {
+        r.senderLat = n->position.latitude_i;
+        r.senderLon = n->position.longitude_i;
+    }
+
+    if (gpsStatus->getIsConnected() || config.position.fixed_position) {
+        r.rxLat = gpsStatus->getLatitude();
+        r.rxLon = gpsStatus->getLongitude();
+        r.rxAlt = gpsStatus->getAltitude();
+    } else {
+        // When the phone API is in use, the node info will be updated with position
+        meshtastic_NodeInfoLite *us = nodeDB->getMeshNode(nodeDB->getNodeNum());
+        r.rxLat = us->position.latitude_i;
+        r.rxLon = us->position.longitude_i;
+        r.rxAlt = us->position.altitude;
+    }
+
+    r.rxSnr = mp.rx_snr;
+    r.hopLimit = mp.hop_limit;
+    r.payloadLen = min(mp.decoded.payload.size, (pb_size_t)RANGETEST_PAYLOAD_LEN);
+    memcpy(r.payload, mp.decoded.payload.bytes, r.payloadLen);
+
+    if (logCount >= RANGETEST_LOG_BUFFER / 2) {
+        setIntervalFromNow(0);
+    }
+#endif
+
+    return 1;
+}
+
+int32_t RangeTestModuleRadio::runOnce()
+{
+#ifdef ARCH_ESP32
+    if (moduleConfig.range_test.save) {
+        flushFile();
+        return RANGETEST_LOG_FLUSH_MSEC;
     }
+#endif
+    return disable();
+}
 
-    FSCom.mkdir("/static");
+bool RangeTestModuleRadio::flushFile()
+{
+#ifdef ARCH_ESP32
+    if (logDropped) {
+        LOG_WARN("Range test log buffer overflowed, %u packets not saved", logDropped);
+        logDropped = 0;
+    }
+    if (!logCount) {
+        return 1;
+    }
 
-    // If the file doesn't exist, write the header.
-    if (!FSCom.exists("/static/rangetest.csv")) {
-        //--------- Write to file
-        File fileToWrite = FSCom.open("/static/rangetest.csv", FILE_WRITE);
+    concurrency::LockGuard g(spiLock);
+    if (!logFile) {
+        if (!FSBegin()) {
+            LOG_DEBUG("An Error has occurred while mounting the filesystem");
+            return 0;
+        }
 
-        if (!fileToWrite) {
-            LOG_ERROR("There was an error opening the file for writing");
+        FSCom.mkdir("/static");
+        bool isNew = !FSCom.exists(RANGETEST_LOG_FILE);
+        logFile = FSCom.open(RANGETEST_LOG_FILE, FILE_APPEND);
+        if (!logFile) {
+            LOG_ERROR("There was an error opening the file for appending");
             return 0;
         }
 
-        // Print the CSV header
-        if (fileToWrite.println(
-                "time,from,sender name,sender lat,sender long,rx lat,rx long,rx elevation,rx snr,distance,hop limit,payload")) {
-            LOG_INFO("File was written");
-        } else {
-            LOG_ERROR("File write failed");
+        // If the file is new, write the header
+        if (isNew) {
+#if RANGETEST_LOG_BINARY
+            logFile.write(rangeTestLogHeader, sizeof(rangeTestLogHeader));
+#else
+            logFile.println(rangeTestCsvHeader);
+#endif
         }
-        fileToWrite.flush();
-        fileToWrite.close();
     }
 
-    //--------- Append content to file
-    File fileToAppend = FSCom.open("/static/rangetest.csv", FILE_APPEND);
+    if (FSCom.totalBytes() - FSCom.usedBytes() < 51200) {
+        LOG_DEBUG("Filesystem doesn't have enough free space. Aborting write");
+        return 0;
+    }
 
-    if (!fileToAppend) {
-        LOG_ERROR("There was an error opening the file for appending");
+    uint8_t written = 0;
+    for (; written < logCount; written++) {
+#if RANGETEST_LOG_BINARY
+        if (logFile.write((const uint8_t *)&logBuffer[written], sizeof(RangeTestRecord)) != sizeof(RangeTestRecord))
+            break;
+#else
+        if (!printCsv(logFile, logBuffer[written]))
+            break;
+#endif
+    }
+    logFile.flush();
+    LOG_DEBUG("Range test log: wrote %u packets", written);
+
+    // Only forget what made it to the file, the rest is tried again next time
+    logCount -= written;
+    memmove(logBuffer, logBuffer + written, logCount * sizeof(RangeTestRecord));
+    if (logCount) {
+        LOG_ERROR("Range test log: write failed, %u packets kept for later", logCount);
+        logFile.close(); // Opened again next time
         return 0;
     }
+#endif
 
-    struct timeval tv;
-    if (!gettimeofday(&tv, NULL)) {
-        long hms = tv.tv_sec % SEC_PER_DAY;
-        hms = (hms + SEC_PER_DAY) % SEC_PER_DAY;
+    return 1;
+}
+
+void RangeTestModuleRadio::closeFile()
+{
+#ifdef ARCH_ESP32
+    if (logFile)
+        logFile.close();
+#endif
+}
+
+size_t RangeTestModuleRadio::printCsv(Print &out, const RangeTestRecord &r)
+{
+    size_t len = 0;
+#ifdef ARCH_ESP32
+    if (r.time) {
+        long hms = r.time % SEC_PER_DAY;
 
         // Tear apart hms into h:m:s
         int hour = hms / SEC_PER_HOUR;
         int min = (hms % SEC_PER_HOUR) / SEC_PER_MIN;
         int sec = (hms % SEC_PER_HOUR) % SEC_PER_MIN; // or hms % SEC_PER_MIN
 
-        fileToAppend.printf("%02d:%02d:%02d,", hour, min, sec); // Time
-    } else {
-        fileToAppend.printf("??:??:??,"); // Time
-    }
-
-    fileToAppend.printf("%d,", getFrom(&mp));                   // From
-    fileToAppend.printf("%s,", n->user.long_name);              // Long Name
-    fileToAppend.printf("%f,", n->position.latitude_i * 1e-7);  // Sender Lat
-    fileToAppend.printf("%f,", n->position.longitude_i * 1e-7); // Sender Long
-    if (gpsStatus->getIsConnected() || config.position.fixed_position) {
-        fileToAppend.printf("%f,", gpsStatus->getLatitude() * 1e-7);  // RX Lat
-        fileToAppend.printf("%f,", gpsStatus->getLongitude() * 1e-7); // RX Long
-        fileToAppend.printf("%d,", gpsStatus->getAltitude());         // RX Altitude
+        len += out.printf("%02d:%02d:%02d,", hour, min, sec); // Time
     } else {
-        // When the phone API is in use, the node info will be updated with position
-        meshtastic_NodeInfoLite *us = nodeDB->getMeshNode(nodeDB->getNodeNum());
-        fileToAppend.printf("%f,", us->position.latitude_i * 1e-7);  // RX Lat
-        fileToAppend.printf("%f,", us->position.longitude_i * 1e-7); // RX Long
-        fileToAppend.printf("%d,", us->position.altitude);           // RX Altitude
+        len += out.printf("??:??:??,"); // Time
     }
 
-    fileToAppend.printf("%f,", mp.rx_snr); // RX SNR
-
-    if (n->position.latitude_i && n->position.longitude_i && gpsStatus->getLatitude() && gpsStatus->getLongitude()) {
-        float distance = GeoCoord::latLongToMeter(n->position.latitude_i * 1e-7, n->position.longitude_i * 1e-7,
-                                                  gpsStatus->getLatitude() * 1e-7, gpsStatus->getLongitude() * 1e-7);
-        fileToAppend.printf("%f,", distance); // Distance in meters
+    meshtastic_NodeInfoLite *n = nodeDB->getMeshNode(r.from);
+    len += out.printf("%d,", r.from);                     // From
+    len += out.printf("%s,", n ? n->user.long_name : ""); // Long Name
+    len += out.printf("%f,", r.senderLat * 1e-7);         // Sender Lat
+    len += out.printf("%f,", r.senderLon * 1e-7);         // Sender Long
+    len += out.printf("%f,", r.rxLat * 1e-7);             // RX Lat
+    len += out.printf("%f,", r.rxLon * 1e-7);             // RX Long
+    len += out.printf("%d,", r.rxAlt);                    // RX Altitude
+    len += out.printf("%f,", r.rxSnr);                    // RX SNR
+
+    if (r.senderLat && r.senderLon && r.rxLat && r.rxLon) {
+        float distance = GeoCoord::latLongToMeter(r.senderLat * 1e-7, r.senderLon * 1e-7, r.rxLat * 1e-7, r.rxLon * 1e-7);
+        len += out.printf("%f,", distance); // Distance in meters
     } else {
-        fileToAppend.printf("0,");
+        len += out.printf("0,");
     }
 
-    fileToAppend.printf("%d,", mp.hop_limit); // Packet Hop Limit
+    len += out.printf("%d,", r.hopLimit); // Packet Hop Limit
 
     // TODO: If quotes are found in the payload, it has to be escaped.
-    fileToAppend.printf("\"%s\"\n", p.payload.bytes);
-    fileToAppend.flush();
-    fileToAppend.close();
+    len += out.printf("\"%.*s\"\n", r.payloadLen, r.payload);
 #endif
+    return len;
+}
+
+bool RangeTestModuleRadio::exportCsv(Print &out)
+{
+#if defined(ARCH_ESP32) && RANGETEST_LOG_BINARY
+    flushFile();
+
+    // Read a few records at a time, so the SPI bus isn't held while the output is being sent
+    RangeTestRecord records[8];
+    size_t offset = sizeof(rangeTestLogHeader);
+    size_t count;
+
+    out.println(rangeTestCsvHeader);
+    do {
+        {
+            concurrency::LockGuard g(spiLock);
+            File file = FSCom.open(RANGETEST_LOG_FILE, FILE_O_READ);
+            if (!file) {
+                return 0;
+            }
+            uint8_t header[sizeof(rangeTestLogHeader)];
+            if (offset == sizeof(rangeTestLogHeader) &&
+                (file.read(header, sizeof(header)) != sizeof(header) || memcmp(header, rangeTestLogHeader, sizeof(header)))) {
+                LOG_ERROR("%s is not a range test log", RANGETEST_LOG_FILE);
+                return 0;
+            }
+            file.seek(offset);
+            count = file.read((uint8_t *)records, sizeof(records)) / sizeof(RangeTestRecord);
+            offset += count * sizeof(RangeTestRecord);
+            file.close();
+        }
+        for (size_t i = 0; i < count; i++) {
+            printCsv(out, records[i]);
+        }
+    } while (count == sizeof(records) / sizeof(records[0]));
 
     return 1;
-}
\ No newline at end of file
+#else
+    return 0;
+#endif
+}
@@ -1,11 +1,46 @@
 #pragma once
 
+#include "FSCommon.h"
 #include "SinglePortModule.h"
 #include "concurrency/OSThread.h"
 #include "configuration.h"
 #include <Arduino.h>
 #include <functional>
 
+// Received packets are held in RAM and written to the filesystem in batches, so the radio path never waits on flash
+#ifndef RANGETEST_LOG_BUFFER
+#define RANGETEST_LOG_BUFFER 16
+#endif
+
+// Write out whatever has been buffered at least this often
+#ifndef RANGETEST_LOG_FLUSH_MSEC
+#define RANGETEST_LOG_FLUSH_MSEC (30 * 1000)
+#endif
+
+// Log fixed size binary records to /static/rangetest.bin rather than CSV, for a smaller file and less flash wear.  The web
+// server converts it back to CSV at /rangetest.csv
+#ifndef RANGETEST_LOG_BINARY
+#define RANGETEST_LOG_BINARY 0
+#endif
+
+#define RANGETEST_PAYLOAD_LEN 30
+
+/**
+ * One received range test packet, as buffered in RAM and stored in the binary log
+ */
+struct RangeTestRecord {
+    uint32_t time; // Seconds since 1970, 0 if the clock wasn't set
+    uint32_t from;
+    int32_t senderLat, senderLon; // 1e-7 degrees
+    int32_t rxLat, rxLon;         // 1e-7 degrees
+    int32_t rxAlt;                // Metres
+    float rxSnr;
+    uint8_t hopLimit;
+    uint8_t payloadLen;
+    char payload[RANGETEST_PAYLOAD_LEN]; // Truncated if longer, not NUL terminated
+};
+static_assert(sizeof(RangeTestRecord) == 64, "RangeTestRecord is stored on flash, don't change its layout");
+
 class RangeTestModule : private concurrency::OSThread
 {
     bool firstTime = 1;
@@ -24,12 +59,23 @@ extern RangeTestModule *rangeTestModule;
  * Radio interface for RangeTestModule
  *
  */
-class RangeTestModuleRadio : public SinglePortModule
+class RangeTestModuleRadio : public SinglePortModule, private concurrency::OSThread
 {
     uint32_t lastRxID = 0;
 
+    RangeTestRecord logBuffer[RANGETEST_LOG_BUFFER];
+    uint8_t logCount = 0;
+    uint32_t logDropped = 0; // Packets which arrived while the buffer was full
+#ifdef FSCom
+    File logFile;
+#endif
+
+    /// @return the number of bytes written, 0 if out took none
+    static size_t printCsv(Print &out, const RangeTestRecord &r);
+
   public:
-    RangeTestModuleRadio() : SinglePortModule("RangeTestModuleRadio", meshtastic_PortNum_RANGE_TEST_APP)
+    RangeTestModuleRadio()
+        : SinglePortModule("RangeTestModuleRadio", meshtastic_PortNum_RANGE_TEST_APP), concurrency::OSThread("RangeTestLog")
     {
         loopbackOk = true; // Allow locally generated messages to loop back to the client
     }
@@ -40,10 +86,25 @@ class RangeTestModuleRadio : public SinglePortModule
     void sendPayload(NodeNum dest = NODENUM_BROADCAST, bool wantReplies = false);
 
     /**
-     * Append range test data to the file on the Filesystem
+     * Buffer range test data to be appended to the file on the Filesystem by flushFile()
      */
     bool appendFile(const meshtastic_MeshPacket &mp);
 
+    /**
+     * Append everything buffered by appendFile() to the file, through one file handle which is kept open between calls
+     */
+    bool flushFile();
+
+    /**
+     * Close the file flushFile() keeps open, before something else removes it.  Call with spiLock held.
+     */
+    void closeFile();
+
+    /**
+     * Write the binary log out as CSV, in the same format as the CSV log
+     */
+    bool exportCsv(Print &out);
+
   protected:
     /** Called to handle a particular incoming message
 
@@ -51,6 +112,9 @@ class RangeTestModuleRadio : public SinglePortModule
     it
     */
     virtual ProcessMessage handleReceived(const meshtastic_MeshPacket &mp) override;
+
+    /** Writes out the buffer every RANGETEST_LOG_FLUSH_MSEC, or sooner once it is half full */
+    virtual int32_t runOnce() override;
 };
 
 extern RangeTestModuleRadio *rangeTestModuleRadio;
@@ -18,6 +18,8 @@ class RoutingModule : public ProtobufModule<meshtastic_Routing>
 
     // Given the hopStart and hopLimit upon reception of a request, return the hop limit to use for the response
     uint8_t getHopLimitForResponse(uint8_t hopStart, uint8_t hopLimit);
+    // The same, for a node configured with configuredHopLimit rather than us
+    static uint8_t getHopLimitForResponse(uint8_t hopStart, uint8_t hopLimit, uint8_t configuredHopLimit);
 
   protected:
     friend class Router;
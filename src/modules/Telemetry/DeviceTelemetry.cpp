@@ -6,6 +6,7 @@
 #include "PowerFSM.h"
 #include "RTC.h"
 #include "RadioLibInterface.h"
+#include "TelemetryHistory.h"
 #include "Router.h"
 #include "configuration.h"
 #include "main.h"
@@ -19,6 +20,11 @@
 int32_t DeviceTelemetryModule::runOnce()
 {
     refreshUptime();
+    if (telemetryHistory) {
+        meshtastic_Telemetry history = getDeviceTelemetry();
+        history.time = getValidTime(RTCQualityFromNet);
+        telemetryHistory->record(history);
+    }
     bool isImpoliteRole =
         IS_ONE_OF(config.device.role, meshtastic_Config_DeviceConfig_Role_SENSOR, meshtastic_Config_DeviceConfig_Role_ROUTER);
     if (((lastSentToMesh == 0) ||
@@ -77,6 +83,9 @@ meshtastic_MeshPacket *DeviceTelemetryModule::allocReply()
         }
         // Check for a request for device metrics
         if (decoded->which_variant == meshtastic_Telemetry_device_metrics_tag) {
+            // Our own phone asking for everything since a time gets our recorded history instead
+            if (telemetryHistory && telemetryHistory->replayIfRequested(req, *decoded))
+                return NULL;
             LOG_INFO("Device telemetry reply to request");
             return allocDataProtobuf(getDeviceTelemetry());
         } else if (decoded->which_variant == meshtastic_Telemetry_local_stats_tag) {
@@ -10,6 +10,7 @@
 #include "PowerFSM.h"
 #include "RTC.h"
 #include "Router.h"
+#include "TelemetryHistory.h"
 #include "UnitConversions.h"
 #include "buzz.h"
 #include "graphics/SharedUIDisplay.h"
@@ -325,6 +326,14 @@ int32_t EnvironmentTelemetryModule::runOnce()
 #endif
         }
 
+        if (telemetryHistory) {
+            meshtastic_Telemetry history = meshtastic_Telemetry_init_zero;
+            if (getEnvironmentTelemetry(&history)) {
+                history.time = getValidTime(RTCQualityFromNet);
+                telemetryHistory->record(history);
+            }
+        }
+
         if (((lastSentToMesh == 0) ||
              !Throttle::isWithinTimespanMs(lastSentToMesh, Default::getConfiguredOrDefaultMsScaled(
                                                                moduleConfig.telemetry.environment_update_interval,
@@ -549,140 +558,140 @@ bool EnvironmentTelemetryModule::getEnvironmentTelemetry(meshtastic_Telemetry *m
     hasSensor = true;
 #else
     if (dfRobotLarkSensor.hasSensor()) {
-        valid = valid && dfRobotLarkSensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&dfRobotLarkSensor, m);
         hasSensor = true;
     }
     if (dfRobotGravitySensor.hasSensor()) {
-        valid = valid && dfRobotGravitySensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&dfRobotGravitySensor, m);
         hasSensor = true;
     }
     if (sht31Sensor.hasSensor()) {
-        valid = valid && sht31Sensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&sht31Sensor, m);
         hasSensor = true;
     }
     if (sht4xSensor.hasSensor()) {
-        valid = valid && sht4xSensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&sht4xSensor, m);
         hasSensor = true;
     }
     if (lps22hbSensor.hasSensor()) {
-        valid = valid && lps22hbSensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&lps22hbSensor, m);
         hasSensor = true;
     }
     if (shtc3Sensor.hasSensor()) {
-        valid = valid && shtc3Sensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&shtc3Sensor, m);
         hasSensor = true;
     }
     if (bmp085Sensor.hasSensor()) {
-        valid = valid && bmp085Sensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&bmp085Sensor, m);
         hasSensor = true;
     }
 #if __has_include(<Adafruit_BME280.h>)
     if (bmp280Sensor.hasSensor()) {
-        valid = valid && bmp280Sensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&bmp280Sensor, m);
         hasSensor = true;
     }
 #endif
     if (bme280Sensor.hasSensor()) {
-        valid = valid && bme280Sensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&bme280Sensor, m);
         hasSensor = true;
     }
     if (ltr390uvSensor.hasSensor()) {
-        valid = valid && ltr390uvSensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&ltr390uvSensor, m);
         hasSensor = true;
     }
     if (bmp3xxSensor.hasSensor()) {
-        valid = valid && bmp3xxSensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&bmp3xxSensor, m);
         hasSensor = true;
     }
     if (bme680Sensor.hasSensor()) {
-        valid = valid && bme680Sensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&bme680Sensor, m);
         hasSensor = true;
     }
     if (dps310Sensor.hasSensor()) {
-        valid = valid && dps310Sensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&dps310Sensor, m);
         hasSensor = true;
     }
     if (mcp9808Sensor.hasSensor()) {
-        valid = valid && mcp9808Sensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&mcp9808Sensor, m);
         hasSensor = true;
     }
     if (ina219Sensor.hasSensor()) {
-        valid = valid && ina219Sensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&ina219Sensor, m);
         hasSensor = true;
     }
     if (ina260Sensor.hasSensor()) {
-        valid = valid && ina260Sensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&ina260Sensor, m);
         hasSensor = true;
     }
     if (ina3221Sensor.hasSensor()) {
-        valid = valid && ina3221Sensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&ina3221Sensor, m);
         hasSensor = true;
     }
     if (veml7700Sensor.hasSensor()) {
-        valid = valid && veml7700Sensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&veml7700Sensor, m);
         hasSensor = true;
     }
     if (tsl2591Sensor.hasSensor()) {
-        valid = valid && tsl2591Sensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&tsl2591Sensor, m);
         hasSensor = true;
     }
     if (opt3001Sensor.hasSensor()) {
-        valid = valid && opt3001Sensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&opt3001Sensor, m);
         hasSensor = true;
     }
     if (mlx90632Sensor.hasSensor()) {
-        valid = valid && mlx90632Sensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&mlx90632Sensor, m);
         hasSensor = true;
     }
     if (rcwl9620Sensor.hasSensor()) {
-        valid = valid && rcwl9620Sensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&rcwl9620Sensor, m);
         hasSensor = true;
     }
     if (nau7802Sensor.hasSensor()) {
-        valid = valid && nau7802Sensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&nau7802Sensor, m);
         hasSensor = true;
     }
     if (aht10Sensor.hasSensor()) {
         if (!bmp280Sensor.hasSensor() && !bmp3xxSensor.hasSensor()) {
-            valid = valid && aht10Sensor.getMetrics(m);
+            valid = valid && sampler.getMetrics(&aht10Sensor, m);
             hasSensor = true;
         } else if (bmp280Sensor.hasSensor()) {
             // prefer bmp280 temp if both sensors are present, fetch only humidity
             meshtastic_Telemetry m_ahtx = meshtastic_Telemetry_init_zero;
             LOG_INFO("AHTX0+BMP280 module detected: using temp from BMP280 and humy from AHTX0");
-            aht10Sensor.getMetrics(&m_ahtx);
+            sampler.getMetrics(&aht10Sensor, &m_ahtx);
             m->variant.environment_metrics.relative_humidity = m_ahtx.variant.environment_metrics.relative_humidity;
             m->variant.environment_metrics.has_relative_humidity = m_ahtx.variant.environment_metrics.has_relative_humidity;
         } else {
             // prefer bmp3xx temp if both sensors are present, fetch only humidity
             meshtastic_Telemetry m_ahtx = meshtastic_Telemetry_init_zero;
             LOG_INFO("AHTX0+BMP3XX module detected: using temp from BMP3XX and humy from AHTX0");
-            aht10Sensor.getMetrics(&m_ahtx);
+            sampler.getMetrics(&aht10Sensor, &m_ahtx);
             m->variant.environment_metrics.relative_humidity = m_ahtx.variant.environment_metrics.relative_humidity;
             m->variant.environment_metrics.has_relative_humidity = m_ahtx.variant.environment_metrics.has_relative_humidity;
         }
     }
     if (max17048Sensor.hasSensor()) {
-        valid = valid && max17048Sensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&max17048Sensor, m);
         hasSensor = true;
     }
     if (cgRadSens.hasSensor()) {
-        valid = valid && cgRadSens.getMetrics(m);
+        valid = valid && sampler.getMetrics(&cgRadSens, m);
         hasSensor = true;
     }
     if (pct2075Sensor.hasSensor()) {
-        valid = valid && pct2075Sensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&pct2075Sensor, m);
         hasSensor = true;
     }
 #ifdef HAS_RAKPROT
-    valid = valid && rak9154Sensor.getMetrics(m);
+    valid = valid && sampler.getMetrics(&rak9154Sensor, m);
     hasSensor = true;
 #endif
 #if __has_include("RAK12035_SoilMoisture.h") && defined(RAK_4631) &&                                                             \
                   RAK_4631 ==                                                                                                    \
                       1 // Not really needed, but may as well just skip at a lower level it if no library or not a RAK_4631
     if (rak12035Sensor.hasSensor()) {
-        valid = valid && rak12035Sensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&rak12035Sensor, m);
         hasSensor = true;
     }
 #endif
@@ -706,6 +715,9 @@ meshtastic_MeshPacket *EnvironmentTelemetryModule::allocReply()
         }
         // Check for a request for environment metrics
         if (decoded->which_variant == meshtastic_Telemetry_environment_metrics_tag) {
+            // Our own phone asking for everything since a time gets our recorded history instead
+            if (telemetryHistory && telemetryHistory->replayIfRequested(req, *decoded))
+                return NULL;
             meshtastic_Telemetry m = meshtastic_Telemetry_init_zero;
             if (getEnvironmentTelemetry(&m)) {
                 LOG_INFO("Environment telemetry reply to request");
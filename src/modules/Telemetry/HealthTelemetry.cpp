@@ -175,11 +175,11 @@ bool HealthTelemetryModule::getHealthTelemetry(meshtastic_Telemetry *m)
     m->variant.health_metrics = meshtastic_HealthMetrics_init_zero;
 
     if (max30102Sensor.hasSensor()) {
-        valid = valid && max30102Sensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&max30102Sensor, m);
         hasSensor = true;
     }
     if (mlx90614Sensor.hasSensor()) {
-        valid = valid && mlx90614Sensor.getMetrics(m);
+        valid = valid && sampler.getMetrics(&mlx90614Sensor, m);
         hasSensor = true;
     }
 
@@ -10,6 +10,7 @@
 #include "PowerTelemetry.h"
 #include "RTC.h"
 #include "Router.h"
+#include "TelemetryHistory.h"
 #include "graphics/SharedUIDisplay.h"
 #include "main.h"
 #include "power.h"
@@ -87,6 +88,14 @@ int32_t PowerTelemetryModule::runOnce()
         if (!moduleConfig.telemetry.power_measurement_enabled)
             return disable();
 
+        if (telemetryHistory) {
+            meshtastic_Telemetry history = meshtastic_Telemetry_init_zero;
+            if (getPowerTelemetry(&history)) {
+                history.time = getValidTime(RTCQualityFromNet);
+                telemetryHistory->record(history);
+            }
+        }
+
         if (((lastSentToMesh == 0) || !Throttle::isWithinTimespanMs(lastSentToMesh, sendToMeshIntervalMs)) &&
             airTime->isTxAllowedAirUtil()) {
             sendTelemetry();
@@ -196,15 +205,15 @@ bool PowerTelemetryModule::getPowerTelemetry(meshtastic_Telemetry *m)
     m->variant.power_metrics = meshtastic_PowerMetrics_init_zero;
 #if HAS_TELEMETRY
     if (ina219Sensor.hasSensor())
-        valid = ina219Sensor.getMetrics(m);
+        valid = sampler.getMetrics(&ina219Sensor, m);
     if (ina226Sensor.hasSensor())
-        valid = ina226Sensor.getMetrics(m);
+        valid = sampler.getMetrics(&ina226Sensor, m);
     if (ina260Sensor.hasSensor())
-        valid = ina260Sensor.getMetrics(m);
+        valid = sampler.getMetrics(&ina260Sensor, m);
     if (ina3221Sensor.hasSensor())
-        valid = ina3221Sensor.getMetrics(m);
+        valid = sampler.getMetrics(&ina3221Sensor, m);
     if (max17048Sensor.hasSensor())
-        valid = max17048Sensor.getMetrics(m);
+        valid = sampler.getMetrics(&max17048Sensor, m);
 #endif
 
     return valid;
@@ -226,6 +235,9 @@ meshtastic_MeshPacket *PowerTelemetryModule::allocReply()
         }
         // Check for a request for power metrics
         if (decoded->which_variant == meshtastic_Telemetry_power_metrics_tag) {
+            // Our own phone asking for everything since a time gets our recorded history instead
+            if (telemetryHistory && telemetryHistory->replayIfRequested(req, *decoded))
+                return NULL;
             meshtastic_Telemetry m = meshtastic_Telemetry_init_zero;
             if (getPowerTelemetry(&m)) {
                 LOG_INFO("Power telemetry reply to request");
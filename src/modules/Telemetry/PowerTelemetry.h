@@ -7,6 +7,7 @@
 #include "../mesh/generated/meshtastic/telemetry.pb.h"
 #include "NodeDB.h"
 #include "ProtobufModule.h"
+#include "Sensor/TelemetrySampler.h"
 #include <OLEDDisplay.h>
 #include <OLEDDisplayUi.h>
 
@@ -51,6 +52,8 @@ class PowerTelemetryModule : private concurrency::OSThread, public ProtobufModul
     bool firstTime = 1;
     meshtastic_MeshPacket *lastMeasurementPacket;
     uint32_t sendToPhoneIntervalMs = SECONDS_IN_MINUTE * 1000; // Send to phone every minute
+    // Keeps fresh readings on hand so sending doesn't wait on the sensors
+    TelemetrySampler sampler{"PowerSampler", meshtastic_Telemetry_power_metrics_tag, sendToPhoneIntervalMs};
     uint32_t lastSentToMesh = 0;
     uint32_t lastSentToPhone = 0;
     uint32_t sensor_read_error_count = 0;
@@ -39,10 +39,32 @@ int32_t MAX30102Sensor::runOnce()
 
 void MAX30102Sensor::setup() {}
 
+void MAX30102Sensor::collectSamples()
+{
+    max30102.check();
+    while (samples < MAX30102_BUFFER_LEN && max30102.available()) {
+        red_buff[samples] = max30102.getRed();
+        ir_buff[samples] = max30102.getIR();
+        max30102.nextSample();
+        samples++;
+    }
+}
+
+uint32_t MAX30102Sensor::startConversion()
+{
+    samples = 0;
+    // A second of samples at 100Hz, drained from the FIFO as they arrive
+    return 100;
+}
+
+uint32_t MAX30102Sensor::pollConversion()
+{
+    collectSamples();
+    return samples < MAX30102_BUFFER_LEN ? 100 : 0;
+}
+
 bool MAX30102Sensor::getMetrics(meshtastic_Telemetry *measurement)
 {
-    uint32_t ir_buff[MAX30102_BUFFER_LEN];
-    uint32_t red_buff[MAX30102_BUFFER_LEN];
     int32_t spo2;
     int8_t spo2_valid;
     int32_t heart_rate;
@@ -53,17 +75,13 @@ bool MAX30102Sensor::getMetrics(meshtastic_Telemetry *measurement)
     measurement->variant.environment_metrics.has_temperature = true;
     measurement->variant.health_metrics.temperature = temp;
     measurement->variant.health_metrics.has_temperature = true;
-    for (byte i = 0; i < MAX30102_BUFFER_LEN; i++) {
-        while (max30102.available() == false)
-            max30102.check();
-
-        red_buff[i] = max30102.getRed();
-        ir_buff[i] = max30102.getIR();
-        max30102.nextSample();
-    }
+    // Wait for whatever startConversion() didn't already collect
+    while (samples < MAX30102_BUFFER_LEN)
+        collectSamples();
 
     maxim_heart_rate_and_oxygen_saturation(ir_buff, MAX30102_BUFFER_LEN, red_buff, &spo2, &spo2_valid, &heart_rate,
                                            &heart_rate_valid);
+    samples = 0;
     LOG_DEBUG("heart_rate=%d(%d), sp02=%d(%d)", heart_rate, heart_rate_valid, spo2, spo2_valid);
     if (heart_rate_valid) {
         measurement->variant.health_metrics.has_heart_bpm = true;
@@ -13,6 +13,11 @@ class MAX30102Sensor : public TelemetrySensor
   private:
     MAX30105 max30102 = MAX30105();
     uint32_t _speed = 200000UL;
+    uint32_t ir_buff[MAX30102_BUFFER_LEN];
+    uint32_t red_buff[MAX30102_BUFFER_LEN];
+    uint8_t samples = 0; // How much of the buffers startConversion() has filled so far
+
+    void collectSamples();
 
   protected:
     virtual void setup() override;
@@ -21,6 +26,8 @@ class MAX30102Sensor : public TelemetrySensor
     MAX30102Sensor();
     virtual int32_t runOnce() override;
     virtual bool getMetrics(meshtastic_Telemetry *measurement) override;
+    virtual uint32_t startConversion() override;
+    virtual uint32_t pollConversion() override;
 };
 
 #endif
\ No newline at end of file
@@ -25,10 +25,20 @@ bool RCWL9620Sensor::getMetrics(meshtastic_Telemetry *measurement)
 {
     measurement->variant.environment_metrics.has_distance = true;
     LOG_DEBUG("RCWL9620 getMetrics");
-    measurement->variant.environment_metrics.distance = getDistance();
+    if (_measuring) {
+        measurement->variant.environment_metrics.distance = readDistance();
+    } else {
+        measurement->variant.environment_metrics.distance = getDistance();
+    }
     return true;
 }
 
+uint32_t RCWL9620Sensor::startConversion()
+{
+    startMeasure();
+    return 100;
+}
+
 void RCWL9620Sensor::begin(TwoWire *wire, uint8_t addr, uint8_t sda, uint8_t scl, uint32_t speed)
 {
     _wire = wire;
@@ -41,17 +51,28 @@ void RCWL9620Sensor::begin(TwoWire *wire, uint8_t addr, uint8_t sda, uint8_t scl
 
 float RCWL9620Sensor::getDistance()
 {
-    uint32_t data = 0;
-    uint8_t b1 = 0, b2 = 0, b3 = 0;
+    startMeasure();
+    delay(100); // délai pour laisser le capteur répondre
+    return readDistance();
+}
 
+void RCWL9620Sensor::startMeasure()
+{
     LOG_DEBUG("[RCWL9620] Start measure command");
 
     _wire->beginTransmission(_addr);
     _wire->write(0x01); // À tester aussi sans cette ligne si besoin
     uint8_t result = _wire->endTransmission();
     LOG_DEBUG("[RCWL9620] endTransmission result = %d", result);
-    delay(100); // délai pour laisser le capteur répondre
+    _measuring = true;
+}
+
+float RCWL9620Sensor::readDistance()
+{
+    uint32_t data = 0;
+    uint8_t b1 = 0, b2 = 0, b3 = 0;
 
+    _measuring = false;
     LOG_DEBUG("[RCWL9620] Read i2c data:");
     _wire->requestFrom(_addr, (uint8_t)3);
 
@@ -14,16 +14,20 @@ class RCWL9620Sensor : public TelemetrySensor
     uint8_t _scl = -1;
     uint8_t _sda = -1;
     uint32_t _speed = 200000UL;
+    bool _measuring = false; // A measure command has been sent and not read back yet
 
   protected:
     virtual void setup() override;
     void begin(TwoWire *wire = &Wire, uint8_t addr = 0x57, uint8_t sda = -1, uint8_t scl = -1, uint32_t speed = 200000UL);
     float getDistance();
+    void startMeasure();
+    float readDistance();
 
   public:
     RCWL9620Sensor();
     virtual int32_t runOnce() override;
     virtual bool getMetrics(meshtastic_Telemetry *measurement) override;
+    virtual uint32_t startConversion() override;
 };
 
 #endif
\ No newline at end of file
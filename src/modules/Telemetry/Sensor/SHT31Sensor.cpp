@@ -25,12 +25,36 @@ void SHT31Sensor::setup()
     // Set up oversampling and filter initialization
 }
 
+// Single shot, high repeatability, without clock stretching so the bus is free while it converts (15 ms at most)
+#define SHT31_MEASURE_HIGHREP 0x2400
+#define SHT31_CONVERSION_MSEC 16
+
+uint32_t SHT31Sensor::startConversion()
+{
+    return conversion.start(nodeTelemetrySensorsMap[sensorType].second, nodeTelemetrySensorsMap[sensorType].first,
+                            SHT31_MEASURE_HIGHREP, 2, SHT31_CONVERSION_MSEC);
+}
+
+uint32_t SHT31Sensor::pollConversion()
+{
+    return conversion.poll();
+}
+
 bool SHT31Sensor::getMetrics(meshtastic_Telemetry *measurement)
 {
+    float temperature, humidity;
+    uint16_t rawTemperature, rawHumidity;
+    if (conversion.take(&rawTemperature, &rawHumidity)) {
+        temperature = -45.0f + 175.0f * rawTemperature / 65535.0f;
+        humidity = 100.0f * rawHumidity / 65535.0f;
+    } else if (!sht31.readBoth(&temperature, &humidity)) { // Nothing ready, measure both in one conversion and wait for it
+        return false;
+    }
+
     measurement->variant.environment_metrics.has_temperature = true;
     measurement->variant.environment_metrics.has_relative_humidity = true;
-    measurement->variant.environment_metrics.temperature = sht31.readTemperature();
-    measurement->variant.environment_metrics.relative_humidity = sht31.readHumidity();
+    measurement->variant.environment_metrics.temperature = temperature;
+    measurement->variant.environment_metrics.relative_humidity = humidity;
 
     return true;
 }
@@ -3,6 +3,7 @@
 #if !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR && __has_include(<Adafruit_SHT31.h>)
 
 #include "../mesh/generated/meshtastic/telemetry.pb.h"
+#include "SensirionI2C.h"
 #include "TelemetrySensor.h"
 #include <Adafruit_SHT31.h>
 
@@ -10,6 +11,7 @@ class SHT31Sensor : public TelemetrySensor
 {
   private:
     Adafruit_SHT31 sht31;
+    SensirionI2C::Measurement conversion;
 
   protected:
     virtual void setup() override;
@@ -18,6 +20,8 @@ class SHT31Sensor : public TelemetrySensor
     SHT31Sensor();
     virtual int32_t runOnce() override;
     virtual bool getMetrics(meshtastic_Telemetry *measurement) override;
+    virtual uint32_t startConversion() override;
+    virtual uint32_t pollConversion() override;
 };
 
 #endif
\ No newline at end of file
@@ -37,15 +37,46 @@ void SHT4XSensor::setup()
     // Set up oversampling and filter initialization
 }
 
+// Single shot at high precision, 8.3 ms at most
+#define SHT4X_MEASURE_HIGH_PRECISION 0xFD
+#define SHT4X_CONVERSION_MSEC 9
+
+uint32_t SHT4XSensor::startConversion()
+{
+    return conversion.start(nodeTelemetrySensorsMap[sensorType].second, nodeTelemetrySensorsMap[sensorType].first,
+                            SHT4X_MEASURE_HIGH_PRECISION, 1, SHT4X_CONVERSION_MSEC);
+}
+
+uint32_t SHT4XSensor::pollConversion()
+{
+    return conversion.poll();
+}
+
 bool SHT4XSensor::getMetrics(meshtastic_Telemetry *measurement)
 {
+    float temperature, humidity;
+    uint16_t rawTemperature, rawHumidity;
+    if (conversion.take(&rawTemperature, &rawHumidity)) {
+        temperature = -45.0f + 175.0f * rawTemperature / 65535.0f;
+        humidity = -6.0f + 125.0f * rawHumidity / 65535.0f;
+        // The SHT4x formula runs a little past both ends of the range
+        if (humidity < 0)
+            humidity = 0;
+        else if (humidity > 100)
+            humidity = 100;
+    } else {
+        // Nothing ready, measure now and wait for it
+        sensors_event_t humidityEvent, tempEvent;
+        if (!sht4x.getEvent(&humidityEvent, &tempEvent))
+            return false;
+        temperature = tempEvent.temperature;
+        humidity = humidityEvent.relative_humidity;
+    }
+
     measurement->variant.environment_metrics.has_temperature = true;
     measurement->variant.environment_metrics.has_relative_humidity = true;
-
-    sensors_event_t humidity, temp;
-    sht4x.getEvent(&humidity, &temp);
-    measurement->variant.environment_metrics.temperature = temp.temperature;
-    measurement->variant.environment_metrics.relative_humidity = humidity.relative_humidity;
+    measurement->variant.environment_metrics.temperature = temperature;
+    measurement->variant.environment_metrics.relative_humidity = humidity;
     return true;
 }
 
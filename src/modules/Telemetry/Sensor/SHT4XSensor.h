@@ -3,6 +3,7 @@
 #if !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR && __has_include(<Adafruit_SHT4x.h>)
 
 #include "../mesh/generated/meshtastic/telemetry.pb.h"
+#include "SensirionI2C.h"
 #include "TelemetrySensor.h"
 #include <Adafruit_SHT4x.h>
 
@@ -10,6 +11,7 @@ class SHT4XSensor : public TelemetrySensor
 {
   private:
     Adafruit_SHT4x sht4x = Adafruit_SHT4x();
+    SensirionI2C::Measurement conversion;
 
   protected:
     virtual void setup() override;
@@ -18,6 +20,8 @@ class SHT4XSensor : public TelemetrySensor
     SHT4XSensor();
     virtual int32_t runOnce() override;
     virtual bool getMetrics(meshtastic_Telemetry *measurement) override;
+    virtual uint32_t startConversion() override;
+    virtual uint32_t pollConversion() override;
 };
 
 #endif
\ No newline at end of file
@@ -24,16 +24,56 @@ void SHTC3Sensor::setup()
     // Set up oversampling and filter initialization
 }
 
+// The SHTC3 sleeps between measurements, and takes up to 240 us to wake
+#define SHTC3_WAKEUP 0x3517
+#define SHTC3_SLEEP 0xB098
+#define SHTC3_WAKEUP_USEC 240
+// Single shot in normal mode, temperature first, without clock stretching so the bus is free while it converts (12.1 ms at
+// most)
+#define SHTC3_MEASURE_NORMAL 0x7866
+#define SHTC3_CONVERSION_MSEC 13
+
+uint32_t SHTC3Sensor::startConversion()
+{
+    TwoWire *wire = nodeTelemetrySensorsMap[sensorType].second;
+    uint8_t addr = nodeTelemetrySensorsMap[sensorType].first;
+    SensirionI2C::sendCommand(wire, addr, SHTC3_WAKEUP);
+    delayMicroseconds(SHTC3_WAKEUP_USEC);
+    uint32_t wait = conversion.start(wire, addr, SHTC3_MEASURE_NORMAL, 2, SHTC3_CONVERSION_MSEC);
+    if (!wait)
+        SensirionI2C::sendCommand(wire, addr, SHTC3_SLEEP);
+    return wait;
+}
+
+uint32_t SHTC3Sensor::pollConversion()
+{
+    uint32_t wait = conversion.poll();
+    if (!wait)
+        SensirionI2C::sendCommand(nodeTelemetrySensorsMap[sensorType].second, nodeTelemetrySensorsMap[sensorType].first,
+                                  SHTC3_SLEEP);
+    return wait;
+}
+
 bool SHTC3Sensor::getMetrics(meshtastic_Telemetry *measurement)
 {
+    float temperature, humidity;
+    uint16_t rawTemperature, rawHumidity;
+    if (conversion.take(&rawTemperature, &rawHumidity)) {
+        temperature = -45.0f + 175.0f * rawTemperature / 65536.0f;
+        humidity = 100.0f * rawHumidity / 65536.0f;
+    } else {
+        // Nothing ready, measure now and wait for it
+        sensors_event_t humidityEvent, tempEvent;
+        if (!shtc3.getEvent(&humidityEvent, &tempEvent))
+            return false;
+        temperature = tempEvent.temperature;
+        humidity = humidityEvent.relative_humidity;
+    }
+
     measurement->variant.environment_metrics.has_temperature = true;
     measurement->variant.environment_metrics.has_relative_humidity = true;
-
-    sensors_event_t humidity, temp;
-    shtc3.getEvent(&humidity, &temp);
-
-    measurement->variant.environment_metrics.temperature = temp.temperature;
-    measurement->variant.environment_metrics.relative_humidity = humidity.relative_humidity;
+    measurement->variant.environment_metrics.temperature = temperature;
+    measurement->variant.environment_metrics.relative_humidity = humidity;
 
     return true;
 }
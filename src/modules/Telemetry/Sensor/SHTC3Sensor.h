@@ -3,6 +3,7 @@
 #if !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR && __has_include(<Adafruit_SHTC3.h>)
 
 #include "../mesh/generated/meshtastic/telemetry.pb.h"
+#include "SensirionI2C.h"
 #include "TelemetrySensor.h"
 #include <Adafruit_SHTC3.h>
 
@@ -10,6 +11,7 @@ class SHTC3Sensor : public TelemetrySensor
 {
   private:
     Adafruit_SHTC3 shtc3 = Adafruit_SHTC3();
+    SensirionI2C::Measurement conversion;
 
   protected:
     virtual void setup() override;
@@ -18,6 +20,8 @@ class SHTC3Sensor : public TelemetrySensor
     SHTC3Sensor();
     virtual int32_t runOnce() override;
     virtual bool getMetrics(meshtastic_Telemetry *measurement) override;
+    virtual uint32_t startConversion() override;
+    virtual uint32_t pollConversion() override;
 };
 
 #endif
\ No newline at end of file
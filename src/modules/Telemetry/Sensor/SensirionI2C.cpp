@@ -0,0 +1,94 @@
+#include "configuration.h"
+
+#if !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR
+
+#include "SensirionI2C.h"
+#include <Wire.h>
+
+// How soon to try again when the sensor NACKs the read because it is still converting
+#define SENSIRION_RETRY_MSEC 2
+
+namespace SensirionI2C
+{
+
+uint8_t crc8(const uint8_t *data, uint8_t len)
+{
+    uint8_t crc = 0xFF;
+    for (uint8_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = crc & 0x80 ? (crc << 1) ^ 0x31 : crc << 1;
+    }
+    return crc;
+}
+
+bool decodeWords(const uint8_t *bytes, uint16_t *first, uint16_t *second)
+{
+    if (crc8(bytes, 2) != bytes[2] || crc8(bytes + 3, 2) != bytes[5])
+        return false;
+    *first = (bytes[0] << 8) | bytes[1];
+    *second = (bytes[3] << 8) | bytes[4];
+    return true;
+}
+
+bool sendCommand(TwoWire *wire, uint8_t addr, uint16_t command, uint8_t len)
+{
+    wire->beginTransmission(addr);
+    if (len == 2)
+        wire->write((uint8_t)(command >> 8));
+    wire->write((uint8_t)command);
+    return wire->endTransmission() == 0;
+}
+
+bool readWords(TwoWire *wire, uint8_t addr, uint16_t *first, uint16_t *second)
+{
+    uint8_t bytes[6];
+    if (wire->requestFrom(addr, (uint8_t)sizeof(bytes)) != sizeof(bytes))
+        return false;
+    for (uint8_t i = 0; i < sizeof(bytes); i++)
+        bytes[i] = wire->read();
+    return decodeWords(bytes, first, second);
+}
+
+uint32_t Measurement::start(TwoWire *wire, uint8_t addr, uint16_t command, uint8_t len, uint32_t conversionMsec)
+{
+    this->wire = wire;
+    this->addr = addr;
+    this->conversionMsec = conversionMsec;
+    ready = false;
+    measuring = sendCommand(wire, addr, command, len);
+    startedAtMsec = millis();
+    return measuring ? conversionMsec : 0;
+}
+
+uint32_t Measurement::poll()
+{
+    if (!measuring)
+        return 0;
+    if (readWords(wire, addr, &words[0], &words[1])) {
+        measuring = false;
+        ready = true;
+        return 0;
+    }
+    // Still converting, unless it's well overdue, in which case getMetrics() falls back to a blocking read
+    if (millis() - startedAtMsec > 4 * conversionMsec) {
+        LOG_WARN("Sensirion sensor at 0x%x didn't return a measurement", addr);
+        measuring = false;
+        return 0;
+    }
+    return SENSIRION_RETRY_MSEC;
+}
+
+bool Measurement::take(uint16_t *first, uint16_t *second)
+{
+    if (!ready)
+        return false;
+    ready = false;
+    *first = words[0];
+    *second = words[1];
+    return true;
+}
+
+} // namespace SensirionI2C
+
+#endif
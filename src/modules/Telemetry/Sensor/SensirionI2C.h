@@ -0,0 +1,70 @@
+#include "configuration.h"
+
+#if !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR
+
+#pragma once
+#include <stdint.h>
+
+#if !ARCH_PORTDUINO
+class TwoWire;
+#endif
+
+/**
+ * The bits of the Sensirion I2C protocol shared by the SHT3x, SHT4x and SHTC3, so their drivers can start a measurement and
+ * collect it later instead of waiting out the conversion like the Adafruit libraries do.
+ */
+namespace SensirionI2C
+{
+
+/// CRC-8 Sensirion sends after every 16 bit word, polynomial 0x31 starting from 0xFF
+uint8_t crc8(const uint8_t *data, uint8_t len);
+
+/**
+ * Split a 6 byte temperature and humidity result into its two words
+ * @return false if either CRC is wrong
+ */
+bool decodeWords(const uint8_t *bytes, uint16_t *first, uint16_t *second);
+
+/// Send a command which is 16 bits on the SHT3x and SHTC3 and 8 bits on the SHT4x.  @return false if the sensor didn't ACK
+bool sendCommand(TwoWire *wire, uint8_t addr, uint16_t command, uint8_t len = 2);
+
+/**
+ * Read the 6 byte result of a measurement.  These parts NACK the read while they are still converting.
+ * @return false if the result isn't ready yet or didn't pass its CRC
+ */
+bool readWords(TwoWire *wire, uint8_t addr, uint16_t *first, uint16_t *second);
+
+/**
+ * A single shot measurement in flight, for a sensor's startConversion() and pollConversion()
+ */
+class Measurement
+{
+  public:
+    /**
+     * Send the measure command
+     * @return msec until poll() is worth calling, or 0 if the sensor didn't take the command
+     */
+    uint32_t start(TwoWire *wire, uint8_t addr, uint16_t command, uint8_t len, uint32_t conversionMsec);
+
+    /**
+     * Try to collect the result
+     * @return 0 once it's in or the sensor has given up on it, otherwise msec until it's worth trying again
+     */
+    uint32_t poll();
+
+    /// Hand over the result poll() collected, once.  @return false if there isn't one
+    bool take(uint16_t *first, uint16_t *second);
+
+  private:
+    TwoWire *wire = nullptr;
+    uint8_t addr = 0;
+    bool measuring = false;
+    bool ready = false;
+    uint32_t startedAtMsec = 0;
+    uint32_t conversionMsec = 0;
+    uint16_t words[2];
+};
+
+} // namespace SensirionI2C
+
+#endif
@@ -0,0 +1,191 @@
+#include "configuration.h"
+
+#if !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR
+
+#include "TelemetrySampler.h"
+#include <algorithm>
+
+// Copy a field if the sensor set it, so later sensors override earlier ones field by field, as when they all wrote into one
+// message
+#define MERGE(metrics, field)                                                                                                    \
+    if (reading.variant.metrics.has_##field) {                                                                                   \
+        m->variant.metrics.has_##field = true;                                                                                   \
+        m->variant.metrics.field = reading.variant.metrics.field;                                                                \
+    }
+
+TelemetrySampler::TelemetrySampler(const char *name, pb_size_t variant, uint32_t sampleIntervalMs)
+    : concurrency::OSThread(name), variant(variant), sampleIntervalMs(sampleIntervalMs)
+{
+}
+
+bool TelemetrySampler::getMetrics(TelemetrySensor *sensor, meshtastic_Telemetry *m)
+{
+    Slot *slot = nullptr;
+    for (auto &s : slots) {
+        if (s.sensor == sensor) {
+            slot = &s;
+            break;
+        }
+    }
+    if (slot && !slot->idle) {
+        slot->requestedAtMsec = millis();
+        if (slot->valid)
+            merge(slot->reading, m);
+        return slot->valid;
+    }
+
+    // First time we've been asked for this one, or nobody wanted it lately, so there is nothing fresh cached
+    if (!slot) {
+        slots.push_back(Slot{sensor});
+        slot = &slots.back();
+    }
+    slot->idle = false;
+    slot->requestedAtMsec = millis();
+    read(*slot);
+    if (slot->valid)
+        merge(slot->reading, m);
+    setIntervalFromNow(0);
+    return slot->valid;
+}
+
+void TelemetrySampler::read(Slot &slot)
+{
+    slot.reading = meshtastic_Telemetry_init_zero;
+    slot.reading.which_variant = variant;
+    slot.valid = slot.sensor->getMetrics(&slot.reading);
+    slot.converting = false;
+    slot.nextAtMsec = millis() + (slot.valid ? sampleIntervalMs : RETRY_MSEC);
+}
+
+int32_t TelemetrySampler::runOnce()
+{
+    uint32_t now = millis();
+    Slot *toRead = nullptr;
+
+    // Get every due conversion going first, so they run in parallel
+    for (auto &slot : slots) {
+        if (slot.idle || (int32_t)(now - slot.nextAtMsec) < 0)
+            continue;
+
+        if (!slot.converting) {
+            if (now - slot.requestedAtMsec > sampleIntervalMs) {
+                // Nobody has wanted this reading lately, stop sampling until they do
+                slot.idle = true;
+                continue;
+            }
+            slot.converting = true;
+            slot.nextAtMsec = now + slot.sensor->startConversion();
+        } else {
+            slot.nextAtMsec = now + slot.sensor->pollConversion();
+        }
+    }
+
+    // Then read at most one, the others get their turn on the next call
+    bool moreReady = false;
+    for (auto &slot : slots) {
+        if (slot.converting && (int32_t)(now - slot.nextAtMsec) >= 0) {
+            if (toRead) {
+                moreReady = true;
+                break;
+            }
+            toRead = &slot;
+        }
+    }
+    if (toRead)
+        read(*toRead);
+    if (moreReady)
+        return 0; // Come straight back for the others
+
+    int32_t delay = sampleIntervalMs;
+    for (auto &slot : slots) {
+        if (!slot.idle)
+            delay = std::min(delay, std::max((int32_t)(slot.nextAtMsec - now), (int32_t)0));
+    }
+    return delay;
+}
+
+void TelemetrySampler::merge(const meshtastic_Telemetry &reading, meshtastic_Telemetry *m)
+{
+    switch (variant) {
+    case meshtastic_Telemetry_environment_metrics_tag:
+        MERGE(environment_metrics, temperature);
+        MERGE(environment_metrics, relative_humidity);
+        MERGE(environment_metrics, barometric_pressure);
+        MERGE(environment_metrics, gas_resistance);
+        MERGE(environment_metrics, voltage);
+        MERGE(environment_metrics, current);
+        MERGE(environment_metrics, iaq);
+        MERGE(environment_metrics, distance);
+        MERGE(environment_metrics, lux);
+        MERGE(environment_metrics, white_lux);
+        MERGE(environment_metrics, ir_lux);
+        MERGE(environment_metrics, uv_lux);
+        MERGE(environment_metrics, wind_direction);
+        MERGE(environment_metrics, wind_speed);
+        MERGE(environment_metrics, weight);
+        MERGE(environment_metrics, wind_gust);
+        MERGE(environment_metrics, wind_lull);
+        MERGE(environment_metrics, radiation);
+        MERGE(environment_metrics, rainfall_1h);
+        MERGE(environment_metrics, rainfall_24h);
+        MERGE(environment_metrics, soil_moisture);
+        MERGE(environment_metrics, soil_temperature);
+        break;
+    case meshtastic_Telemetry_power_metrics_tag:
+        MERGE(power_metrics, ch1_voltage);
+        MERGE(power_metrics, ch1_current);
+        MERGE(power_metrics, ch2_voltage);
+        MERGE(power_metrics, ch2_current);
+        MERGE(power_metrics, ch3_voltage);
+        MERGE(power_metrics, ch3_current);
+        MERGE(power_metrics, ch4_voltage);
+        MERGE(power_metrics, ch4_current);
+        MERGE(power_metrics, ch5_voltage);
+        MERGE(power_metrics, ch5_current);
+        MERGE(power_metrics, ch6_voltage);
+        MERGE(power_metrics, ch6_current);
+        MERGE(power_metrics, ch7_voltage);
+        MERGE(power_metrics, ch7_current);
+        MERGE(power_metrics, ch8_voltage);
+        MERGE(power_metrics, ch8_current);
+        break;
+    case meshtastic_Telemetry_health_metrics_tag:
+        MERGE(health_metrics, heart_bpm);
+        MERGE(health_metrics, spO2);
+        MERGE(health_metrics, temperature);
+        break;
+    case meshtastic_Telemetry_air_quality_metrics_tag:
+        MERGE(air_quality_metrics, pm10_standard);
+        MERGE(air_quality_metrics, pm25_standard);
+        MERGE(air_quality_metrics, pm100_standard);
+        MERGE(air_quality_metrics, pm10_environmental);
+        MERGE(air_quality_metrics, pm25_environmental);
+        MERGE(air_quality_metrics, pm100_environmental);
+        MERGE(air_quality_metrics, particles_03um);
+        MERGE(air_quality_metrics, particles_05um);
+        MERGE(air_quality_metrics, particles_10um);
+        MERGE(air_quality_metrics, particles_25um);
+        MERGE(air_quality_metrics, particles_50um);
+        MERGE(air_quality_metrics, particles_100um);
+        MERGE(air_quality_metrics, co2);
+        MERGE(air_quality_metrics, co2_temperature);
+        MERGE(air_quality_metrics, co2_humidity);
+        MERGE(air_quality_metrics, form_formaldehyde);
+        MERGE(air_quality_metrics, form_humidity);
+        MERGE(air_quality_metrics, form_temperature);
+        MERGE(air_quality_metrics, pm40_standard);
+        MERGE(air_quality_metrics, particles_40um);
+        MERGE(air_quality_metrics, pm_temperature);
+        MERGE(air_quality_metrics, pm_humidity);
+        MERGE(air_quality_metrics, pm_voc_idx);
+        MERGE(air_quality_metrics, pm_nox_idx);
+        MERGE(air_quality_metrics, particles_tps);
+        break;
+    default:
+        // Not something sensors fill in piecemeal, take it whole
+        m->variant = reading.variant;
+        break;
+    }
+}
+
+#endif
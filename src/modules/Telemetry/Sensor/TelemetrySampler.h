@@ -0,0 +1,59 @@
+#include "configuration.h"
+
+#if !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR
+
+#pragma once
+#include "../mesh/generated/meshtastic/telemetry.pb.h"
+#include "TelemetrySensor.h"
+#include "concurrency/OSThread.h"
+#include <vector>
+
+/**
+ * Samples a telemetry module's sensors in the background and caches their latest readings.
+ *
+ * Conversions are started on every due sensor at once, so their delays overlap, and each sensor is read in its own
+ * runOnce() so the main loop gets a turn in between.  The module then builds its packets from the cache with getMetrics(),
+ * without touching the bus.  Sensors nobody has asked for within the last interval are left idle, and read again on demand.
+ */
+class TelemetrySampler : private concurrency::OSThread
+{
+  public:
+    /**
+     * @param variant the meshtastic_Telemetry variant tag the module sends, readings are merged as that variant
+     * @param sampleIntervalMs how often to refresh each sensor's reading
+     */
+    TelemetrySampler(const char *name, pb_size_t variant, uint32_t sampleIntervalMs);
+
+    /**
+     * Merge the latest reading of sensor into m, like calling sensor->getMetrics(m) would.
+     * Sensors are added the first time they are asked for, or after going idle, and read there and then.
+     * @return false if the last read of sensor failed
+     */
+    bool getMetrics(TelemetrySensor *sensor, meshtastic_Telemetry *m);
+
+  protected:
+    virtual int32_t runOnce() override;
+
+  private:
+    // How long to wait before trying a sensor again after it fails to read
+    static constexpr uint32_t RETRY_MSEC = 5 * 1000;
+
+    struct Slot {
+        TelemetrySensor *sensor;
+        meshtastic_Telemetry reading;
+        uint32_t nextAtMsec;      // When we next need to do something with this sensor
+        uint32_t requestedAtMsec; // When getMetrics() last asked for this sensor
+        bool converting;          // startConversion() has been called, waiting to read
+        bool valid;               // The last read succeeded
+        bool idle;                // Not asked for lately, so not being sampled
+    };
+
+    pb_size_t variant;
+    uint32_t sampleIntervalMs;
+    std::vector<Slot> slots;
+
+    void read(Slot &slot);
+    void merge(const meshtastic_Telemetry &reading, meshtastic_Telemetry *m);
+};
+
+#endif
@@ -58,6 +58,18 @@ class TelemetrySensor
     virtual bool isRunning() { return status > 0; }
 
     virtual bool getMetrics(meshtastic_Telemetry *measurement) = 0;
+
+    /**
+     * Kick off a measurement without waiting for it, for sensors which need time between being triggered and being read.
+     * @return msec until pollConversion() is worth calling, or 0 if getMetrics() can be called straight away
+     */
+    virtual uint32_t startConversion() { return 0; }
+
+    /**
+     * Check on a measurement started by startConversion()
+     * @return 0 if getMetrics() can now be called without blocking, otherwise msec until it's worth checking again
+     */
+    virtual uint32_t pollConversion() { return 0; }
 };
 
 #endif
\ No newline at end of file
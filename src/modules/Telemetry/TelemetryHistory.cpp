@@ -0,0 +1,246 @@
+#include "TelemetryHistory.h"
+#include "MeshService.h"
+#include "NodeDB.h"
+#include "Router.h"
+#include "mesh-pb-constants.h"
+#include "main.h"
+#include <math.h>
+
+TelemetryHistory *telemetryHistory;
+
+// How many packets to hand the phone queue at once during a replay, and how long to let it drain between batches
+#define REPLAY_BATCH 8
+#define REPLAY_POLL_MSEC 100
+
+namespace
+{
+enum : uint8_t {
+#define SERIES_ENUM(metrics, field, resolution) SERIES_##metrics##_##field,
+    TELEMETRY_HISTORY_SERIES(SERIES_ENUM)
+#undef SERIES_ENUM
+    NUM_SERIES
+};
+
+const pb_size_t seriesVariant[NUM_SERIES] = {
+#define SERIES_VARIANT(metrics, field, resolution) meshtastic_Telemetry_##metrics##_tag,
+    TELEMETRY_HISTORY_SERIES(SERIES_VARIANT)
+#undef SERIES_VARIANT
+};
+
+size_t putVarint(uint8_t *buf, uint32_t v)
+{
+    size_t len = 0;
+    while (v >= 0x80) {
+        buf[len++] = (v & 0x7f) | 0x80;
+        v >>= 7;
+    }
+    buf[len++] = v;
+    return len;
+}
+
+bool getVarint(const uint8_t *buf, size_t len, size_t &pos, uint32_t &v)
+{
+    v = 0;
+    for (int shift = 0; pos < len && shift < 32; shift += 7) {
+        uint8_t b = buf[pos++];
+        v |= (uint32_t)(b & 0x7f) << shift;
+        if (!(b & 0x80))
+            return true;
+    }
+    return false;
+}
+
+// Deltas are done in uint32_t so they wrap rather than overflow, and zigzag encoded so small changes either way stay short
+uint32_t zigzag(uint32_t delta)
+{
+    return (delta << 1) ^ (uint32_t)((int32_t)delta >> 31);
+}
+
+uint32_t unzigzag(uint32_t v)
+{
+    return (v >> 1) ^ (uint32_t)-(int32_t)(v & 1);
+}
+
+void setMetric(meshtastic_Telemetry &t, uint8_t series, int32_t value)
+{
+    switch (series) {
+#define SET_METRIC(metrics, field, resolution)                                                                                   \
+    case SERIES_##metrics##_##field:                                                                                             \
+        t.variant.metrics.has_##field = true;                                                                                    \
+        t.variant.metrics.field = value * (resolution);                                                                          \
+        break;
+        TELEMETRY_HISTORY_SERIES(SET_METRIC)
+#undef SET_METRIC
+    }
+}
+} // namespace
+
+TelemetryHistory::TelemetryHistory() : concurrency::OSThread("TelemetryHistory")
+{
+    LOG_DEBUG("Telemetry history: %u chunks of %u bytes", (unsigned)NUM_CHUNKS, (unsigned)sizeof(Chunk));
+    disable();
+}
+
+void TelemetryHistory::record(const meshtastic_Telemetry &t)
+{
+    if (!t.time)
+        return;
+
+#define RECORD_METRIC(metrics, field, resolution)                                                                                \
+    if (t.which_variant == meshtastic_Telemetry_##metrics##_tag && t.variant.metrics.has_##field)                                \
+        append(SERIES_##metrics##_##field, t.time, lroundf(t.variant.metrics.field / (resolution)));
+    TELEMETRY_HISTORY_SERIES(RECORD_METRIC)
+#undef RECORD_METRIC
+}
+
+void TelemetryHistory::forEachMetric(const meshtastic_Telemetry &t, const std::function<void(const char *name, float value)> &fn)
+{
+#define VISIT_METRIC(metrics, field, resolution)                                                                                 \
+    if (t.which_variant == meshtastic_Telemetry_##metrics##_tag && t.variant.metrics.has_##field)                                \
+        fn(#field, t.variant.metrics.field);
+    TELEMETRY_HISTORY_SERIES(VISIT_METRIC)
+#undef VISIT_METRIC
+}
+
+void TelemetryHistory::append(uint8_t series, uint32_t time, int32_t value)
+{
+    Chunk *chunk = openChunk(series);
+    uint8_t entry[10];
+    size_t len;
+
+    if (chunk && time >= chunk->lastTime) {
+        if (time - chunk->lastTime < TELEMETRY_HISTORY_INTERVAL_SECS)
+            return; // Downsample
+
+        len = putVarint(entry, time - chunk->lastTime);
+        len += putVarint(entry + len, zigzag((uint32_t)value - (uint32_t)chunk->lastValue));
+        if (chunk->len + len > sizeof(chunk->data))
+            chunk = NULL;
+    } else {
+        // Nothing recorded yet, or the clock went backwards
+        chunk = NULL;
+    }
+
+    if (!chunk) {
+        chunk = allocChunk(series, time);
+        len = putVarint(entry, 0);
+        len += putVarint(entry + len, zigzag((uint32_t)value));
+    }
+
+    memcpy(chunk->data + chunk->len, entry, len);
+    chunk->len += len;
+    chunk->lastTime = time;
+    chunk->lastValue = value;
+}
+
+TelemetryHistory::Chunk *TelemetryHistory::openChunk(uint8_t series)
+{
+    Chunk *newest = NULL;
+    for (auto &c : chunks)
+        if (c.seq && c.series == series && (!newest || c.seq > newest->seq))
+            newest = &c;
+    return newest;
+}
+
+TelemetryHistory::Chunk *TelemetryHistory::allocChunk(uint8_t series, uint32_t time)
+{
+    // Use a free chunk if there is one, otherwise drop the oldest
+    Chunk *chunk = &chunks[0];
+    for (auto &c : chunks) {
+        if (!c.seq) {
+            chunk = &c;
+            break;
+        }
+        if (c.seq < chunk->seq)
+            chunk = &c;
+    }
+
+    chunk->seq = nextSeq++;
+    chunk->series = series;
+    chunk->startTime = time;
+    chunk->lastTime = time;
+    chunk->lastValue = 0;
+    chunk->len = 0;
+    return chunk;
+}
+
+bool TelemetryHistory::next(pb_size_t variant, uint32_t after, meshtastic_Telemetry &out) const
+{
+    uint32_t best = UINT32_MAX;
+    bool found = false;
+
+    for (const auto &c : chunks) {
+        if (!c.seq || seriesVariant[c.series] != variant || c.lastTime <= after || c.startTime > best)
+            continue;
+
+        // Samples within a chunk are in time order, so the first one after the cursor is the only candidate
+        uint32_t time = c.startTime, value = 0, dt, dv;
+        size_t pos = 0;
+        while (getVarint(c.data, c.len, pos, dt) && getVarint(c.data, c.len, pos, dv)) {
+            time += dt;
+            value += unzigzag(dv);
+            if (time <= after)
+                continue;
+            if (time < best || !found) {
+                memset(&out, 0, sizeof(out));
+                out.which_variant = variant;
+                best = time;
+                found = true;
+            }
+            if (time == best)
+                setMetric(out, c.series, (int32_t)value);
+            break;
+        }
+    }
+
+    out.time = best;
+    return found;
+}
+
+void TelemetryHistory::replayToPhone(pb_size_t variant, uint32_t since)
+{
+    LOG_INFO("Replay telemetry history to phone, variant %u since %u", variant, since);
+    replayVariant = variant;
+    replayAfter = since ? since - 1 : 0;
+    enabled = true;
+    setIntervalFromNow(0);
+}
+
+bool TelemetryHistory::replayIfRequested(const meshtastic_MeshPacket &req, const meshtastic_Telemetry &request)
+{
+#if TELEMETRY_HISTORY_PHONE_REPLAY
+    if (request.time && isFromUs(&req)) {
+        replayToPhone(request.which_variant, request.time);
+        return true;
+    }
+#endif
+    return false;
+}
+
+int32_t TelemetryHistory::runOnce()
+{
+    if (!replayVariant)
+        return disable();
+
+    // Only top up the phone queue once it has drained, so live traffic isn't pushed out
+    if (!service->isToPhoneQueueEmpty())
+        return REPLAY_POLL_MSEC;
+
+    meshtastic_Telemetry t;
+    for (int i = 0; i < REPLAY_BATCH; i++) {
+        if (!next(replayVariant, replayAfter, t)) {
+            LOG_INFO("Telemetry history replay done");
+            replayVariant = 0;
+            return disable();
+        }
+        replayAfter = t.time;
+
+        meshtastic_MeshPacket *p = router->allocForSending();
+        p->decoded.portnum = meshtastic_PortNum_TELEMETRY_APP;
+        p->decoded.payload.size =
+            pb_encode_to_bytes(p->decoded.payload.bytes, sizeof(p->decoded.payload.bytes), &meshtastic_Telemetry_msg, &t);
+        p->priority = meshtastic_MeshPacket_Priority_BACKGROUND;
+        service->sendToPhone(p);
+    }
+    return REPLAY_POLL_MSEC;
+}
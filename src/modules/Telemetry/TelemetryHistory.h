@@ -0,0 +1,124 @@
+#pragma once
+
+#include "../mesh/generated/meshtastic/mesh.pb.h"
+#include "../mesh/generated/meshtastic/telemetry.pb.h"
+#include "concurrency/OSThread.h"
+#include "configuration.h"
+#include <functional>
+
+// Bytes of RAM given to the history
+#ifndef TELEMETRY_HISTORY_SIZE
+#if defined(ARCH_ESP32) || defined(ARCH_PORTDUINO)
+#define TELEMETRY_HISTORY_SIZE 8192
+#else
+#define TELEMETRY_HISTORY_SIZE 2048
+#endif
+#endif
+
+// Keep at most one sample of each metric per this many seconds
+#ifndef TELEMETRY_HISTORY_INTERVAL_SECS
+#define TELEMETRY_HISTORY_INTERVAL_SECS (5 * 60)
+#endif
+
+// Set to 1 to let our own phone fetch the history with a telemetry request which has Telemetry.time set to the earliest sample
+// it wants.  Off by default: time means nothing in a request today, so a client which happens to fill it in would get a stream
+// of old samples instead of the current reading.  This is only a stopgap until the protobufs have an explicit history request;
+// /json/telemetry?since= needs no flag.
+#ifndef TELEMETRY_HISTORY_PHONE_REPLAY
+#define TELEMETRY_HISTORY_PHONE_REPLAY 0
+#endif
+
+#define TELEMETRY_HISTORY_CHUNK_DATA 48
+
+/**
+ * The metrics we keep history for, with the resolution each one is stored at
+ */
+#define TELEMETRY_HISTORY_SERIES(X)                                                                                              \
+    X(device_metrics, battery_level, 1)                                                                                          \
+    X(device_metrics, voltage, 0.001f)                                                                                           \
+    X(device_metrics, channel_utilization, 0.01f)                                                                                \
+    X(device_metrics, air_util_tx, 0.01f)                                                                                        \
+    X(environment_metrics, temperature, 0.01f)                                                                                   \
+    X(environment_metrics, relative_humidity, 0.01f)                                                                             \
+    X(environment_metrics, barometric_pressure, 0.01f)                                                                           \
+    X(environment_metrics, gas_resistance, 0.001f)                                                                               \
+    X(environment_metrics, iaq, 1)                                                                                               \
+    X(environment_metrics, voltage, 0.001f)                                                                                      \
+    X(environment_metrics, current, 0.1f)                                                                                        \
+    X(environment_metrics, lux, 0.1f)                                                                                            \
+    X(environment_metrics, distance, 1)                                                                                          \
+    X(environment_metrics, wind_speed, 0.01f)                                                                                    \
+    X(environment_metrics, wind_direction, 1)                                                                                    \
+    X(environment_metrics, weight, 0.001f)                                                                                       \
+    X(environment_metrics, radiation, 0.01f)                                                                                     \
+    X(environment_metrics, soil_moisture, 1)                                                                                     \
+    X(environment_metrics, soil_temperature, 0.01f)                                                                              \
+    X(power_metrics, ch1_voltage, 0.001f)                                                                                        \
+    X(power_metrics, ch1_current, 0.1f)                                                                                          \
+    X(power_metrics, ch2_voltage, 0.001f)                                                                                        \
+    X(power_metrics, ch2_current, 0.1f)                                                                                          \
+    X(power_metrics, ch3_voltage, 0.001f)                                                                                        \
+    X(power_metrics, ch3_current, 0.1f)
+
+/**
+ * A compact record of our own telemetry, so the phone can catch up on what it missed while it was away.
+ *
+ * Each metric is quantized to its resolution and stored as a series of (seconds since last sample, change since last sample)
+ * varint pairs, in small chunks shared by all the metrics.  When the chunks run out the oldest one is reused, so the history
+ * always covers as far back as memory allows.  Readings that change slowly take about three bytes a sample.
+ */
+class TelemetryHistory : private concurrency::OSThread
+{
+  public:
+    TelemetryHistory();
+
+    /** Add the metrics in t at t.time, which must be a valid wall clock time */
+    void record(const meshtastic_Telemetry &t);
+
+    /**
+     * Find the earliest samples of variant recorded after the time after
+     * @param out set to those samples, with out.time their timestamp
+     * @return false if there are none
+     */
+    bool next(pb_size_t variant, uint32_t after, meshtastic_Telemetry &out) const;
+
+    /** Call fn with the name and value of every metric we keep which is set in t */
+    static void forEachMetric(const meshtastic_Telemetry &t, const std::function<void(const char *name, float value)> &fn);
+
+    /** Send every sample of variant taken since the time since to the phone, as telemetry packets paced to the phone queue */
+    void replayToPhone(pb_size_t variant, uint32_t since);
+
+    /**
+     * Start a replay if request is our phone asking for history, which needs TELEMETRY_HISTORY_PHONE_REPLAY
+     * @return true if it was, and so needs no other reply
+     */
+    bool replayIfRequested(const meshtastic_MeshPacket &req, const meshtastic_Telemetry &request);
+
+  protected:
+    virtual int32_t runOnce() override;
+
+  private:
+    struct Chunk {
+        uint32_t seq;       // Allocation order, 0 if the chunk is free
+        uint32_t startTime; // Samples are encoded starting from this time and a value of 0
+        uint32_t lastTime;  // The last sample, which the next one is encoded against
+        int32_t lastValue;
+        uint8_t series;
+        uint8_t len; // Bytes of data used
+        uint8_t data[TELEMETRY_HISTORY_CHUNK_DATA];
+    };
+
+    static constexpr size_t NUM_CHUNKS = TELEMETRY_HISTORY_SIZE / sizeof(Chunk);
+
+    Chunk chunks[NUM_CHUNKS] = {};
+    uint32_t nextSeq = 1;
+
+    pb_size_t replayVariant = 0; // 0 if not replaying
+    uint32_t replayAfter = 0;
+
+    void append(uint8_t series, uint32_t time, int32_t value);
+    Chunk *openChunk(uint8_t series);
+    Chunk *allocChunk(uint8_t series, uint32_t time);
+};
+
+extern TelemetryHistory *telemetryHistory;
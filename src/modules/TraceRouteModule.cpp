@@ -177,6 +177,8 @@ void TraceRouteModule::insertUnknownHops(meshtastic_MeshPacket &p, meshtastic_Ro
     if (p.hop_start != 0 && p.hop_limit <= p.hop_start) {
         uint8_t hopsTaken = p.hop_start - p.hop_limit;
         int8_t diff = hopsTaken - *route_count;
+        // Unknown hops stay NODENUM_BROADCAST.  Their relay byte is shared by every node ending in it, so it only names a node
+        // for certain when the frame came straight from its sender, and then no hop is missing.
         for (uint8_t i = 0; i < diff; i++) {
             if (*route_count < ROUTE_SIZE) {
                 route[*route_count] = NODENUM_BROADCAST; // This will represent an unknown hop
@@ -46,10 +46,11 @@ class TraceRouteModule : public ProtobufModule<meshtastic_RouteDiscovery>,
 
     virtual int32_t runOnce() override;
 
-  private:
+  protected:
     // Call to add unknown hops (e.g. when a node couldn't decrypt it) to the route based on hopStart and current hopLimit
     void insertUnknownHops(meshtastic_MeshPacket &p, meshtastic_RouteDiscovery *r, bool isTowardsDestination);
 
+  private:
     // Call to add your ID to the route array of a RouteDiscovery message
     void appendMyIDandSNR(meshtastic_RouteDiscovery *r, float snr, bool isTowardsDestination, bool SNRonly);
 
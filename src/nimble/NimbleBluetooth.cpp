@@ -3,8 +3,10 @@
 #include "BluetoothCommon.h"
 #include "NimbleBluetooth.h"
 #include "PowerFSM.h"
+#include "concurrency/BinarySemaphoreFreeRTOS.h"
 
 #include "main.h"
+#include "mesh/MeshService.h"
 #include "mesh/PhoneAPI.h"
 #include "mesh/mesh-pb-constants.h"
 #include "sleep.h"
@@ -18,35 +20,154 @@ NimBLEServer *bleServer;
 
 static bool passkeyShowing;
 
+// How many encoded FromRadio frames the main loop keeps ready for the phone to read, enough to fill a batched read of typical
+// NodeInfos at the largest MTU
+#define FROMRADIO_PREFETCH_DEPTH 6
+// How many ToRadio writes can wait for the main loop before we make the phone wait too
+#define TORADIO_QUEUE_DEPTH 6
+// Longest we hold up a ToRadio write (and so the NimBLE host task) waiting for queue space.  The write is already accepted by
+// then, so after this we queue it past TORADIO_QUEUE_DEPTH rather than lose it.
+#define TORADIO_BACKPRESSURE_MSEC 500
+
 class BluetoothPhoneAPI : public PhoneAPI, public concurrency::OSThread
 {
   public:
-    BluetoothPhoneAPI() : concurrency::OSThread("NimbleBluetooth") { nimble_queue.resize(3); }
+    BluetoothPhoneAPI() : concurrency::OSThread("NimbleBluetooth")
+    {
+        nimble_queue.reserve(TORADIO_QUEUE_DEPTH);
+        toRadioPending.reserve(TORADIO_QUEUE_DEPTH);
+    }
     std::vector<NimBLEAttValue> nimble_queue;
     std::mutex nimble_mutex;
-    uint8_t queue_size = 0;
-    bool has_fromRadio = false;
-    uint8_t fromRadioBytes[meshtastic_FromRadio_size] = {0};
-    size_t numBytes = 0;
-    bool hasChecked = false;
-    bool phoneWants = false;
+    concurrency::BinarySemaphoreFreeRTOS queueSpace; // Given whenever runOnce takes the writes out of nimble_queue
+
+    NimbleBluetoothStats stats;
+
+    /**
+     * Take the oldest prefetched frame, called from the NimBLE host task.
+     * @return false if the main loop hasn't got one ready
+     */
+    bool popFromRadio(NimBLECharacteristic *characteristic)
+    {
+        std::lock_guard<std::mutex> guard(nimble_mutex);
+        if (fromRadioCount == 0 || linkWasReset) {
+            // The phone will stop reading until we notify fromNum, so do that as soon as we have something again
+            readWentEmpty = true;
+            stats.fromRadioEmptyReads++;
+            characteristic->setValue(std::string());
+            return false;
+        }
+
+        FromRadioFrame &frame = fromRadioRing[fromRadioHead];
+        characteristic->setValue(frame.bytes, frame.length);
+        stats.fromRadioFrames++;
+        stats.fromRadioBytes += frame.length;
+        fromRadioHead = (fromRadioHead + 1) % FROMRADIO_PREFETCH_DEPTH;
+        fromRadioCount--;
+        return true;
+    }
+
+    /**
+     * Like popFromRadio, but for the batched characteristic: as many frames as fit in maxLen, each after its length.
+     * @return false if the main loop hasn't got any ready
+     */
+    bool popFromRadioBatch(NimBLECharacteristic *characteristic, size_t maxLen)
+    {
+        std::lock_guard<std::mutex> guard(nimble_mutex);
+        size_t batchLen = 0;
+        uint8_t frames = 0;
+        while (fromRadioCount > 0 && !linkWasReset) {
+            FromRadioFrame &frame = fromRadioRing[fromRadioHead];
+            // The first frame always goes, if it is bigger than the MTU the phone gets the rest with a long read
+            if (!appendFromRadioBatch(batchBytes, batchLen, frames ? maxLen : sizeof(batchBytes), frame.bytes, frame.length))
+                break;
+            stats.fromRadioFrames++;
+            stats.fromRadioBytes += frame.length;
+            fromRadioHead = (fromRadioHead + 1) % FROMRADIO_PREFETCH_DEPTH;
+            fromRadioCount--;
+            frames++;
+        }
+
+        characteristic->setValue(batchBytes, batchLen);
+        if (frames == 0) {
+            readWentEmpty = true;
+            stats.fromRadioEmptyReads++;
+            return false;
+        }
+        stats.fromRadioBatches++;
+        return true;
+    }
+
+    /**
+     * Forget any queued writes, the phone has gone.  The main loop closes the PhoneAPI and hands prefetched packets back to
+     * the phone queue, call with nimble_mutex held.
+     */
+    void resetLink()
+    {
+        linkWasReset = true;
+        readWentEmpty = false;
+        nimble_queue.clear();
+        queueSpace.give();
+        setIntervalFromNow(0);
+    }
 
   protected:
     virtual int32_t runOnce() override
     {
-        std::lock_guard<std::mutex> guard(nimble_mutex);
-        if (queue_size > 0) {
-            for (uint8_t i = 0; i < queue_size; i++) {
-                handleToRadio(nimble_queue.at(i).data(), nimble_queue.at(i).length());
+        // Only swap the queues and take snapshots under the lock, so the NimBLE host task never waits on handleToRadio or
+        // the protobuf encoding
+        bool reset;
+        uint8_t head, count;
+        {
+            std::lock_guard<std::mutex> guard(nimble_mutex);
+            toRadioPending.swap(nimble_queue);
+            reset = linkWasReset;
+            head = fromRadioHead;
+            count = fromRadioCount;
+        }
+
+        // Close before handling writes, resetLink already threw away the old phone's so these are from the next one
+        if (reset) {
+            // Nobody pops while linkWasReset is set, so the ring is ours until we clear it
+            close();
+            returnFromRadioRing(head, count);
+            head = count = 0;
+            std::lock_guard<std::mutex> guard(nimble_mutex);
+            fromRadioHead = fromRadioCount = 0;
+            linkWasReset = false;
+        }
+
+        if (!toRadioPending.empty()) {
+            queueSpace.give();
+            for (const NimBLEAttValue &val : toRadioPending) {
+                handleToRadio(val.data(), val.length());
             }
-            LOG_DEBUG("Queue_size %u", queue_size);
-            queue_size = 0;
+            LOG_DEBUG("Queue_size %u", (unsigned)toRadioPending.size());
+            toRadioPending.clear();
+        }
+
+        // Stay ahead of the phone, so onRead never has to wait for us.  The phone only pops from the frames in count, so the
+        // slots after them are ours to fill.
+        uint8_t added = 0;
+        while (count + added < FROMRADIO_PREFETCH_DEPTH) {
+            FromRadioFrame &frame = fromRadioRing[(head + count + added) % FROMRADIO_PREFETCH_DEPTH];
+            frame.length = getFromRadio(frame.bytes);
+            if (frame.length == 0)
+                break;
+            added++;
         }
-        if (hasChecked == false && phoneWants == true) {
-            numBytes = getFromRadio(fromRadioBytes);
-            hasChecked = true;
+
+        bool notifyPhone = false;
+        if (added > 0) {
+            std::lock_guard<std::mutex> guard(nimble_mutex);
+            fromRadioCount += added;
+            notifyPhone = readWentEmpty;
+            readWentEmpty = false;
         }
 
+        if (notifyPhone)
+            notifyFromNum(++prefetchNum);
+
         return 100;
     }
     /**
@@ -57,16 +178,57 @@ class BluetoothPhoneAPI : public PhoneAPI, public concurrency::OSThread
         PhoneAPI::onNowHasData(fromRadioNum);
 
         LOG_DEBUG("BLE notify fromNum");
+        prefetchNum = fromRadioNum;
+        notifyFromNum(fromRadioNum);
+        // Get it encoded before the phone comes to read it
+        setIntervalFromNow(0);
+    }
 
+    /// Check the current underlying physical link to see if the client is currently connected
+    virtual bool checkIsConnected() { return bleServer && bleServer->getConnectedCount() > 0; }
+
+  private:
+    struct FromRadioFrame {
+        uint8_t bytes[meshtastic_FromRadio_size];
+        size_t length;
+    };
+
+    FromRadioFrame fromRadioRing[FROMRADIO_PREFETCH_DEPTH];
+    uint8_t fromRadioHead = 0, fromRadioCount = 0;
+    uint8_t batchBytes[FROMRADIO_BATCH_MAX_LEN];
+    bool readWentEmpty = false;
+    bool linkWasReset = false; // The phone went away, the main loop still has to close() and empty fromRadioRing
+    uint32_t prefetchNum = 0;  // Last value we notified on fromNum
+    // Writes runOnce took out of nimble_queue, only touched by the main loop
+    std::vector<NimBLEAttValue> toRadioPending;
+
+    /// Put the mesh packets in fromRadioRing back in the phone queue for the next phone, the rest is sent again on connect
+    void returnFromRadioRing(uint8_t head, uint8_t count)
+    {
+        meshtastic_MeshPacket *packets[FROMRADIO_PREFETCH_DEPTH];
+        size_t numPackets = 0;
+        for (; count > 0; count--) {
+            FromRadioFrame &frame = fromRadioRing[head];
+            head = (head + 1) % FROMRADIO_PREFETCH_DEPTH;
+            meshtastic_FromRadio fromRadio = meshtastic_FromRadio_init_zero;
+            if (pb_decode_from_bytes(frame.bytes, frame.length, &meshtastic_FromRadio_msg, &fromRadio) &&
+                fromRadio.which_payload_variant == meshtastic_FromRadio_packet_tag)
+                packets[numPackets++] = packetPool.allocCopy(fromRadio.packet);
+        }
+        if (numPackets > 0) {
+            LOG_INFO("Return %u unread packets to the phone queue", numPackets);
+            service->returnToPhone(packets, numPackets);
+        }
+    }
+
+    void notifyFromNum(uint32_t num)
+    {
         uint8_t val[4];
-        put_le32(val, fromRadioNum);
+        put_le32(val, num);
 
         fromNumCharacteristic->setValue(val, sizeof(val));
         fromNumCharacteristic->notify();
     }
-
-    /// Check the current underlying physical link to see if the client is currently connected
-    virtual bool checkIsConnected() { return bleServer && bleServer->getConnectedCount() > 0; }
 };
 
 static BluetoothPhoneAPI *bluetoothPhoneAPI;
@@ -83,14 +245,40 @@ class NimbleBluetoothToRadioCallback : public NimBLECharacteristicCallbacks
     {
         auto val = pCharacteristic->getValue();
 
-        if (memcmp(lastToRadio, val.data(), val.length()) != 0) {
-            if (bluetoothPhoneAPI->queue_size < 3) {
-                memcpy(lastToRadio, val.data(), val.length());
+        if (memcmp(lastToRadio, val.data(), val.length()) == 0)
+            return;
+
+        // NimBLE has already accepted this write and sends the response once we return, so the phone won't send it again.
+        // Make it wait while the main loop catches up, without holding nimble_mutex so reads carry on meanwhile, but queue
+        // the write whatever happens.
+        memcpy(lastToRadio, val.data(), val.length());
+        uint32_t start = millis();
+        bool waited = false;
+        while (true) {
+            {
                 std::lock_guard<std::mutex> guard(bluetoothPhoneAPI->nimble_mutex);
-                bluetoothPhoneAPI->nimble_queue.at(bluetoothPhoneAPI->queue_size) = val;
-                bluetoothPhoneAPI->queue_size++;
                 bluetoothPhoneAPI->setIntervalFromNow(0);
+                std::vector<NimBLEAttValue> &queue = bluetoothPhoneAPI->nimble_queue;
+                if (queue.size() < TORADIO_QUEUE_DEPTH || millis() - start >= TORADIO_BACKPRESSURE_MSEC) {
+                    if (queue.size() >= TORADIO_QUEUE_DEPTH) {
+                        LOG_WARN("BLE ToRadio queue still full after %u ms, queue write %u anyway", TORADIO_BACKPRESSURE_MSEC,
+                                 (unsigned)queue.size() + 1);
+                        bluetoothPhoneAPI->stats.toRadioOverflows++;
+                    }
+                    queue.push_back(val);
+                    bluetoothPhoneAPI->stats.toRadioFrames++;
+                    bluetoothPhoneAPI->stats.toRadioBytes += val.length();
+                    return;
+                }
+                if (!waited) {
+                    bluetoothPhoneAPI->stats.toRadioWaits++;
+                    waited = true;
+                }
             }
+
+            uint32_t elapsed = millis() - start;
+            if (elapsed < TORADIO_BACKPRESSURE_MSEC)
+                bluetoothPhoneAPI->queueSpace.take(TORADIO_BACKPRESSURE_MSEC - elapsed);
         }
     }
 };
@@ -99,23 +287,20 @@ class NimbleBluetoothFromRadioCallback : public NimBLECharacteristicCallbacks
 {
     virtual void onRead(NimBLECharacteristic *pCharacteristic)
     {
-        int tries = 0;
-        bluetoothPhoneAPI->phoneWants = true;
-        while (!bluetoothPhoneAPI->hasChecked && tries < 100) {
-            bluetoothPhoneAPI->setIntervalFromNow(0);
-            delay(20);
-            tries++;
-        }
-        std::lock_guard<std::mutex> guard(bluetoothPhoneAPI->nimble_mutex);
-        std::string fromRadioByteString(bluetoothPhoneAPI->fromRadioBytes,
-                                        bluetoothPhoneAPI->fromRadioBytes + bluetoothPhoneAPI->numBytes);
-        pCharacteristic->setValue(fromRadioByteString);
-
-        if (bluetoothPhoneAPI->numBytes != 0) // if we did send something, queue it up right away to reload
-            bluetoothPhoneAPI->setIntervalFromNow(0);
-        bluetoothPhoneAPI->numBytes = 0;
-        bluetoothPhoneAPI->hasChecked = false;
-        bluetoothPhoneAPI->phoneWants = false;
+        // Either way, have the main loop top up the ring
+        bluetoothPhoneAPI->popFromRadio(pCharacteristic);
+        bluetoothPhoneAPI->setIntervalFromNow(0);
+    }
+};
+
+class NimbleBluetoothFromRadioBatchCallback : public NimBLECharacteristicCallbacks
+{
+    virtual void onRead(NimBLECharacteristic *pCharacteristic, ble_gap_conn_desc *desc)
+    {
+        // A read response carries MTU - 1 bytes of the value
+        size_t maxLen = bleServer->getPeerMTU(desc->conn_handle) - 1;
+        bluetoothPhoneAPI->popFromRadioBatch(pCharacteristic, std::min(maxLen, (size_t)FROMRADIO_BATCH_MAX_LEN));
+        bluetoothPhoneAPI->setIntervalFromNow(0);
     }
 };
 
@@ -192,17 +377,19 @@ class NimbleBluetoothServerCallback : public NimBLEServerCallbacks
 
         if (bluetoothPhoneAPI) {
             std::lock_guard<std::mutex> guard(bluetoothPhoneAPI->nimble_mutex);
-            bluetoothPhoneAPI->close();
-            bluetoothPhoneAPI->hasChecked = false;
-            bluetoothPhoneAPI->phoneWants = false;
-            bluetoothPhoneAPI->numBytes = 0;
-            bluetoothPhoneAPI->queue_size = 0;
+            const NimbleBluetoothStats &stats = bluetoothPhoneAPI->stats;
+            LOG_INFO("BLE link: %u FromRadio frames (%u bytes, %u batches, %u empty reads), %u ToRadio frames (%u bytes, %u "
+                     "waited, %u overflowed)",
+                     stats.fromRadioFrames, stats.fromRadioBytes, stats.fromRadioBatches, stats.fromRadioEmptyReads,
+                     stats.toRadioFrames, stats.toRadioBytes, stats.toRadioWaits, stats.toRadioOverflows);
+            bluetoothPhoneAPI->resetLink();
         }
     }
 };
 
 static NimbleBluetoothToRadioCallback *toRadioCallbacks;
 static NimbleBluetoothFromRadioCallback *fromRadioCallbacks;
+static NimbleBluetoothFromRadioBatchCallback *fromRadioBatchCallbacks;
 
 void NimbleBluetooth::shutdown()
 {
@@ -236,6 +423,14 @@ bool NimbleBluetooth::isActive()
     return bleServer;
 }
 
+NimbleBluetoothStats NimbleBluetooth::getStats()
+{
+    if (!bluetoothPhoneAPI)
+        return NimbleBluetoothStats();
+    std::lock_guard<std::mutex> guard(bluetoothPhoneAPI->nimble_mutex);
+    return bluetoothPhoneAPI->stats;
+}
+
 bool NimbleBluetooth::isConnected()
 {
     return bleServer->getConnectedCount() > 0;
@@ -280,10 +475,13 @@ void NimbleBluetooth::setupService()
     NimBLEService *bleService = bleServer->createService(MESH_SERVICE_UUID);
     NimBLECharacteristic *ToRadioCharacteristic;
     NimBLECharacteristic *FromRadioCharacteristic;
+    NimBLECharacteristic *FromRadioBatchCharacteristic;
     // Define the characteristics that the app is looking for
     if (config.bluetooth.mode == meshtastic_Config_BluetoothConfig_PairingMode_NO_PIN) {
         ToRadioCharacteristic = bleService->createCharacteristic(TORADIO_UUID, NIMBLE_PROPERTY::WRITE);
         FromRadioCharacteristic = bleService->createCharacteristic(FROMRADIO_UUID, NIMBLE_PROPERTY::READ);
+        FromRadioBatchCharacteristic =
+            bleService->createCharacteristic(FROMRADIO_BATCH_UUID, NIMBLE_PROPERTY::READ, FROMRADIO_BATCH_MAX_LEN);
         fromNumCharacteristic = bleService->createCharacteristic(FROMNUM_UUID, NIMBLE_PROPERTY::NOTIFY | NIMBLE_PROPERTY::READ);
         logRadioCharacteristic =
             bleService->createCharacteristic(LOGRADIO_UUID, NIMBLE_PROPERTY::NOTIFY | NIMBLE_PROPERTY::READ, 512U);
@@ -292,6 +490,9 @@ void NimbleBluetooth::setupService()
             TORADIO_UUID, NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::WRITE_AUTHEN | NIMBLE_PROPERTY::WRITE_ENC);
         FromRadioCharacteristic = bleService->createCharacteristic(
             FROMRADIO_UUID, NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::READ_AUTHEN | NIMBLE_PROPERTY::READ_ENC);
+        FromRadioBatchCharacteristic = bleService->createCharacteristic(
+            FROMRADIO_BATCH_UUID, NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::READ_AUTHEN | NIMBLE_PROPERTY::READ_ENC,
+            FROMRADIO_BATCH_MAX_LEN);
         fromNumCharacteristic =
             bleService->createCharacteristic(FROMNUM_UUID, NIMBLE_PROPERTY::NOTIFY | NIMBLE_PROPERTY::READ |
                                                                NIMBLE_PROPERTY::READ_AUTHEN | NIMBLE_PROPERTY::READ_ENC);
@@ -307,6 +508,9 @@ void NimbleBluetooth::setupService()
     fromRadioCallbacks = new NimbleBluetoothFromRadioCallback();
     FromRadioCharacteristic->setCallbacks(fromRadioCallbacks);
 
+    fromRadioBatchCallbacks = new NimbleBluetoothFromRadioBatchCallback();
+    FromRadioBatchCharacteristic->setCallbacks(fromRadioBatchCallbacks);
+
     bleService->start();
 
     // Setup the battery service
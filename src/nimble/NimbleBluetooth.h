@@ -1,6 +1,18 @@
 #pragma once
 #include "BluetoothCommon.h"
 
+/**
+ * Throughput counts for the phone link, since boot
+ */
+struct NimbleBluetoothStats {
+    uint32_t fromRadioFrames = 0, fromRadioBytes = 0;
+    uint32_t fromRadioBatches = 0;    // Reads of the batched characteristic which returned something
+    uint32_t fromRadioEmptyReads = 0; // Reads which found nothing prefetched
+    uint32_t toRadioFrames = 0, toRadioBytes = 0;
+    uint32_t toRadioWaits = 0;        // Writes which had to wait for the main loop to make room
+    uint32_t toRadioOverflows = 0;    // Writes queued past the limit because the main loop didn't make room in time
+};
+
 class NimbleBluetooth : BluetoothApi
 {
   public:
@@ -12,6 +24,7 @@ class NimbleBluetooth : BluetoothApi
     bool isConnected();
     int getRssi();
     void sendLog(const uint8_t *logMessage, size_t length);
+    NimbleBluetoothStats getStats();
 
   private:
     void setupService();
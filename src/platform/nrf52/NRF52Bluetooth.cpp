@@ -13,6 +13,7 @@ static BLECharacteristic fromNum = BLECharacteristic(BLEUuid(FROMNUM_UUID_16));
 static BLECharacteristic fromRadio = BLECharacteristic(BLEUuid(FROMRADIO_UUID_16));
 static BLECharacteristic toRadio = BLECharacteristic(BLEUuid(TORADIO_UUID_16));
 static BLECharacteristic logRadio = BLECharacteristic(BLEUuid(LOGRADIO_UUID_16));
+static BLECharacteristic fromRadioBatch = BLECharacteristic(BLEUuid(FROMRADIO_BATCH_UUID_16));
 
 static BLEDis bledis; // DIS (Device Information Service) helper class instance
 static BLEBas blebas; // BAS (Battery Service) helper class instance
@@ -27,6 +28,11 @@ static BLEDfuSecure bledfusecure;                                             //
 // static uint8_t trBytes[_max(_max(_max(_max(ToRadio_size, RadioConfig_size), User_size), MyNodeInfo_size), FromRadio_size)];
 static uint8_t fromRadioBytes[meshtastic_FromRadio_size];
 static uint8_t toRadioBytes[meshtastic_ToRadio_size];
+static uint8_t fromRadioBatchBytes[FROMRADIO_BATCH_MAX_LEN];
+
+// A frame we took from the PhoneAPI which didn't fit in the last batch, goes first in the next read
+static uint8_t heldFromRadioBytes[meshtastic_FromRadio_size];
+static size_t heldFromRadioLen;
 
 static uint16_t connectionHandle;
 
@@ -72,6 +78,7 @@ void onDisconnect(uint16_t conn_handle, uint8_t reason)
     if (bluetoothPhoneAPI) {
         bluetoothPhoneAPI->close();
     }
+    heldFromRadioLen = 0;
 
     // Notify UI (or any other interested firmware components)
     bluetoothStatus->updateStatus(new meshtastic::BluetoothStatus(meshtastic::BluetoothStatus::ConnectionState::DISCONNECTED));
@@ -134,7 +141,15 @@ void onFromRadioAuthorize(uint16_t conn_hdl, BLECharacteristic *chr, ble_gatts_e
 {
     if (request->offset == 0) {
         // If the read is long, we will get multiple authorize invocations - we only populate data on the first
-        size_t numBytes = bluetoothPhoneAPI->getFromRadio(fromRadioBytes);
+        size_t numBytes;
+        if (heldFromRadioLen) {
+            // Left over from a batched read
+            numBytes = heldFromRadioLen;
+            memcpy(fromRadioBytes, heldFromRadioBytes, numBytes);
+            heldFromRadioLen = 0;
+        } else {
+            numBytes = bluetoothPhoneAPI->getFromRadio(fromRadioBytes);
+        }
         // Someone is going to read our value as soon as this callback returns.  So fill it with the next message in the queue
         // or make empty if the queue is empty
         fromRadio.write(fromRadioBytes, numBytes);
@@ -143,6 +158,31 @@ void onFromRadioAuthorize(uint16_t conn_hdl, BLECharacteristic *chr, ble_gatts_e
     }
     authorizeRead(conn_hdl);
 }
+/**
+ * client is starting a read of the batched characteristic, pack in as many frames as its MTU allows
+ */
+void onFromRadioBatchAuthorize(uint16_t conn_hdl, BLECharacteristic *chr, ble_gatts_evt_read_t *request)
+{
+    if (request->offset == 0) {
+        // A read response carries MTU - 1 bytes of the value
+        size_t maxLen = min((size_t)Bluefruit.Connection(conn_hdl)->getMtu() - 1, sizeof(fromRadioBatchBytes));
+        size_t batchLen = 0;
+
+        while (true) {
+            if (!heldFromRadioLen)
+                heldFromRadioLen = bluetoothPhoneAPI->getFromRadio(heldFromRadioBytes);
+            if (!heldFromRadioLen)
+                break;
+            // The first frame always goes, if it is bigger than the MTU the phone gets the rest with a long read
+            if (!appendFromRadioBatch(fromRadioBatchBytes, batchLen, batchLen ? maxLen : sizeof(fromRadioBatchBytes),
+                                      heldFromRadioBytes, heldFromRadioLen))
+                break;
+            heldFromRadioLen = 0;
+        }
+        fromRadioBatch.write(fromRadioBatchBytes, batchLen);
+    }
+    authorizeRead(conn_hdl);
+}
 // Last ToRadio value received from the phone
 static uint8_t lastToRadio[MAX_TO_FROM_RADIO_SIZE];
 
@@ -189,6 +229,13 @@ void setupMeshService(void)
     // for two copies
     fromRadio.begin();
 
+    fromRadioBatch.setProperties(CHR_PROPS_READ);
+    fromRadioBatch.setPermission(secMode, SECMODE_NO_ACCESS);
+    fromRadioBatch.setMaxLen(sizeof(fromRadioBatchBytes));
+    fromRadioBatch.setReadAuthorizeCallback(onFromRadioBatchAuthorize, false);
+    fromRadioBatch.setBuffer(fromRadioBatchBytes, sizeof(fromRadioBatchBytes));
+    fromRadioBatch.begin();
+
     toRadio.setProperties(CHR_PROPS_WRITE);
     toRadio.setPermission(secMode, secMode); // FIXME secure this!
     toRadio.setFixedLen(0);
@@ -9,22 +9,26 @@ class NRF52CryptoEngine : public CryptoEngine
 
     ~NRF52CryptoEngine() {}
 
-    virtual void encryptAESCtr(CryptoKey _key, uint8_t *_nonce, size_t numBytes, uint8_t *bytes) override
+    virtual void encryptAESCtr(CryptoKey _key, uint8_t *_nonce, size_t numBytes, const uint8_t *in, uint8_t *out) override
     {
         if (_key.length > 16) {
             AES_ctx ctx;
             AES_init_ctx_iv(&ctx, _key.bytes, _nonce);
-            AES_CTR_xcrypt_buffer(&ctx, bytes, numBytes);
+            if (out != in)
+                memcpy(out, in, numBytes); // tiny-AES only works in place
+            AES_CTR_xcrypt_buffer(&ctx, out, numBytes);
         } else if (_key.length > 0) {
             nRFCrypto.begin();
             nRFCrypto_AES ctx;
             uint8_t myLen = ctx.blockLen(numBytes);
             char encBuf[myLen] = {0};
             ctx.begin();
-            ctx.Process((char *)bytes, numBytes, _nonce, _key.bytes, _key.length, encBuf, ctx.encryptFlag, ctx.ctrMode);
+            ctx.Process((char *)in, numBytes, _nonce, _key.bytes, _key.length, encBuf, ctx.encryptFlag, ctx.ctrMode);
             ctx.end();
             nRFCrypto.end();
-            memcpy(bytes, encBuf, numBytes);
+            memcpy(out, encBuf, numBytes);
+        } else if (out != in) {
+            memcpy(out, in, numBytes);
         }
     }
 };
@@ -25,7 +25,9 @@
 #include <cxxabi.h>
 #endif
 
+#include "platform/portduino/TimeSource.h"
 #include "platform/portduino/USBHal.h"
+#include "platform/portduino/sim/MeshBenchmark.h"
 
 std::map<configNames, int> settingsMap;
 std::map<configNames, std::string> settingsStrings;
@@ -35,6 +37,16 @@ char *configPath = nullptr;
 char *optionMac = nullptr;
 bool forceSimulated = false;
 bool verboseEnabled = false;
+bool fastForward = false;
+char *simBenchScenario = nullptr;
+bool simBenchAdaptive = false;
+bool simBenchCounting = false;
+
+// Long-only options, outside the printable range so they never clash with a short option
+#define OPT_SIM_BENCH 1000
+#define OPT_FAST_FORWARD 1001
+#define OPT_SIM_CONTENTION 1002
+#define OPT_SIM_SUPPRESSION 1003
 
 const char *argp_program_version = optstr(APP_VERSION);
 
@@ -74,6 +86,24 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state)
     case 'v':
         verboseEnabled = true;
         break;
+    case OPT_SIM_BENCH:
+        simBenchScenario = arg ? arg : (char *)"all";
+        break;
+    case OPT_FAST_FORWARD:
+        fastForward = true;
+        break;
+    case OPT_SIM_CONTENTION:
+        if (strcmp(arg, "adaptive") == 0)
+            simBenchAdaptive = true;
+        else if (strcmp(arg, "fixed") != 0)
+            return ARGP_ERR_UNKNOWN;
+        break;
+    case OPT_SIM_SUPPRESSION:
+        if (strcmp(arg, "counting") == 0)
+            simBenchCounting = true;
+        else if (strcmp(arg, "first") != 0)
+            return ARGP_ERR_UNKNOWN;
+        break;
     case ARGP_KEY_ARG:
         return 0;
     default:
@@ -89,6 +119,15 @@ void portduinoCustomInit()
                                            {"hwid", 'h', "HWID", 0, "The mac address to assign to this virtual machine"},
                                            {"sim", 's', 0, 0, "Run in Simulated radio mode"},
                                            {"verbose", 'v', 0, 0, "Set log level to full debug"},
+                                           {"sim-bench", OPT_SIM_BENCH, "SCENARIO", OPTION_ARG_OPTIONAL,
+                                            "Run a simulated mesh routing benchmark (line, grid, city, backbone or all), print JSON "
+                                            "results and exit"},
+                                           {"sim-contention", OPT_SIM_CONTENTION, "MODE", 0,
+                                            "Contention window for --sim-bench: fixed (default) or adaptive"},
+                                           {"sim-suppression", OPT_SIM_SUPPRESSION, "MODE", 0,
+                                            "Rebroadcast suppression for --sim-bench: first (default) or counting"},
+                                           {"fast-forward", OPT_FAST_FORWARD, 0, 0,
+                                            "Skip idle time instead of sleeping, so timers fire as fast as they can be run"},
                                            {0}};
     static void *childArguments;
     static char doc[] = "Meshtastic native build.";
@@ -141,12 +180,45 @@ void getMacAddr(uint8_t *dmac)
     }
 }
 
+/**
+ * Run one or all of the MeshBenchmark scenarios, printing one JSON object per line on stdout
+ * @return process exit code
+ */
+static int runSimBenchmark(const std::string &scenario)
+{
+    MeshBenchmark::Options options;
+    if (simBenchAdaptive)
+        options.sim.contentionMode = ContentionController::CONTENTION_ADAPTIVE;
+    if (simBenchCounting)
+        options.sim.suppressionMode = RebroadcastSuppressor::SUPPRESS_COUNTING;
+    MeshBenchmark bench{options};
+    MeshBenchmarkResult result;
+
+    if (scenario != "all") {
+        if (!bench.run(scenario, result)) {
+            std::cerr << "Unknown benchmark scenario " << scenario << std::endl;
+            return EXIT_FAILURE;
+        }
+        MeshBenchmark::printJson(stdout, result);
+        return EXIT_SUCCESS;
+    }
+
+    for (const auto &name : MeshBenchmark::scenarioNames()) {
+        bench.run(name, result);
+        MeshBenchmark::printJson(stdout, result);
+    }
+    return EXIT_SUCCESS;
+}
+
 /** apps run under portduino can optionally define a portduinoSetup() to
  * use portduino specific init code (such as gpioBind) to setup portduino on their host machine,
  * before running 'arduino' code.
  */
 void portduinoSetup()
 {
+    if (simBenchScenario != nullptr)
+        exit(runSimBenchmark(simBenchScenario));
+
     printf("Set up Meshtastic on Portduino...\n");
     int max_GPIO = 0;
     const configNames GPIO_lines[] = {cs_pin,
@@ -189,6 +261,11 @@ void portduinoSetup()
 
     YAML::Node yamlConfig;
 
+    if (fastForward) {
+        std::cout << "Fast-forwarding through idle time" << std::endl;
+        setFastForward(true);
+    }
+
     if (forceSimulated == true) {
         settingsMap[use_simradio] = true;
     } else if (configPath != nullptr) {
@@ -1,4 +1,5 @@
 #include "SimRadio.h"
+#include "LinkQualityTable.h"
 #include "MeshService.h"
 #include "Router.h"
 
@@ -43,7 +44,7 @@ void SimRadio::setTransmitDelay()
     } else {
         // If there is a SNR, start a timer scaled based on that SNR.
         LOG_DEBUG("rx_snr found. hop_limit:%d rx_snr:%f", p->hop_limit, p->rx_snr);
-        startTransmitTimerSNR(p->rx_snr);
+        startTransmitTimerSNR(getTxDelaySnr(p));
     }
 }
 
@@ -309,6 +310,7 @@ void SimRadio::handleReceiveInterrupt()
     packetPool.release(receivingPacket);                                // release the original
     receivingPacket = nullptr;
 
+    linkQuality.onReceive(mp);
     printPacket("Lora RX", mp);
 
     airTime->logAirtime(RX_LOG, getPacketTime(mp));
@@ -0,0 +1,41 @@
+#include "TimeSource.h"
+#include "concurrency/OSThread.h"
+
+// The real implementations from the framework, renamed by the linker
+extern "C" unsigned long __real_millis(void);
+extern "C" unsigned long __real_micros(void);
+
+static WallClock wallClock;
+static FastForwardClock fastForwardClock;
+
+TimeSource *timeSource = &wallClock;
+
+extern "C" unsigned long __wrap_millis(void)
+{
+    return timeSource->millis();
+}
+
+extern "C" unsigned long __wrap_micros(void)
+{
+    return timeSource->micros();
+}
+
+uint64_t WallClock::millis()
+{
+    return __real_millis();
+}
+
+uint64_t WallClock::micros()
+{
+    return __real_micros();
+}
+
+void WallClock::idle(uint32_t msec)
+{
+    concurrency::mainDelay.delay(msec);
+}
+
+void setFastForward(bool enable)
+{
+    timeSource = enable ? (TimeSource *)&fastForwardClock : (TimeSource *)&wallClock;
+}
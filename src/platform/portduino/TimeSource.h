@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * Where millis() and micros() get their time from on portduino, and how the main loop waits for the next OSThread.
+ *
+ * The native build links with --wrap=millis and --wrap=micros, so every caller (OSThread scheduling, Throttle, AirTime,
+ * getTime() and libraries) goes through the current TimeSource.
+ */
+class TimeSource
+{
+  public:
+    virtual ~TimeSource() {}
+
+    virtual uint64_t millis() = 0;
+    virtual uint64_t micros() = 0;
+
+    /**
+     * Called by the main loop when nothing needs to run for msec
+     */
+    virtual void idle(uint32_t msec) = 0;
+};
+
+/**
+ * The host clock: idle() sleeps in mainDelay, as on the other architectures
+ */
+class WallClock : public TimeSource
+{
+  public:
+    uint64_t millis() override;
+    uint64_t micros() override;
+    void idle(uint32_t msec) override;
+};
+
+/**
+ * The host clock plus any time we skipped: instead of sleeping, idle() jumps straight to the next OSThread deadline.
+ *
+ * Time still passes normally while code runs, so busy waits and delay() keep working, but a day of NodeInfo, telemetry or
+ * duty-cycle behaviour takes only as long as the work done in it.  Anything which would have woken the main loop from
+ * another thread during a skip is only seen at the deadline, so this is meant for the simulated radio.
+ */
+class FastForwardClock : public WallClock
+{
+  public:
+    uint64_t millis() override { return WallClock::millis() + skippedMsec; }
+    uint64_t micros() override { return WallClock::micros() + skippedMsec * 1000; }
+    void idle(uint32_t msec) override { skippedMsec += msec; }
+
+    /** Total time skipped so far */
+    uint64_t getSkippedMsec() const { return skippedMsec; }
+
+  private:
+    std::atomic<uint64_t> skippedMsec{0};
+};
+
+extern TimeSource *timeSource;
+
+/** Switch between WallClock and FastForwardClock, must be done before any threads are created */
+void setFastForward(bool enable);
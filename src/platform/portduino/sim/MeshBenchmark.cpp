@@ -0,0 +1,267 @@
+#include "MeshBenchmark.h"
+
+#if ARCH_PORTDUINO
+#include <algorithm>
+#include <ctime>
+#include <queue>
+#include <unordered_map>
+
+namespace
+{
+constexpr NodeNum FIRST_NODE_NUM = 0x1000;
+
+// Traffic mix: default module intervals, plus a busy chat channel shared by the whole mesh
+constexpr uint32_t POSITION_INTERVAL_MSEC = 15 * 60 * 1000;
+constexpr uint32_t TELEMETRY_INTERVAL_MSEC = 60 * 60 * 1000;
+constexpr uint32_t MEAN_TEXT_INTERVAL_MSEC = 2 * 60 * 1000;
+constexpr uint8_t POSITION_PAYLOAD_LEN = 32;
+constexpr uint8_t TELEMETRY_PAYLOAD_LEN = 24;
+constexpr float TEXT_BROADCAST_FRACTION = 0.3f; // The rest are acknowledged direct messages
+
+// How long to keep running after the last packet is generated, for relays and retransmissions to finish
+constexpr uint32_t SETTLE_MSEC = 10 * 60 * 1000;
+
+void addNode(MeshSimulator &sim, float x, float y, int8_t txPowerDbm = 20,
+             meshtastic_Config_DeviceConfig_Role role = meshtastic_Config_DeviceConfig_Role_CLIENT)
+{
+    SimNodeSpec spec;
+    spec.num = FIRST_NODE_NUM + sim.numNodes();
+    spec.placement.x = x;
+    spec.placement.y = y;
+    spec.placement.txPowerDbm = txPowerDbm;
+    spec.role = role;
+    sim.addNode(spec);
+}
+
+// As Default::congestionScalingCoefficient for LongFast, which stretches the periodic broadcasts on big meshes
+float congestionScaling(int numNodes)
+{
+    if (numNodes <= 10)
+        return 0.6;
+    else if (numNodes <= 20)
+        return 0.7;
+    else if (numNodes <= 30)
+        return 0.8;
+    else if (numNodes <= 40)
+        return 1.0;
+    return 1.0 + (numNodes - 40) * 0.075;
+}
+
+uint32_t percentile(const std::vector<uint32_t> &sorted, float p)
+{
+    if (sorted.empty())
+        return 0;
+    return sorted[std::min(sorted.size() - 1, (size_t)(p * sorted.size()))];
+}
+} // namespace
+
+const std::vector<std::string> &MeshBenchmark::scenarioNames()
+{
+    static const std::vector<std::string> names = {"line", "grid", "city", "backbone"};
+    return names;
+}
+
+bool MeshBenchmark::run(const std::string &scenario, MeshBenchmarkResult &result)
+{
+    MeshSimulator::Config simConfig = options.sim;
+    simConfig.seed = options.seed;
+    MeshSimulator sim(simConfig);
+    std::mt19937 rng(options.seed);
+
+    if (scenario == "line")
+        buildLine(sim);
+    else if (scenario == "grid")
+        buildGrid(sim);
+    else if (scenario == "city")
+        buildCity(sim, rng);
+    else if (scenario == "backbone")
+        buildBackbone(sim, rng);
+    else
+        return false;
+
+    addTraffic(sim, rng);
+
+    std::clock_t start = std::clock();
+    sim.runUntilIdle(options.durationMsec + SETTLE_MSEC);
+    std::clock_t end = std::clock();
+
+    result = MeshBenchmarkResult();
+    result.scenario = scenario;
+    result.contention = simConfig.contentionMode;
+    result.suppression = simConfig.suppressionMode;
+    collect(sim, result);
+    if (result.packets)
+        result.simCpuUsecPerPacket = (double)(end - start) * 1000000 / CLOCKS_PER_SEC / result.packets;
+    return true;
+}
+
+void MeshBenchmark::buildLine(MeshSimulator &sim)
+{
+    // Neighbours only, so every packet has to be relayed hop by hop
+    for (int i = 0; i < 12; i++)
+        addNode(sim, i * 8000, 0);
+}
+
+void MeshBenchmark::buildGrid(MeshSimulator &sim)
+{
+    for (int y = 0; y < 10; y++)
+        for (int x = 0; x < 10; x++)
+            addNode(sim, x * 3000, y * 3000);
+}
+
+void MeshBenchmark::buildCity(MeshSimulator &sim, std::mt19937 &rng)
+{
+    // Dense neighbourhoods which can only just hear each other
+    const float centres[][2] = {{0, 0}, {9000, 0}, {0, 9000}, {9000, 9000}, {4500, 4500}};
+    std::normal_distribution<float> spread(0, 600);
+    for (const auto &centre : centres)
+        for (int i = 0; i < 40; i++)
+            addNode(sim, centre[0] + spread(rng), centre[1] + spread(rng), 17);
+}
+
+void MeshBenchmark::buildBackbone(MeshSimulator &sim, std::mt19937 &rng)
+{
+    // Well sited, higher power routers with low power handhelds scattered underneath
+    for (int y = 0; y < 3; y++)
+        for (int x = 0; x < 4; x++)
+            addNode(sim, 5000 + x * 10000, 5000 + y * 10000, 27, meshtastic_Config_DeviceConfig_Role_ROUTER);
+
+    std::uniform_real_distribution<float> xPos(0, 40000), yPos(0, 30000);
+    for (int i = 0; i < 150; i++)
+        addNode(sim, xPos(rng), yPos(rng), 17);
+}
+
+void MeshBenchmark::addTraffic(MeshSimulator &sim, std::mt19937 &rng)
+{
+    uint16_t numNodes = sim.numNodes();
+    uint32_t positionInterval = POSITION_INTERVAL_MSEC * congestionScaling(numNodes);
+    uint32_t telemetryInterval = TELEMETRY_INTERVAL_MSEC * congestionScaling(numNodes);
+    std::uniform_int_distribution<uint32_t> positionPhase(0, positionInterval - 1);
+    std::uniform_int_distribution<uint32_t> telemetryPhase(0, telemetryInterval - 1);
+    std::uniform_int_distribution<int32_t> jitter(-30 * 1000, 30 * 1000);
+
+    for (uint16_t n = 0; n < numNodes; n++) {
+        for (uint32_t t = positionPhase(rng); t < options.durationMsec; t += positionInterval)
+            sim.send(n, NODENUM_BROADCAST, POSITION_PAYLOAD_LEN, false, std::max<int64_t>(1, (int64_t)t + jitter(rng)),
+                     SIM_TRAFFIC_POSITION);
+
+        for (uint32_t t = telemetryPhase(rng); t < options.durationMsec; t += telemetryInterval)
+            sim.send(n, NODENUM_BROADCAST, TELEMETRY_PAYLOAD_LEN, false, std::max<int64_t>(1, (int64_t)t + jitter(rng)),
+                     SIM_TRAFFIC_TELEMETRY);
+    }
+
+    std::exponential_distribution<double> textInterval(1.0 / MEAN_TEXT_INTERVAL_MSEC);
+    std::uniform_real_distribution<float> unit(0, 1);
+    std::uniform_int_distribution<int> textLen(10, 120);
+    std::uniform_int_distribution<uint16_t> anyNode(0, numNodes - 1);
+    std::uniform_int_distribution<uint16_t> otherNode(1, numNodes - 1);
+
+    for (double t = textInterval(rng); t < options.durationMsec; t += textInterval(rng)) {
+        uint16_t from = anyNode(rng);
+        if (unit(rng) < TEXT_BROADCAST_FRACTION) {
+            sim.send(from, NODENUM_BROADCAST, textLen(rng), false, (uint32_t)t + 1, SIM_TRAFFIC_TEXT);
+        } else {
+            uint16_t to = (from + otherNode(rng)) % numNodes;
+            sim.send(from, sim.getNodeSpec(to).num, textLen(rng), true, (uint32_t)t + 1, SIM_TRAFFIC_TEXT);
+        }
+    }
+}
+
+std::vector<uint8_t> MeshBenchmark::hopDistances(const MeshSimulator &sim, uint16_t from)
+{
+    std::vector<uint8_t> hops(sim.numNodes(), UINT8_MAX);
+    std::queue<uint16_t> frontier;
+    hops[from] = 0;
+    frontier.push(from);
+    while (!frontier.empty()) {
+        uint16_t n = frontier.front();
+        frontier.pop();
+        for (const auto &l : sim.getChannel().neighbours(n)) {
+            if (hops[l.node] == UINT8_MAX) {
+                hops[l.node] = hops[n] + 1;
+                frontier.push(l.node);
+            }
+        }
+    }
+    return hops;
+}
+
+void MeshBenchmark::collect(const MeshSimulator &sim, MeshBenchmarkResult &result) const
+{
+    uint16_t numNodes = sim.numNodes();
+    result.numNodes = numNodes;
+    result.durationMsec = sim.millis();
+
+    // The original transmission is one hop, then each relay adds another until the hop limit runs out
+    uint8_t maxHops = options.sim.hopLimit + 1;
+    std::unordered_map<uint16_t, std::vector<uint8_t>> distances;
+    uint64_t possible = 0, delivered = 0;
+    uint32_t dmReachable = 0, dmAcked = 0;
+    std::vector<uint32_t> latencies;
+
+    for (const auto &p : sim.getPackets()) {
+        uint16_t from = p.from - FIRST_NODE_NUM;
+        auto it = distances.find(from);
+        if (it == distances.end())
+            it = distances.emplace(from, hopDistances(sim, from)).first;
+        const std::vector<uint8_t> &hops = it->second;
+
+        result.packets++;
+        if (p.to == NODENUM_BROADCAST) {
+            for (uint16_t n = 0; n < numNodes; n++)
+                if (n != from && hops[n] <= maxHops)
+                    possible++;
+            delivered += p.latenciesMsec.size();
+        } else if (hops[p.to - FIRST_NODE_NUM] <= maxHops) {
+            possible++;
+            delivered += !p.latenciesMsec.empty();
+            if (p.wantAck) {
+                dmReachable++;
+                dmAcked += p.acked;
+            }
+        }
+        latencies.insert(latencies.end(), p.latenciesMsec.begin(), p.latenciesMsec.end());
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    result.latencyP50Msec = percentile(latencies, 0.5f);
+    result.latencyP90Msec = percentile(latencies, 0.9f);
+    result.latencyP99Msec = percentile(latencies, 0.99f);
+    result.latencyMaxMsec = latencies.empty() ? 0 : latencies.back();
+    result.deliveryRatio = possible ? (float)delivered / possible : 0;
+    result.ackRatio = dmReachable ? (float)dmAcked / dmReachable : 0;
+
+    uint32_t relays = 0;
+    float utilSum = 0;
+    for (uint16_t n = 0; n < numNodes; n++) {
+        const SimNodeStats &stats = sim.getNodeStats(n);
+        relays += stats.txRelay;
+        result.cadBusy += stats.cadBusy;
+        result.crcErrors += stats.rxBad;
+        // Overlapping receptions are counted twice, so clamp like a real busy-time measurement would
+        float util = std::min(100.0f, 100.0f * (stats.txAirtimeMsec + stats.rxAirtimeMsec) / result.durationMsec);
+        utilSum += util;
+        result.maxChannelUtilPercent = std::max(result.maxChannelUtilPercent, util);
+    }
+    result.channelUtilPercent = numNodes ? utilSum / numNodes : 0;
+    result.rebroadcastsPerPacket = result.packets ? (float)relays / result.packets : 0;
+    result.totalAirtimeMsec = sim.getTotalAirtimeMsec();
+    result.collisions = sim.getChannel().collisions;
+}
+
+void MeshBenchmark::printJson(FILE *out, const MeshBenchmarkResult &r)
+{
+    const char *contention = r.contention == ContentionController::CONTENTION_ADAPTIVE ? "adaptive" : "fixed";
+    const char *suppression = r.suppression == RebroadcastSuppressor::SUPPRESS_COUNTING ? "counting" : "first";
+    fprintf(out,
+            "{\"scenario\":\"%s\",\"contention\":\"%s\",\"suppression\":\"%s\",\"nodes\":%u,\"duration_ms\":%u,\"packets\":%u,"
+            "\"delivery_ratio\":%.4f,\"ack_ratio\":%.4f,\"latency_ms\":{\"p50\":%u,\"p90\":%u,\"p99\":%u,\"max\":%u},"
+            "\"rebroadcasts_per_packet\":%.3f,\"channel_util_percent\":%.2f,\"max_channel_util_percent\":%.2f,"
+            "\"total_airtime_ms\":%u,\"collisions\":%u,\"cad_busy\":%u,\"crc_errors\":%u,\"sim_cpu_us_per_packet\":%.1f}\n",
+            r.scenario.c_str(), contention, suppression, r.numNodes, r.durationMsec, r.packets, r.deliveryRatio, r.ackRatio,
+            r.latencyP50Msec, r.latencyP90Msec, r.latencyP99Msec, r.latencyMaxMsec, r.rebroadcastsPerPacket,
+            r.channelUtilPercent, r.maxChannelUtilPercent, r.totalAirtimeMsec, r.collisions, r.cadBusy, r.crcErrors,
+            r.simCpuUsecPerPacket);
+}
+
+#endif
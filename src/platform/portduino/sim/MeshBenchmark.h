@@ -0,0 +1,88 @@
+#pragma once
+
+#include "configuration.h"
+
+#if ARCH_PORTDUINO
+#include "MeshSimulator.h"
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/** Traffic classes generated by MeshBenchmark, stored in SimFrame::kind */
+enum SimTrafficKind : uint8_t { SIM_TRAFFIC_TEXT = 1, SIM_TRAFFIC_POSITION, SIM_TRAFFIC_TELEMETRY };
+
+/**
+ * Results of one benchmark scenario
+ */
+struct MeshBenchmarkResult {
+    std::string scenario;
+    ContentionController::Mode contention = ContentionController::CONTENTION_FIXED;
+    RebroadcastSuppressor::Mode suppression = RebroadcastSuppressor::SUPPRESS_FIRST_DUPLICATE;
+    uint16_t numNodes = 0;
+    uint32_t durationMsec = 0;  // Virtual time covered by the run
+    uint32_t packets = 0;       // Packets originated, excluding ACKs
+    float deliveryRatio = 0;    // Receptions over the receptions possible within the hop limit
+    float ackRatio = 0;         // Direct messages which were acknowledged back to their sender
+    uint32_t latencyP50Msec = 0, latencyP90Msec = 0, latencyP99Msec = 0, latencyMaxMsec = 0;
+    float rebroadcastsPerPacket = 0; // Relayed transmissions (including ACKs) per originated packet
+    float channelUtilPercent = 0;    // Mean over nodes of the time they were hearing or sending
+    float maxChannelUtilPercent = 0; // Same, for the busiest node
+    uint32_t totalAirtimeMsec = 0;   // Time on air summed over all transmissions
+    uint32_t collisions = 0;         // As counted by SimChannel
+    uint32_t cadBusy = 0;            // Sends deferred because the channel was busy
+    uint32_t crcErrors = 0;          // Receptions lost to collisions, which a real radio would report as CRC errors
+    // Host CPU time the whole simulation took, per originated packet.  That is mostly SimChannel and MeshSimulator's own model
+    // of each node, which only shares the RadioInterface timing helpers with the firmware; FloodingRouter and NextHopRouter
+    // never run.  So it compares simulator changes, it doesn't measure firmware routing cost.
+    double simCpuUsecPerPacket = 0;
+};
+
+/**
+ * Replays standard topologies and traffic mixes over MeshSimulator and reports delivery, latency and airtime metrics.
+ *
+ * Every scenario is deterministic for a given seed, so results can be compared between firmware revisions to catch routing
+ * regressions.
+ */
+class MeshBenchmark
+{
+  public:
+    struct Options {
+        uint32_t seed = 1;
+        uint32_t durationMsec = 60 * 60 * 1000; // Traffic is generated for this long, then the mesh is left to settle
+        MeshSimulator::Config sim;
+    };
+
+    /** Names accepted by run() */
+    static const std::vector<std::string> &scenarioNames();
+
+    explicit MeshBenchmark(const Options &options) : options(options) {}
+
+    /**
+     * Run a named scenario (line, grid, city or backbone)
+     * @return false if the scenario is unknown
+     */
+    bool run(const std::string &scenario, MeshBenchmarkResult &result);
+
+    /** Write result as a single line JSON object */
+    static void printJson(FILE *out, const MeshBenchmarkResult &result);
+
+  private:
+    Options options;
+
+    void buildLine(MeshSimulator &sim);
+    void buildGrid(MeshSimulator &sim);
+    void buildCity(MeshSimulator &sim, std::mt19937 &rng);
+    void buildBackbone(MeshSimulator &sim, std::mt19937 &rng);
+
+    /** Schedule periodic position and telemetry broadcasts plus chat traffic from every node */
+    void addTraffic(MeshSimulator &sim, std::mt19937 &rng);
+
+    /** Fill in the metrics once sim has run */
+    void collect(const MeshSimulator &sim, MeshBenchmarkResult &result) const;
+
+    /** Fewest hops from node to every other node on a quiet channel, UINT8_MAX if it can't be reached at all */
+    static std::vector<uint8_t> hopDistances(const MeshSimulator &sim, uint16_t from);
+};
+
+#endif
@@ -0,0 +1,543 @@
+#include "MeshSimulator.h"
+
+#if ARCH_PORTDUINO
+#include "modules/RoutingModule.h"
+#include <algorithm>
+#include <assert.h>
+#include <iterator>
+#include <string.h>
+
+MeshSimulator::MeshSimulator(const Config &config) : config(config), rng(config.seed)
+{
+    randomSeed(config.seed); // The firmware delay rules draw from random()
+    slotTimeMsec = RadioInterface::computeSlotTimeMsec(config.bw, config.sf, false);
+}
+
+uint16_t MeshSimulator::addNode(const SimNodeSpec &spec)
+{
+    assert(!built);
+    Node node;
+    node.spec = spec;
+    node.relayId = (uint8_t)((spec.num & 0xFF) ? (spec.num & 0xFF) : 0xFF); // As NodeDB::getLastByteOfNodeNum
+    node.contention.setMode(config.contentionMode);
+    node.suppressor.setMode(config.suppressionMode);
+    nodes.push_back(node);
+    nodeIndex[spec.num] = nodes.size() - 1;
+    return nodes.size() - 1;
+}
+
+PacketId MeshSimulator::send(uint16_t node, NodeNum to, uint8_t payloadLen, bool wantAck, uint32_t atMsec, uint8_t kind)
+{
+    assert(atMsec >= nowMsec);
+
+    SimPacketRecord r;
+    r.from = nodes[node].spec.num;
+    r.to = to;
+    do {
+        r.id = rng();
+    } while (r.id == 0 || packetIndex.count(key(r.from, r.id)));
+    r.kind = kind;
+    r.payloadLen = payloadLen;
+    r.wantAck = wantAck && to != NODENUM_BROADCAST;
+    r.originMsec = atMsec;
+
+    packetIndex[key(r.from, r.id)] = packets.size();
+    packets.push_back(r);
+    schedule(atMsec, ORIGINATE, node, packets.size() - 1);
+
+    return r.id;
+}
+
+void MeshSimulator::runUntil(uint32_t untilMsec)
+{
+    runUntilIdle(untilMsec);
+    nowMsec = std::max(nowMsec, untilMsec);
+}
+
+bool MeshSimulator::runUntilIdle(uint32_t limitMsec)
+{
+    if (!built) {
+        std::vector<SimPlacement> placements;
+        for (const auto &node : nodes)
+            placements.push_back(node.spec.placement);
+        channel.build(placements, config.sf, config.channel);
+        built = true;
+    }
+
+    while (!events.empty() && events.top().atMsec <= limitMsec) {
+        Event e = events.top();
+        events.pop();
+        nowMsec = e.atMsec;
+        dispatch(e);
+    }
+    return events.empty();
+}
+
+uint32_t MeshSimulator::getPacketTime(uint8_t payloadLen) const
+{
+    return RadioInterface::getPacketTime(payloadLen + sizeof(PacketHeader), config.bw, config.sf, config.cr,
+                                         config.preambleLength);
+}
+
+float MeshSimulator::channelUtilizationPercent(uint16_t n)
+{
+    logAirtime(n, 0); // Rotate out stale periods
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < CHANNEL_UTILIZATION_PERIODS; i++)
+        sum += nodes[n].utilization[i];
+
+    return (float(sum) / float(CHANNEL_UTILIZATION_PERIODS * 10 * 1000)) * 100;
+}
+
+void MeshSimulator::schedule(uint32_t atMsec, EventType type, uint16_t node, uint64_t arg)
+{
+    events.push({atMsec, nextSeq++, type, node, arg});
+}
+
+void MeshSimulator::dispatch(const Event &e)
+{
+    switch (e.type) {
+    case ORIGINATE: {
+        const SimPacketRecord &r = packets[e.arg];
+        SimFrame f;
+        memset(&f.header, 0, sizeof(f.header));
+        f.header.from = r.from;
+        f.header.to = r.to;
+        f.header.id = r.id;
+        f.header.flags = config.hopLimit | (r.wantAck ? PACKET_FLAGS_WANT_ACK_MASK : 0) |
+                         ((config.hopLimit << PACKET_FLAGS_HOP_START_SHIFT) & PACKET_FLAGS_HOP_START_MASK);
+        f.payloadLen = r.payloadLen;
+        f.kind = r.kind;
+        f.originMsec = r.originMsec;
+
+        // ReliableRouter takes care of our own want_ack packets
+        if (r.wantAck)
+            startRetransmission(e.node, f, NextHopRouter::NUM_RELIABLE_RETX);
+        sendFrame(e.node, f, false);
+        break;
+    }
+    case TX_TIMER:
+        onTxTimer(e.node);
+        break;
+    case TX_DONE:
+        onTxDone(e.node, (uint32_t)e.arg);
+        break;
+    case RETRANSMIT:
+        onRetransmit(e.node, e.arg);
+        break;
+    }
+}
+
+void MeshSimulator::setTransmitDelay(uint16_t n)
+{
+    Node &node = nodes[n];
+    if (node.txQueue.empty() || node.txTimerArmed)
+        return;
+
+    // RadioLibInterface::setTransmitDelay
+    SimFrame &f = node.txQueue.front();
+    uint8_t CWsize = RadioInterface::getCWsize(getTxDelaySnr(node, f), node.contention);
+    uint32_t delayMsec = (f.rxSnr == 0)
+                             ? RadioInterface::getTxDelayMsec(node.channelShort.percent(nowMsec), node.contention, slotTimeMsec)
+                             : RadioInterface::getTxDelayMsecWeighted(CWsize, node.spec.role, slotTimeMsec);
+    uint32_t atMsec = nowMsec + delayMsec;
+    if (f.txAfterMsec) {
+        uint32_t worstMsec = RadioInterface::getTxDelayMsecWeightedWorst(CWsize, slotTimeMsec);
+        atMsec = f.txAfterMsec = RadioInterface::getLateTxAfter(f.txAfterMsec, nowMsec, delayMsec, worstMsec);
+    }
+    node.txTimerArmed = true;
+    schedule(atMsec, TX_TIMER, n);
+}
+
+void MeshSimulator::onTxTimer(uint16_t n)
+{
+    Node &node = nodes[n];
+    node.txTimerArmed = false;
+    if (node.txQueue.empty())
+        return;
+
+    // Busy transmitting: restart the random delay
+    if (channel.isTransmitting(n, nowMsec)) {
+        setTransmitDelay(n);
+        return;
+    }
+
+    // Still waiting out the late rebroadcast window
+    if (node.txQueue.front().txAfterMsec > nowMsec) {
+        node.txTimerArmed = true;
+        schedule(node.txQueue.front().txAfterMsec, TX_TIMER, n);
+        return;
+    }
+
+    // CAD sees a preamble: back off and try again later
+    if (channel.isChannelActive(n, nowMsec)) {
+        node.stats.cadBusy++;
+        node.contention.onChannelBusy();
+        setTransmitDelay(n);
+        return;
+    }
+
+    SimFrame f = node.txQueue.front();
+    node.txQueue.pop_front();
+
+    uint32_t airtime = getPacketTime(f.payloadLen);
+    uint32_t txId = nextTxId++;
+    inFlight[txId] = {n, f};
+    channel.startTx(n, txId, nowMsec, nowMsec + airtime);
+
+    node.stats.txAirtimeMsec += airtime;
+    totalAirtimeMsec += airtime;
+    logAirtime(n, airtime);
+    node.contention.onTxClean();
+
+    schedule(nowMsec + airtime, TX_DONE, n, txId);
+}
+
+void MeshSimulator::onTxDone(uint16_t n, uint32_t txId)
+{
+    auto it = inFlight.find(txId);
+    assert(it != inFlight.end());
+    SimFrame f = it->second.frame;
+    inFlight.erase(it);
+
+    Node &node = nodes[n];
+    node.stats.txGood++;
+    if (f.header.from != node.spec.num)
+        node.stats.txRelay++;
+
+    uint32_t airtime = getPacketTime(f.payloadLen);
+    for (const auto &d : channel.endTx(n, txId)) {
+        // Like RX_ALL_LOG, the channel was busy for this node whether or not it could decode the frame
+        logAirtime(d.node, airtime);
+        nodes[d.node].stats.rxAirtimeMsec += airtime;
+        if (d.collided) {
+            nodes[d.node].stats.rxBad++;
+            nodes[d.node].contention.onCrcError();
+        }
+        if (!d.ok)
+            continue;
+
+        SimFrame copy = f;
+        copy.rxSnr = d.snr;
+        copy.txAfterMsec = 0;
+        bool isDirect = f.hopStart() != 0 && f.hopStart() == f.hopLimit();
+        nodes[d.node].links.onReceive(f.header.relay_node, isDirect ? f.header.from : 0, d.snr, 0, nowMsec);
+        handleReceived(d.node, copy);
+        setTransmitDelay(d.node);
+    }
+
+    setTransmitDelay(n);
+}
+
+uint32_t MeshSimulator::getRetransmissionMsec(uint16_t n, const SimFrame &f)
+{
+    return RadioInterface::getRetransmissionMsec(getPacketTime(f.payloadLen), channelUtilizationPercent(n), nodes[n].contention,
+                                                 slotTimeMsec);
+}
+
+void MeshSimulator::logAirtime(uint16_t n, uint32_t airtimeMsec)
+{
+    Node &node = nodes[n];
+    uint32_t period = nowMsec / 10000;
+    if (period - node.utilPeriod >= CHANNEL_UTILIZATION_PERIODS) {
+        memset(node.utilization, 0, sizeof(node.utilization));
+        node.utilPeriod = period;
+    }
+    while (node.utilPeriod < period) {
+        node.utilPeriod++;
+        node.utilization[node.utilPeriod % CHANNEL_UTILIZATION_PERIODS] = 0;
+    }
+    node.utilization[period % CHANNEL_UTILIZATION_PERIODS] += airtimeMsec;
+    if (airtimeMsec)
+        node.channelShort.add(nowMsec, airtimeMsec);
+}
+
+/** As MeshPacketQueue, packets in the late rebroadcast window go after all the others */
+void MeshSimulator::enqueue(uint16_t n, const SimFrame &f)
+{
+    auto &q = nodes[n].txQueue;
+    auto it = q.end();
+    if (!f.txAfterMsec) {
+        while (it != q.begin() && std::prev(it)->txAfterMsec)
+            --it;
+    }
+    q.insert(it, f);
+}
+
+bool MeshSimulator::cancelSending(uint16_t n, NodeNum from, PacketId id)
+{
+    auto &q = nodes[n].txQueue;
+    for (auto it = q.begin(); it != q.end(); ++it) {
+        if (it->header.from == from && it->header.id == id) {
+            q.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MeshSimulator::findInTxQueue(uint16_t n, NodeNum from, PacketId id)
+{
+    for (const auto &f : nodes[n].txQueue) {
+        if (f.header.from == from && f.header.id == id)
+            return true;
+    }
+    return false;
+}
+
+float MeshSimulator::getTxDelaySnr(const Node &node, const SimFrame &f) const
+{
+    // RadioInterface::getTxDelaySnr
+    return node.links.getRelayWeightSnr(f.header.from, RadioInterface::wasHeardFromSender(f.hopStart(), f.hopLimit()), f.rxSnr);
+}
+
+void MeshSimulator::clampToLateRebroadcastWindow(uint16_t n, NodeNum from, PacketId id)
+{
+    Node &node = nodes[n];
+    auto &q = node.txQueue;
+    for (auto it = q.begin(); it != q.end(); ++it) {
+        // Look for non-late packets only, so we don't do this twice
+        if (it->header.from == from && it->header.id == id && !it->txAfterMsec) {
+            SimFrame f = *it;
+            q.erase(it);
+            uint8_t CWsize = RadioInterface::getCWsize(getTxDelaySnr(node, f), node.contention);
+            f.txAfterMsec = nowMsec + RadioInterface::getTxDelayMsecWeightedWorst(CWsize, slotTimeMsec);
+            enqueue(n, f);
+            return;
+        }
+    }
+}
+
+void MeshSimulator::handleReceived(uint16_t n, SimFrame f)
+{
+    Node &node = nodes[n];
+    const NodeNum us = node.spec.num;
+    node.stats.rxGood++;
+
+    if (f.header.from == us) {
+        // Someone relayed our own packet, it still counts as seen (implicit ACK for broadcasts)
+        node.stats.rxDupe++;
+        stopRetransmission(n, f.header.from, f.header.id);
+        return;
+    }
+
+    // PacketHistory::wasSeenRecently
+    auto found = node.history.find(key(f.header.from, f.header.id));
+    if (found != node.history.end()) {
+        HistoryRecord &r = found->second;
+        bool weWereNextHop = r.nextHop == node.relayId;
+        bool wasFallback =
+            PacketHistory::isFallbackToFlooding(r.nextHop, r.relayedBy, f.header.next_hop, f.header.relay_node, node.relayId);
+        for (uint8_t i = NUM_RELAYERS - 1; i > 0; i--)
+            r.relayedBy[i] = r.relayedBy[i - 1];
+        r.relayedBy[0] = f.header.relay_node;
+
+        // NextHopRouter::shouldFilterReceived
+        node.stats.rxDupe++;
+        auto pending = node.pending.find(key(f.header.from, f.header.id));
+        if (pending != node.pending.end() && pending->second.frame.header.next_hop != NO_NEXT_HOP_PREFERENCE &&
+            pending->second.frame.header.next_hop == f.header.relay_node)
+            node.links.onDelivered(f.header.relay_node); // NextHopRouter::noteRelayed
+        stopRetransmission(n, f.header.from, f.header.id);
+        switch (NextHopRouter::getDupeAction(wasFallback, weWereNextHop, f.hopStart(), f.hopLimit())) {
+        case NextHopRouter::DUPE_RELAY_AGAIN:
+            if (!findInTxQueue(n, f.header.from, f.header.id))
+                perhapsRelay(n, f);
+            break;
+        case NextHopRouter::DUPE_RELAY_OR_ACK_AGAIN:
+            if (!findInTxQueue(n, f.header.from, f.header.id) && !perhapsRelay(n, f) && f.header.to == us && f.wantAck())
+                sendAck(n, f);
+            break;
+        case NextHopRouter::DUPE_CANCEL:
+            perhapsCancelDupe(n, f);
+            break;
+        case NextHopRouter::DUPE_IGNORE:
+            break;
+        }
+        return;
+    }
+    node.history[key(f.header.from, f.header.id)] = {f.header.next_hop, {f.header.relay_node, 0, 0}};
+
+    // Delivery bookkeeping for the packets we track
+    bool forUs = f.header.to == us || f.header.to == NODENUM_BROADCAST;
+    if (f.requestId == 0 && forUs) {
+        auto p = packetIndex.find(key(f.header.from, f.header.id));
+        if (p != packetIndex.end())
+            packets[p->second].latenciesMsec.push_back(nowMsec - f.originMsec);
+    }
+
+    // NextHopRouter::sniffReceived
+    if (f.requestId != 0) {
+        if (NextHopRouter::shouldLearnNextHop(wasRelayer(node, f.header.relay_node, f.requestId, f.header.to),
+                                              wasRelayer(node, node.relayId, f.requestId, f.header.to), f.hopStart(),
+                                              f.hopLimit())) {
+            node.links.onDelivered(f.header.relay_node);
+            node.nextHops[f.header.from] = f.header.relay_node;
+        }
+        if (f.header.to != us) {
+            cancelSending(n, f.header.to, f.requestId);
+            stopRetransmission(n, f.header.to, f.requestId);
+        } else {
+            auto p = packetIndex.find(key(us, f.requestId));
+            if (p != packetIndex.end())
+                packets[p->second].acked = true;
+            stopRetransmission(n, us, f.requestId);
+        }
+    }
+
+    perhapsRelay(n, f);
+
+    if (f.header.to == us && f.wantAck())
+        sendAck(n, f);
+}
+
+void MeshSimulator::sendFrame(uint16_t n, SimFrame f, bool flood)
+{
+    Node &node = nodes[n];
+    f.header.relay_node = node.relayId;
+
+    // NextHopRouter::getNextHop
+    f.header.next_hop = NO_NEXT_HOP_PREFERENCE;
+    if (!flood && f.header.to != NODENUM_BROADCAST) {
+        auto nh = node.nextHops.find(f.header.to);
+        if (nh != node.nextHops.end())
+            f.header.next_hop = NextHopRouter::chooseNextHop(nh->second, f.header.relay_node, node.links, nowMsec);
+    }
+
+    auto &r = node.history[key(f.header.from, f.header.id)];
+    if (r.nextHop == NO_NEXT_HOP_PREFERENCE && r.relayedBy[0] == 0)
+        r.nextHop = f.header.next_hop;
+    for (uint8_t i = NUM_RELAYERS - 1; i > 0; i--)
+        r.relayedBy[i] = r.relayedBy[i - 1];
+    r.relayedBy[0] = node.relayId;
+
+    bool fromUs = f.header.from == node.spec.num;
+    if (!flood && NextHopRouter::needsRetransmission(fromUs, f.wantAck(), f.header.next_hop, f.hopLimit()))
+        startRetransmission(n, f, NextHopRouter::NUM_INTERMEDIATE_RETX);
+
+    enqueue(n, f);
+    setTransmitDelay(n);
+}
+
+bool MeshSimulator::perhapsRelay(uint16_t n, const SimFrame &f)
+{
+    Node &node = nodes[n];
+    if (!NextHopRouter::isForUsToRelay(f.header.to == node.spec.num, f.header.from == node.spec.num, f.hopLimit(),
+                                       f.header.next_hop, node.relayId) ||
+        !FloodingRouter::isRebroadcaster(node.spec.role, meshtastic_Config_DeviceConfig_RebroadcastMode_ALL))
+        return false;
+
+    SimFrame tosend = f;
+    tosend.setHopLimit(f.hopLimit() - 1);
+    sendFrame(n, tosend, false);
+    return true;
+}
+
+void MeshSimulator::perhapsCancelDupe(uint16_t n, const SimFrame &f)
+{
+    // FloodingRouter::perhapsCancelDupe
+    Node &node = nodes[n];
+    node.contention.onDuplicate();
+    if (node.suppressor.onDuplicate(f.header.from, f.header.id, f.header.relay_node,
+                                    FloodingRouter::isRouterRole(node.spec.role)) &&
+        cancelSending(n, f.header.from, f.header.id)) {
+        node.stats.txRelayCanceled++;
+        return;
+    }
+    if (node.spec.role == meshtastic_Config_DeviceConfig_Role_ROUTER_LATE)
+        clampToLateRebroadcastWindow(n, f.header.from, f.header.id);
+}
+
+bool MeshSimulator::wasRelayer(const Node &node, uint8_t relayer, PacketId id, NodeNum from) const
+{
+    if (relayer == 0)
+        return false;
+    auto r = node.history.find(key(from, id));
+    if (r == node.history.end())
+        return false;
+    for (uint8_t i = 0; i < NUM_RELAYERS; i++) {
+        if (r->second.relayedBy[i] == relayer)
+            return true;
+    }
+    return false;
+}
+
+void MeshSimulator::startRetransmission(uint16_t n, const SimFrame &f, uint8_t numReTx)
+{
+    uint64_t k = key(f.header.from, f.header.id);
+    auto &p = nodes[n].pending[k];
+    p.frame = f;
+    p.numRetransmissions = numReTx - 1; // We assume the first send is happening right now
+    p.nextTxMsec = nowMsec + getRetransmissionMsec(n, f);
+    schedule(p.nextTxMsec, RETRANSMIT, n, k);
+}
+
+bool MeshSimulator::stopRetransmission(uint16_t n, NodeNum from, PacketId id)
+{
+    Node &node = nodes[n];
+    auto it = node.pending.find(key(from, id));
+    if (it == node.pending.end())
+        return false;
+
+    if (NextHopRouter::cancelsQueuedOnStop(it->second.numRetransmissions, from == node.spec.num, node.spec.role))
+        cancelSending(n, from, id);
+    node.pending.erase(it);
+    return true;
+}
+
+void MeshSimulator::onRetransmit(uint16_t n, uint64_t k)
+{
+    Node &node = nodes[n];
+    auto it = node.pending.find(k);
+    if (it == node.pending.end() || it->second.nextTxMsec != nowMsec)
+        return; // Stopped, or rescheduled since
+
+    PendingRetransmission &p = it->second;
+    if (p.numRetransmissions == 0) {
+        stopRetransmission(n, p.frame.header.from, p.frame.header.id);
+        return;
+    }
+
+    SimFrame f = p.frame;
+    f.header.relay_node = node.relayId;
+    if (f.header.to != NODENUM_BROADCAST && p.numRetransmissions == 1) {
+        // Last retransmission, fall back to flooding
+        if (f.header.next_hop != NO_NEXT_HOP_PREFERENCE)
+            node.links.onFailed(f.header.next_hop);
+        node.nextHops.erase(f.header.to);
+        f.header.next_hop = NO_NEXT_HOP_PREFERENCE;
+        p.frame.header.next_hop = NO_NEXT_HOP_PREFERENCE;
+    } else if (f.header.to != NODENUM_BROADCAST) {
+        auto nh = node.nextHops.find(f.header.to);
+        f.header.next_hop = (nh != node.nextHops.end())
+                                ? NextHopRouter::chooseNextHop(nh->second, f.header.relay_node, node.links, nowMsec)
+                                : NO_NEXT_HOP_PREFERENCE;
+    }
+    enqueue(n, f);
+    setTransmitDelay(n);
+
+    p.numRetransmissions--;
+    p.nextTxMsec = nowMsec + getRetransmissionMsec(n, f);
+    schedule(p.nextTxMsec, RETRANSMIT, n, k);
+}
+
+void MeshSimulator::sendAck(uint16_t n, const SimFrame &request)
+{
+    uint8_t hopLimit = RoutingModule::getHopLimitForResponse(request.hopStart(), request.hopLimit(), config.hopLimit);
+
+    SimFrame ack;
+    memset(&ack.header, 0, sizeof(ack.header));
+    ack.header.from = nodes[n].spec.num;
+    ack.header.to = request.header.from;
+    do {
+        ack.header.id = rng();
+    } while (ack.header.id == 0);
+    ack.header.flags = hopLimit | ((hopLimit << PACKET_FLAGS_HOP_START_SHIFT) & PACKET_FLAGS_HOP_START_MASK);
+    ack.payloadLen = ACK_PAYLOAD_LEN;
+    ack.requestId = request.header.id;
+    ack.kind = request.kind;
+    ack.originMsec = nowMsec;
+    sendFrame(n, ack, false);
+}
+
+#endif
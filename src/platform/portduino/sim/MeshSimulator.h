@@ -0,0 +1,232 @@
+#pragma once
+
+#include "configuration.h"
+
+#if ARCH_PORTDUINO
+#include "ContentionController.h"
+#include "LinkQualityTable.h"
+#include "MeshTypes.h"
+#include "NextHopRouter.h"
+#include "PacketHistory.h"
+#include "RadioInterface.h"
+#include "RebroadcastSuppressor.h"
+#include "SimChannel.h"
+#include "airtime.h"
+
+#include <deque>
+#include <queue>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * A frame on the simulated air: the real wire header, plus the few fields the routers need which would normally be inside the
+ * encrypted payload.
+ */
+struct SimFrame {
+    PacketHeader header;
+    uint8_t payloadLen = 0;   // Encrypted payload bytes, excluding the header
+    PacketId requestId = 0;   // Non-zero for ACKs and replies
+    uint8_t kind = 0;         // Traffic class, only used for statistics
+    float rxSnr = 0;          // SNR we heard this copy with, 0 if generated locally
+    uint32_t originMsec = 0;  // When the original sender queued it
+    uint32_t txAfterMsec = 0; // As tx_after, non-zero while it waits in the ROUTER_LATE rebroadcast window
+
+    uint8_t hopLimit() const { return header.flags & PACKET_FLAGS_HOP_LIMIT_MASK; }
+    uint8_t hopStart() const { return (header.flags & PACKET_FLAGS_HOP_START_MASK) >> PACKET_FLAGS_HOP_START_SHIFT; }
+    bool wantAck() const { return header.flags & PACKET_FLAGS_WANT_ACK_MASK; }
+    void setHopLimit(uint8_t hops)
+    {
+        header.flags = (header.flags & ~PACKET_FLAGS_HOP_LIMIT_MASK) | (hops & PACKET_FLAGS_HOP_LIMIT_MASK);
+    }
+};
+
+/**
+ * One node in the simulated mesh
+ */
+struct SimNodeSpec {
+    NodeNum num = 0;
+    SimPlacement placement;
+    meshtastic_Config_DeviceConfig_Role role = meshtastic_Config_DeviceConfig_Role_CLIENT;
+};
+
+/**
+ * Per node debugging counts, named after their RadioLibInterface / Router counterparts
+ */
+struct SimNodeStats {
+    uint32_t txGood = 0, txRelay = 0, txRelayCanceled = 0, rxGood = 0, rxBad = 0, rxDupe = 0;
+    uint32_t cadBusy = 0;       // Times a send was deferred because the channel was busy
+    uint32_t txAirtimeMsec = 0; // Total time on air
+    uint32_t rxAirtimeMsec = 0; // Total time spent hearing other nodes, decodable or not
+};
+
+/**
+ * What happened to one packet a node originated (ACKs are not tracked here)
+ */
+struct SimPacketRecord {
+    NodeNum from = 0, to = 0;
+    PacketId id = 0;
+    uint8_t kind = 0;
+    uint8_t payloadLen = 0;
+    bool wantAck = false;
+    uint32_t originMsec = 0;
+    bool acked = false;                  // The original sender received an ACK
+    std::vector<uint32_t> latenciesMsec; // One entry per node which received it (only the destination, if not a broadcast)
+};
+
+/**
+ * Deterministic discrete-event mesh simulator for portduino.
+ *
+ * SimRadio tunnels a single node to an external simulator; this instead runs many nodes in one process against a shared
+ * SimChannel.  The firmware Router and NodeDB are singletons, so each simulated node keeps its own packet history, next hops,
+ * link estimates and TX queue, and takes every decision through the same static rules the firmware uses: the delays of
+ * RadioInterface, duplicate handling, relaying and next-hop choice of FloodingRouter / NextHopRouter, the fallback detection
+ * of PacketHistory and the response hop limit of RoutingModule.
+ *
+ * Time is virtual: nothing sleeps, events are processed in (time, insertion) order and all randomness comes from seeded
+ * generators, so a run with the same seed always gives the same result.
+ */
+class MeshSimulator
+{
+  public:
+    struct Config {
+        // LongFast by default
+        float bw = 250;
+        uint8_t sf = 11;
+        uint8_t cr = 5;
+        uint16_t preambleLength = 16;
+        uint8_t hopLimit = HOP_RELIABLE;
+        uint32_t seed = 1;
+        ContentionController::Mode contentionMode = ContentionController::CONTENTION_FIXED;
+        RebroadcastSuppressor::Mode suppressionMode = RebroadcastSuppressor::SUPPRESS_FIRST_DUPLICATE;
+        SimChannel::Params channel;
+    };
+
+    explicit MeshSimulator(const Config &config);
+
+    /** Add a node, must be done before the first send. @return its index */
+    uint16_t addNode(const SimNodeSpec &spec);
+    size_t numNodes() const { return nodes.size(); }
+
+    /**
+     * Have node originate a packet at virtual time atMsec (which must not be in the past)
+     * @return the packet id
+     */
+    PacketId send(uint16_t node, NodeNum to, uint8_t payloadLen, bool wantAck, uint32_t atMsec, uint8_t kind = 0);
+
+    /** Process all events up to and including untilMsec, then advance the clock to it */
+    void runUntil(uint32_t untilMsec);
+
+    /** Process events until none are left or limitMsec is reached. @return true if the mesh went idle */
+    bool runUntilIdle(uint32_t limitMsec);
+
+    /** The virtual clock */
+    uint32_t millis() const { return nowMsec; }
+
+    /** Airtime of a frame with payloadLen bytes after the header, for our modem settings */
+    uint32_t getPacketTime(uint8_t payloadLen) const;
+
+    /** Same computation as AirTime::channelUtilizationPercent, from node's point of view */
+    float channelUtilizationPercent(uint16_t node);
+
+    const std::vector<SimPacketRecord> &getPackets() const { return packets; }
+    const SimNodeStats &getNodeStats(uint16_t node) const { return nodes[node].stats; }
+    const SimNodeSpec &getNodeSpec(uint16_t node) const { return nodes[node].spec; }
+    const SimChannel &getChannel() const { return channel; }
+    uint32_t getTotalAirtimeMsec() const { return totalAirtimeMsec; }
+
+  private:
+    static constexpr uint8_t CHANNEL_UTILIZATION_PERIODS = 6; // As in AirTime, 10 seconds each
+    static constexpr uint8_t ACK_PAYLOAD_LEN = 12;            // A Routing message carrying just the request id
+
+    struct HistoryRecord {
+        uint8_t nextHop;
+        uint8_t relayedBy[NUM_RELAYERS];
+    };
+
+    struct PendingRetransmission {
+        SimFrame frame;
+        uint32_t nextTxMsec;
+        uint8_t numRetransmissions;
+    };
+
+    struct Node {
+        SimNodeSpec spec;
+        uint8_t relayId;
+        std::unordered_map<uint64_t, HistoryRecord> history;
+        std::unordered_map<NodeNum, uint8_t> nextHops;
+        std::deque<SimFrame> txQueue;
+        bool txTimerArmed = false;
+        std::unordered_map<uint64_t, PendingRetransmission> pending;
+        uint32_t utilization[CHANNEL_UTILIZATION_PERIODS] = {0};
+        uint32_t utilPeriod = 0;
+        DecayingUtilization channelShort = DecayingUtilization(CHANNEL_UTIL_SHORT_MSEC);
+        LinkQualityTable links;
+        ContentionController contention;
+        RebroadcastSuppressor suppressor;
+        SimNodeStats stats;
+    };
+
+    enum EventType : uint8_t { ORIGINATE, TX_TIMER, TX_DONE, RETRANSMIT };
+
+    struct Event {
+        uint32_t atMsec;
+        uint64_t seq; // Tie-breaker, keeps the order of same-time events deterministic
+        EventType type;
+        uint16_t node;
+        uint64_t arg;
+
+        bool operator>(const Event &o) const { return atMsec != o.atMsec ? atMsec > o.atMsec : seq > o.seq; }
+    };
+
+    struct InFlight {
+        uint16_t node;
+        SimFrame frame;
+    };
+
+    static uint64_t key(NodeNum from, PacketId id) { return ((uint64_t)from << 32) | id; }
+
+    Config config;
+    SimChannel channel;
+    std::vector<Node> nodes;
+    std::unordered_map<NodeNum, uint16_t> nodeIndex;
+    std::vector<SimPacketRecord> packets;
+    std::unordered_map<uint64_t, uint32_t> packetIndex;
+    std::unordered_map<uint32_t, InFlight> inFlight;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+    std::mt19937 rng;
+    uint32_t nowMsec = 0;
+    uint64_t nextSeq = 0;
+    uint32_t nextTxId = 1;
+    uint32_t slotTimeMsec;
+    uint32_t totalAirtimeMsec = 0;
+    bool built = false;
+
+    void schedule(uint32_t atMsec, EventType type, uint16_t node, uint64_t arg = 0);
+    void dispatch(const Event &e);
+
+    // Radio side, after RadioLibInterface
+    void setTransmitDelay(uint16_t n);
+    float getTxDelaySnr(const Node &node, const SimFrame &f) const;
+    void onTxTimer(uint16_t n);
+    void onTxDone(uint16_t n, uint32_t txId);
+    uint32_t getRetransmissionMsec(uint16_t n, const SimFrame &f);
+    void logAirtime(uint16_t n, uint32_t airtimeMsec);
+    void enqueue(uint16_t n, const SimFrame &f);
+    bool cancelSending(uint16_t n, NodeNum from, PacketId id);
+    bool findInTxQueue(uint16_t n, NodeNum from, PacketId id);
+    void clampToLateRebroadcastWindow(uint16_t n, NodeNum from, PacketId id);
+
+    // Router side, after FloodingRouter / NextHopRouter / ReliableRouter
+    void handleReceived(uint16_t n, SimFrame f);
+    void sendFrame(uint16_t n, SimFrame f, bool flood);
+    bool perhapsRelay(uint16_t n, const SimFrame &f);
+    void perhapsCancelDupe(uint16_t n, const SimFrame &f);
+    bool wasRelayer(const Node &node, uint8_t relayer, PacketId id, NodeNum from) const;
+    void startRetransmission(uint16_t n, const SimFrame &f, uint8_t numReTx);
+    bool stopRetransmission(uint16_t n, NodeNum from, PacketId id);
+    void onRetransmit(uint16_t n, uint64_t k);
+    void sendAck(uint16_t n, const SimFrame &request);
+};
+
+#endif
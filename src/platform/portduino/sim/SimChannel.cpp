@@ -0,0 +1,102 @@
+#include "SimChannel.h"
+
+#if ARCH_PORTDUINO
+#include <algorithm>
+#include <math.h>
+
+void SimChannel::build(const std::vector<SimPlacement> &nodes, uint8_t sf, const Params &p)
+{
+    params = p;
+    floorSnr = snrFloor(sf);
+    links.assign(nodes.size(), {});
+    radios.assign(nodes.size(), {});
+
+    for (uint16_t from = 0; from < nodes.size(); from++) {
+        for (uint16_t to = 0; to < nodes.size(); to++) {
+            if (from == to)
+                continue;
+
+            float dx = nodes[from].x - nodes[to].x;
+            float dy = nodes[from].y - nodes[to].y;
+            float distance = std::max(sqrtf(dx * dx + dy * dy), 1.0f);
+            float loss = params.refLossDb + 10.0f * params.pathLossExponent * log10f(distance);
+            float rssi = nodes[from].txPowerDbm - loss;
+            float snr = rssi - params.noiseFloorDbm;
+
+            if (snr >= floorSnr)
+                links[from].push_back({to, snr, rssi});
+        }
+    }
+}
+
+void SimChannel::startTx(uint16_t node, uint32_t txId, uint32_t nowMsec, uint32_t endMsec)
+{
+    Radio &sender = radios[node];
+    sender.txUntilMsec = endMsec;
+
+    // Half-duplex: whatever we were hearing is gone
+    for (auto &r : sender.receiving) {
+        if (r.ok) {
+            r.ok = false;
+            halfDuplexLost++;
+        }
+    }
+
+    for (const Link &l : links[node]) {
+        Radio &rx = radios[l.node];
+
+        // Drop receptions which finished already, so they can't collide with us
+        rx.receiving.erase(std::remove_if(rx.receiving.begin(), rx.receiving.end(),
+                                          [nowMsec](const Reception &r) { return r.endMsec <= nowMsec; }),
+                           rx.receiving.end());
+
+        Reception incoming = {txId, endMsec, l.rssi, l.snr, true, false};
+        if (rx.txUntilMsec > nowMsec) {
+            incoming.ok = false;
+            halfDuplexLost++;
+        }
+
+        for (auto &r : rx.receiving) {
+            if (incoming.rssi - r.rssi < params.captureThresholdDb && incoming.ok) {
+                incoming.ok = false;
+                incoming.collided = true;
+                collisions++;
+            }
+            if (r.rssi - incoming.rssi < params.captureThresholdDb && r.ok) {
+                r.ok = false;
+                r.collided = true;
+                collisions++;
+            }
+        }
+        rx.receiving.push_back(incoming);
+    }
+}
+
+std::vector<SimChannel::Delivery> SimChannel::endTx(uint16_t node, uint32_t txId)
+{
+    std::vector<Delivery> delivered;
+
+    for (const Link &l : links[node]) {
+        auto &receiving = radios[l.node].receiving;
+        for (auto it = receiving.begin(); it != receiving.end(); ++it) {
+            if (it->txId == txId) {
+                delivered.push_back({l.node, it->snr, it->rssi, it->ok, it->collided});
+                receiving.erase(it);
+                break;
+            }
+        }
+    }
+
+    return delivered;
+}
+
+bool SimChannel::isChannelActive(uint16_t node, uint32_t nowMsec) const
+{
+    for (const auto &r : radios[node].receiving) {
+        if (r.endMsec > nowMsec)
+            return true;
+    }
+    return false;
+}
+
+#endif
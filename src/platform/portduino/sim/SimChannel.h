@@ -0,0 +1,106 @@
+#pragma once
+
+#include "configuration.h"
+
+#if ARCH_PORTDUINO
+#include <stdint.h>
+#include <vector>
+
+/**
+ * Where a simulated node sits and how loud it is
+ */
+struct SimPlacement {
+    float x = 0; // metres
+    float y = 0; // metres
+    int8_t txPowerDbm = 20;
+};
+
+/**
+ * A shared virtual LoRa channel for MeshSimulator.
+ *
+ * Models log-distance path loss (so SNR falls off with distance), half-duplex radios, collisions with capture effect, and
+ * what channel activity detection (CAD) would report at each node.  All state is explicit, nothing here reads the clock.
+ */
+class SimChannel
+{
+  public:
+    struct Params {
+        float refLossDb = 32.0f;         // Path loss at 1 m, roughly free space at 900 MHz
+        float pathLossExponent = 3.0f;   // 2 is free space, 3 to 3.5 for suburban and urban clutter
+        float noiseFloorDbm = -117.0f;   // Thermal noise for 250 kHz plus a typical receiver noise figure
+        float captureThresholdDb = 6.0f; // A frame survives an overlap if it is this much stronger than the other one
+    };
+
+    /** A node which can hear another one, and how well */
+    struct Link {
+        uint16_t node;
+        float snr;
+        float rssi;
+    };
+
+    /** A frame as it ended at one receiver */
+    struct Delivery {
+        uint16_t node;
+        float snr;
+        float rssi;
+        bool ok;       // false if it was lost to a collision or the receiver transmitting
+        bool collided; // Lost to an overlapping frame, so the receiver would have seen a CRC error
+    };
+
+    /** Demodulation floor for a spreading factor, per the SX126x datasheet */
+    static float snrFloor(uint8_t sf) { return -7.5f - 2.5f * (sf - 7); }
+
+    /**
+     * Compute all links between nodes. Call once the topology is complete and before any traffic.
+     */
+    void build(const std::vector<SimPlacement> &nodes, uint8_t sf, const Params &params);
+
+    /** Nodes within reception range of node */
+    const std::vector<Link> &neighbours(uint16_t node) const { return links[node]; }
+
+    /**
+     * node starts transmitting frame txId, lasting until endMsec.  Anything the sender was in the middle of receiving is lost,
+     * and every node in range starts receiving it (colliding with whatever they were already receiving).
+     */
+    void startTx(uint16_t node, uint32_t txId, uint32_t nowMsec, uint32_t endMsec);
+
+    /**
+     * Transmission txId from node has finished.
+     * @return every receiver in range, and whether it decoded the frame
+     */
+    std::vector<Delivery> endTx(uint16_t node, uint32_t txId);
+
+    /** Would CAD on node see a LoRa preamble right now? */
+    bool isChannelActive(uint16_t node, uint32_t nowMsec) const;
+
+    /** Is node currently transmitting? */
+    bool isTransmitting(uint16_t node, uint32_t nowMsec) const { return radios[node].txUntilMsec > nowMsec; }
+
+    /**
+     * Debugging counts
+     */
+    uint32_t collisions = 0;     // Receptions lost to an overlapping frame
+    uint32_t halfDuplexLost = 0; // Receptions lost because the receiver was (or started) transmitting
+
+  private:
+    struct Reception {
+        uint32_t txId;
+        uint32_t endMsec;
+        float rssi;
+        float snr;
+        bool ok;
+        bool collided;
+    };
+
+    struct Radio {
+        uint32_t txUntilMsec = 0;
+        std::vector<Reception> receiving;
+    };
+
+    Params params;
+    float floorSnr = 0;
+    std::vector<std::vector<Link>> links;
+    std::vector<Radio> radios;
+};
+
+#endif
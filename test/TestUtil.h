@@ -1,4 +1,32 @@
 #pragma once
 
+#include <stdint.h>
+
 // Initialize testing environment.
-void initializeTestEnvironment();
\ No newline at end of file
+void initializeTestEnvironment();
+
+/**
+ * A seeded linear congruential generator, so randomised tests see the same numbers on every run and platform
+ */
+class TestRandom
+{
+  public:
+    explicit TestRandom(uint32_t seed = 1) : state(seed) {}
+
+    void seed(uint32_t s) { state = s; }
+
+    /// 24 random bits, the low bits of an LCG being poor
+    uint32_t next() { return step() >> 8; }
+
+    /// Uniform in [-1, 1)
+    double uniform() { return (int32_t)step() / 2147483648.0; }
+
+  private:
+    uint32_t state;
+
+    uint32_t step()
+    {
+        state = state * 1664525 + 1013904223;
+        return state;
+    }
+};
@@ -0,0 +1,80 @@
+#include "TestUtil.h"
+#include "airtime.h"
+#include <math.h>
+#include <unity.h>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_idleChannelIsZero()
+{
+    DecayingUtilization util(CHANNEL_UTIL_SHORT_MSEC);
+    TEST_ASSERT_EQUAL_FLOAT(0, util.percent(0));
+    TEST_ASSERT_EQUAL_FLOAT(0, util.percent(100000));
+}
+
+void test_steadyDutyCycleConverges()
+{
+    DecayingUtilization full(CHANNEL_UTIL_SHORT_MSEC), half(CHANNEL_UTIL_SHORT_MSEC);
+    uint32_t now = 0;
+    for (int i = 0; i < 300; i++) { // Ten time constants
+        now += 1000;
+        full.add(now, 1000);
+        half.add(now, 500);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.1, 100, full.percent(now));
+    // Just over 50%, as each busy half second ends at the moment it is logged
+    TEST_ASSERT_FLOAT_WITHIN(0.5, 50, half.percent(now));
+}
+
+void test_decaysByOneTimeConstant()
+{
+    DecayingUtilization util(CHANNEL_UTIL_SHORT_MSEC);
+    util.add(10000, 3000);
+    float start = util.percent(10000);
+    // 3 s of a 30 s window, less the part of it which has already decayed
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 100 * (1 - expf(-0.1f)), start);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, start * expf(-1), util.percent(10000 + CHANNEL_UTIL_SHORT_MSEC));
+
+    // Adding nothing only decays it, the same as reading it later
+    util.add(10000 + CHANNEL_UTIL_SHORT_MSEC, 0);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, start * expf(-2), util.percent(10000 + 2 * CHANNEL_UTIL_SHORT_MSEC));
+}
+
+void test_shortWindowFollowsBurstsLongWindowRemembers()
+{
+    DecayingUtilization shortUtil(CHANNEL_UTIL_SHORT_MSEC), longUtil(CHANNEL_UTIL_LONG_MSEC);
+    shortUtil.add(1000, 3000);
+    longUtil.add(1000, 3000);
+
+    // A single 3 s burst fills a lot more of the short window
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 9.52, shortUtil.percent(1000));
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 0.50, longUtil.percent(1000));
+
+    // Two minutes later the short window has forgotten it, the long one hasn't
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 0.17, shortUtil.percent(121000));
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 0.41, longUtil.percent(121000));
+}
+
+void test_neverOverOneHundred()
+{
+    DecayingUtilization util(CHANNEL_UTIL_SHORT_MSEC);
+    // Overlapping airtime, e.g. our own TX logged while something was also received
+    util.add(1000, 60000);
+    util.add(1000, 60000);
+    TEST_ASSERT_EQUAL_FLOAT(100, util.percent(1000));
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+    UNITY_BEGIN();
+    RUN_TEST(test_idleChannelIsZero);
+    RUN_TEST(test_steadyDutyCycleConverges);
+    RUN_TEST(test_decaysByOneTimeConstant);
+    RUN_TEST(test_shortWindowFollowsBurstsLongWindowRemembers);
+    RUN_TEST(test_neverOverOneHundred);
+    exit(UNITY_END());
+}
+
+void loop() {}
@@ -176,6 +176,14 @@ void test_AES_CTR(void)
     HexToBytes(expected, "E4095D4FB7A7B3792D6175A3261311B8");
     crypto->encryptAESCtr(k, nonce, 16, plain);
     TEST_ASSERT_EQUAL_MEMORY(expected, plain, 16);
+
+    // Into a separate buffer, leaving the input as it was
+    uint8_t out[16];
+    memcpy(plain, "Single block msg", 16);
+    HexToBytes(nonce, "00000030000000000000000000000001");
+    crypto->encryptAESCtr(k, nonce, 16, plain, out);
+    TEST_ASSERT_EQUAL_MEMORY(expected, out, 16);
+    TEST_ASSERT_EQUAL_MEMORY("Single block msg", plain, 16);
 }
 
 void setup()
@@ -0,0 +1,114 @@
+#include "TestUtil.h"
+#include "gps/GeoCoord.h"
+#include <unity.h>
+
+namespace
+{
+TestRandom rng;
+
+struct Pair {
+    int32_t lat1, lon1, lat2, lon2;
+};
+
+// A random pair of points up to maxSeparation degrees apart in latitude and longitude, away from the poles
+Pair randomPair(double maxSeparation)
+{
+    double lat1 = rng.uniform() * 85, lon1 = rng.uniform() * 180;
+    double lat2 = lat1 + rng.uniform() * maxSeparation, lon2 = lon1 + rng.uniform() * maxSeparation;
+    if (lat2 > 89)
+        lat2 = 89;
+    if (lat2 < -89)
+        lat2 = -89;
+    if (lon2 >= 180)
+        lon2 -= 360;
+    if (lon2 < -180)
+        lon2 += 360;
+    return Pair{(int32_t)lround(lat1 * 1e7), (int32_t)lround(lon1 * 1e7), (int32_t)lround(lat2 * 1e7),
+                (int32_t)lround(lon2 * 1e7)};
+}
+
+// A random point within 0.2 degrees of a pole, at any longitude
+int32_t polarLat(bool north)
+{
+    double lat = 90 - (rng.uniform() + 1) * 0.1;
+    return (int32_t)lround((north ? lat : -lat) * 1e7);
+}
+
+void checkPair(const Pair &p)
+{
+    double lat1 = p.lat1 * 1e-7, lon1 = p.lon1 * 1e-7, lat2 = p.lat2 * 1e-7, lon2 = p.lon2 * 1e-7;
+
+    double distance = GeoCoord::latLongToMeter(lat1, lon1, lat2, lon2);
+    TEST_ASSERT_FLOAT_WITHIN(0.1 + distance * 2e-5, distance, GeoCoord::latLongToMeterFast(p.lat1, p.lon1, p.lat2, p.lon2));
+
+    if (distance > 10) {
+        double bearing = GeoCoord::bearing(lat1, lon1, lat2, lon2);
+        double error = remainder(bearing - GeoCoord::bearingFast(p.lat1, p.lon1, p.lat2, p.lon2), 2 * PI);
+        TEST_ASSERT_FLOAT_WITHIN(0.01, 0, error * DEG_CONVERT);
+    }
+}
+
+void checkAccuracy(double maxSeparation)
+{
+    for (int i = 0; i < 20000; i++)
+        checkPair(randomPair(maxSeparation));
+}
+} // namespace
+
+void setUp(void)
+{
+    rng.seed(1);
+}
+void tearDown(void) {}
+
+void test_fastKernelsMatchDoubleWithinMeters()
+{
+    checkAccuracy(0.001);
+}
+
+void test_fastKernelsMatchDoubleWithinKilometers()
+{
+    checkAccuracy(0.5);
+}
+
+void test_fastKernelsMatchDoubleAcrossTheGlobe()
+{
+    checkAccuracy(170);
+}
+
+void test_fastKernelsMatchDoubleAtThePoles()
+{
+    // Points this close to a pole are a few kilometers apart whatever their longitudes
+    for (int i = 0; i < 20000; i++) {
+        bool north = i % 2;
+        checkPair(Pair{polarLat(north), (int32_t)lround(rng.uniform() * 1.8e9), polarLat(north),
+                       (int32_t)lround(rng.uniform() * 1.8e9)});
+    }
+    checkPair(Pair{898745000, -368500000, 899900000, 1784700000});
+}
+
+void test_fastKernelsNearThePolesAndDateLine()
+{
+    // Nearby points near a pole are far apart in longitude
+    TEST_ASSERT_FLOAT_WITHIN(0.5, GeoCoord::latLongToMeter(89.999, 0, 89.999, 90),
+                             GeoCoord::latLongToMeterFast(899990000, 0, 899990000, 900000000));
+    // Across the date line is the short way round
+    TEST_ASSERT_FLOAT_WITHIN(0.1, GeoCoord::latLongToMeter(10, 179.9999, 10, -179.9999),
+                             GeoCoord::latLongToMeterFast(100000000, 1799999000, 100000000, -1799999000));
+    TEST_ASSERT_FLOAT_WITHIN(0.01, PI / 2, GeoCoord::bearingFast(100000000, 1799999000, 100000000, -1799999000));
+    TEST_ASSERT_EQUAL_FLOAT(0, GeoCoord::latLongToMeterFast(377749000, -1224194000, 377749000, -1224194000));
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+    UNITY_BEGIN();
+    RUN_TEST(test_fastKernelsMatchDoubleWithinMeters);
+    RUN_TEST(test_fastKernelsMatchDoubleWithinKilometers);
+    RUN_TEST(test_fastKernelsMatchDoubleAcrossTheGlobe);
+    RUN_TEST(test_fastKernelsMatchDoubleAtThePoles);
+    RUN_TEST(test_fastKernelsNearThePolesAndDateLine);
+    exit(UNITY_END());
+}
+
+void loop() {}
@@ -0,0 +1,99 @@
+#include "LinkQualityTable.h"
+#include "TestUtil.h"
+#include <unity.h>
+
+static LinkQualityTable table;
+
+void setUp(void)
+{
+    table.clear();
+}
+void tearDown(void) {}
+
+void test_averagesSmoothSingleFrames()
+{
+    table.onReceive(0x34, 0x12345634, 0, -100);
+    const LinkQuality *l = table.getNode(0x12345634);
+    TEST_ASSERT_NOT_NULL(l);
+    TEST_ASSERT_EQUAL_PTR(l, table.get(0x34));
+    TEST_ASSERT_EQUAL_FLOAT(0, l->snr);
+
+    // One deep fade moves the estimate a quarter of the way, not all the way
+    table.onReceive(0x34, 0, -20, -120);
+    TEST_ASSERT_EQUAL_FLOAT(-5, l->snr);
+    TEST_ASSERT_EQUAL_FLOAT(-105, l->rssi);
+    TEST_ASSERT_EQUAL(2, l->heard);
+    TEST_ASSERT_EQUAL_FLOAT(-5, table.getRelayWeightSnr(0x12345634, true, 10));
+    TEST_ASSERT_EQUAL_FLOAT(10, table.getRelayWeightSnr(0x12345635, true, 10));
+    // Relayed, so the frame only tells us a byte which another node may share
+    TEST_ASSERT_EQUAL_FLOAT(10, table.getRelayWeightSnr(0x12345634, false, 10));
+}
+
+void test_relayedFramesOnlyKnowTheByte()
+{
+    table.onReceive(0x34, 0, 5, -90);
+    TEST_ASSERT_NOT_NULL(table.get(0x34));
+    TEST_ASSERT_NULL(table.getNode(0x12345634));
+
+    // Once we hear it directly we learn who it is
+    table.onReceive(0x34, 0x12345634, 5, -90);
+    TEST_ASSERT_NOT_NULL(table.getNode(0x12345634));
+
+    // Frames from old firmware don't say who relayed them
+    table.onReceive(NO_RELAY_NODE, 0, 5, -90);
+    TEST_ASSERT_EQUAL(1, table.size());
+}
+
+void test_anotherNodeWithTheSameByteStartsAfresh()
+{
+    table.onReceive(0x34, 0x12345634, 5, -90);
+    table.onDelivered(0x34);
+    table.onReceive(0x34, 0xabcdef34, -10, -110);
+
+    const LinkQuality *l = table.get(0x34);
+    TEST_ASSERT_EQUAL(0xabcdef34, l->num);
+    TEST_ASSERT_EQUAL_FLOAT(-10, l->snr);
+    TEST_ASSERT_EQUAL(0, l->delivered);
+    TEST_ASSERT_NULL(table.getNode(0x12345634));
+}
+
+void test_failuresMakeANextHopUnreliable()
+{
+    TEST_ASSERT_FALSE(table.isUnreliable(0x34)); // Unknown, so no opinion
+    table.onReceive(0x34, 0x12345634, 5, -90);
+    table.onFailed(0x34);
+    TEST_ASSERT_FALSE(table.isUnreliable(0x34));
+    table.onFailed(0x34);
+    TEST_ASSERT_TRUE(table.isUnreliable(0x34));
+
+    table.onDelivered(0x34);
+    TEST_ASSERT_FALSE(table.isUnreliable(0x34));
+    TEST_ASSERT_EQUAL(1, table.get(0x34)->delivered);
+}
+
+void test_fullTableForgetsOneNeighbour()
+{
+    for (int i = 1; i <= LINK_QUALITY_MAX_NEIGHBOURS + 1; i++)
+        table.onReceive(i, 0, 0, -100);
+
+    TEST_ASSERT_EQUAL(LINK_QUALITY_MAX_NEIGHBOURS, table.size());
+    int known = 0;
+    for (int i = 1; i <= LINK_QUALITY_MAX_NEIGHBOURS + 1; i++)
+        known += table.get(i) != NULL;
+    TEST_ASSERT_EQUAL(LINK_QUALITY_MAX_NEIGHBOURS, known);
+    TEST_ASSERT_NOT_NULL(table.get(LINK_QUALITY_MAX_NEIGHBOURS + 1));
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+    UNITY_BEGIN();
+    RUN_TEST(test_averagesSmoothSingleFrames);
+    RUN_TEST(test_relayedFramesOnlyKnowTheByte);
+    RUN_TEST(test_anotherNodeWithTheSameByteStartsAfresh);
+    RUN_TEST(test_failuresMakeANextHopUnreliable);
+    RUN_TEST(test_fullTableForgetsOneNeighbour);
+    exit(UNITY_END());
+}
+
+void loop() {}
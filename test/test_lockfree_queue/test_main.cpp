@@ -0,0 +1,232 @@
+#include "TestUtil.h"
+#include "mesh/PointerQueue.h"
+#include <chrono>
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+#include <unity.h>
+#include <vector>
+
+namespace
+{
+// Every queue kind gets the same checks
+template <class Q> void checkFillsAndDrainsInOrder()
+{
+    // Not a power of two, so the capacity is smaller than the slots behind it
+    Q q(5);
+    uint32_t x;
+
+    TEST_ASSERT_TRUE(q.isEmpty());
+    TEST_ASSERT_FALSE(q.dequeue(&x, 0));
+
+    // Go round a few times so the positions wrap the slots
+    for (uint32_t round = 0; round < 4; round++) {
+        for (uint32_t i = 0; i < 5; i++) {
+            TEST_ASSERT_EQUAL(5 - i, q.numFree());
+            TEST_ASSERT_TRUE(q.enqueue(round * 100 + i, 0));
+        }
+        TEST_ASSERT_EQUAL(0, q.numFree());
+        TEST_ASSERT_FALSE(q.enqueue(999, 0));
+        TEST_ASSERT_EQUAL(5, q.numUsed());
+
+        for (uint32_t i = 0; i < 3; i++) {
+            TEST_ASSERT_TRUE(q.dequeue(&x, 0));
+            TEST_ASSERT_EQUAL(round * 100 + i, x);
+        }
+        TEST_ASSERT_EQUAL(2, q.numUsed());
+        for (uint32_t i = 3; i < 5; i++) {
+            TEST_ASSERT_TRUE(q.dequeue(&x, 0));
+            TEST_ASSERT_EQUAL(round * 100 + i, x);
+        }
+        TEST_ASSERT_FALSE(q.dequeue(&x, 0));
+        TEST_ASSERT_TRUE(q.isEmpty());
+    }
+    TEST_ASSERT_EQUAL(5, q.highWaterMark());
+}
+
+/**
+ * Run producers and consumers threads on q, each producer sending count values, and check each value arrives exactly once and
+ * in the order each producer sent them.
+ * @param nsPerValue if not null, set to how long it took per value
+ */
+template <class Q> void runThreads(Q &q, int producers, int consumers, uint32_t count, double *nsPerValue = nullptr)
+{
+    std::vector<uint32_t> received(producers * count, 0);
+    std::vector<uint32_t> lastSeen(producers * consumers, 0);
+    std::atomic<uint32_t> remaining{(uint32_t)(producers * count)};
+    std::atomic<uint32_t> outOfOrder{0};
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&q, p, count]() {
+            // Values are 1 based, with the producer in the top bits
+            for (uint32_t i = 1; i <= count; i++)
+                while (!q.enqueue(((uint32_t)p << 24) | i, 0))
+                    std::this_thread::yield();
+        });
+    }
+    for (int c = 0; c < consumers; c++) {
+        threads.emplace_back([&, c]() {
+            uint32_t x;
+            while (remaining.load() > 0) {
+                if (!q.dequeue(&x, 0)) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                uint32_t p = x >> 24, i = x & 0xFFFFFF;
+                received[p * count + i - 1]++;
+                // A consumer must see each producer's values in order, even if other consumers take some in between
+                if (i <= lastSeen[p * consumers + c])
+                    outOfOrder++;
+                lastSeen[p * consumers + c] = i;
+                remaining--;
+            }
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    if (nsPerValue)
+        *nsPerValue = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / (producers * count);
+
+    uint32_t wrong = 0;
+    for (uint32_t r : received)
+        wrong += r != 1;
+    TEST_ASSERT_EQUAL(0, wrong);
+    TEST_ASSERT_EQUAL(0, outOfOrder.load());
+    TEST_ASSERT_TRUE(q.isEmpty());
+}
+
+/// The current TypedQueue with a lock around it, standing in for the critical sections of a freertos queue
+class LockedTypedQueue
+{
+    TypedQueue<uint32_t> q;
+    std::mutex lock;
+
+  public:
+    explicit LockedTypedQueue(int maxElements) : q(maxElements) {}
+    bool enqueue(uint32_t x, TickType_t maxWait)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return q.enqueue(x, maxWait);
+    }
+    bool dequeue(uint32_t *p, TickType_t maxWait)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return q.dequeue(p, maxWait);
+    }
+    bool isEmpty()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return q.isEmpty();
+    }
+};
+
+/// Nanoseconds per enqueue and dequeue pair on a single thread, keeping the queue about half full
+template <class Q> double timeSingleThread(uint32_t count)
+{
+    Q q(32);
+    uint32_t x = 0;
+    volatile uint32_t sink; // Keeps the loop from being optimized away
+    for (uint32_t i = 0; i < 16; i++)
+        q.enqueue(i, 0);
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < count; i++) {
+        q.enqueue(i, 0);
+        q.dequeue(&x, 0);
+        sink = x;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    (void)sink;
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / count;
+}
+} // namespace
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_spscFillsAndDrainsInOrder()
+{
+    checkFillsAndDrainsInOrder<SPSCTypedQueue<uint32_t>>();
+}
+
+void test_mpmcFillsAndDrainsInOrder()
+{
+    checkFillsAndDrainsInOrder<MPMCTypedQueue<uint32_t>>();
+}
+
+void test_spscAcrossThreads()
+{
+    SPSCTypedQueue<uint32_t> q(16);
+    runThreads(q, 1, 1, 1000000);
+    TEST_ASSERT_LESS_OR_EQUAL(16, q.highWaterMark());
+}
+
+void test_mpmcAcrossThreads()
+{
+    MPMCTypedQueue<uint32_t> q(16);
+    runThreads(q, 4, 4, 200000);
+    TEST_ASSERT_LESS_OR_EQUAL(16, q.highWaterMark());
+}
+
+void test_pointerQueueKinds()
+{
+    static int a, b;
+    SPSCPointerQueue<int> spsc(2);
+    MPMCPointerQueue<int> mpmc(2);
+
+    TEST_ASSERT_TRUE(spsc.enqueue(&a, 0) && spsc.enqueue(&b, 0));
+    TEST_ASSERT_TRUE(mpmc.enqueue(&a, 0) && mpmc.enqueue(&b, 0));
+    TEST_ASSERT_EQUAL_PTR(&a, spsc.dequeuePtr(0));
+    TEST_ASSERT_EQUAL_PTR(&a, mpmc.dequeuePtr(0));
+    TEST_ASSERT_EQUAL_PTR(&b, spsc.dequeuePtr(0));
+    TEST_ASSERT_EQUAL_PTR(&b, mpmc.dequeuePtr(0));
+    TEST_ASSERT_NULL(spsc.dequeuePtr(0));
+    TEST_ASSERT_NULL(mpmc.dequeuePtr(0));
+}
+
+/** Not a pass/fail test: prints how the queue kinds compare, for choosing between them */
+void test_benchmark()
+{
+    char line[128];
+    const uint32_t COUNT = 2000000;
+
+    snprintf(line, sizeof(line), "Single thread ns/op: TypedQueue %.1f, SPSC %.1f, MPMC %.1f",
+             timeSingleThread<TypedQueue<uint32_t>>(COUNT), timeSingleThread<SPSCTypedQueue<uint32_t>>(COUNT),
+             timeSingleThread<MPMCTypedQueue<uint32_t>>(COUNT));
+    TEST_MESSAGE(line);
+
+    double lockedNs, spscNs, mpmcNs;
+    LockedTypedQueue locked(32);
+    SPSCTypedQueue<uint32_t> spsc(32);
+    MPMCTypedQueue<uint32_t> mpmc(32);
+    runThreads(locked, 1, 1, COUNT / 4, &lockedNs);
+    runThreads(spsc, 1, 1, COUNT / 4, &spscNs);
+    runThreads(mpmc, 1, 1, COUNT / 4, &mpmcNs);
+    snprintf(line, sizeof(line), "1 to 1 thread ns/op: locked TypedQueue %.1f, SPSC %.1f, MPMC %.1f", lockedNs, spscNs, mpmcNs);
+    TEST_MESSAGE(line);
+
+    LockedTypedQueue locked4(32);
+    MPMCTypedQueue<uint32_t> mpmc4(32);
+    runThreads(locked4, 4, 4, COUNT / 16, &lockedNs);
+    runThreads(mpmc4, 4, 4, COUNT / 16, &mpmcNs);
+    snprintf(line, sizeof(line), "4 to 4 threads ns/op: locked TypedQueue %.1f, MPMC %.1f", lockedNs, mpmcNs);
+    TEST_MESSAGE(line);
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+    UNITY_BEGIN();
+    RUN_TEST(test_spscFillsAndDrainsInOrder);
+    RUN_TEST(test_mpmcFillsAndDrainsInOrder);
+    RUN_TEST(test_spscAcrossThreads);
+    RUN_TEST(test_mpmcAcrossThreads);
+    RUN_TEST(test_pointerQueueKinds);
+    RUN_TEST(test_benchmark);
+    exit(UNITY_END());
+}
+
+void loop() {}
@@ -0,0 +1,259 @@
+#include "DebugConfiguration.h"
+#include "TestUtil.h"
+#include <unity.h>
+
+#ifdef ARCH_PORTDUINO
+#include "platform/portduino/sim/MeshBenchmark.h"
+#include "platform/portduino/sim/MeshSimulator.h"
+
+namespace
+{
+// LongFast reaches ~12 km with the default channel model, so 8 km spacing only lets neighbours hear each other
+constexpr float LINE_SPACING_M = 8000;
+
+void addLine(MeshSimulator &sim, uint16_t count, float spacing,
+             meshtastic_Config_DeviceConfig_Role role = meshtastic_Config_DeviceConfig_Role_CLIENT)
+{
+    for (uint16_t i = 0; i < count; i++) {
+        SimNodeSpec spec;
+        spec.num = 0x1000 + i;
+        spec.placement.x = i * spacing;
+        spec.role = role;
+        sim.addNode(spec);
+    }
+}
+} // namespace
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_channelOnlyLinksNodesInRange()
+{
+    MeshSimulator sim(MeshSimulator::Config{});
+    addLine(sim, 4, LINE_SPACING_M);
+    sim.runUntil(1);
+
+    TEST_ASSERT_EQUAL(1, sim.getChannel().neighbours(0).size());
+    TEST_ASSERT_EQUAL(2, sim.getChannel().neighbours(1).size());
+}
+
+void test_airtimeMatchesRadioInterface()
+{
+    MeshSimulator sim(MeshSimulator::Config{});
+    // 16 byte header + 10 bytes on LongFast
+    TEST_ASSERT_EQUAL(RadioInterface::getPacketTime(26, 250, 11, 5, 16), sim.getPacketTime(10));
+}
+
+void test_broadcastFloodsAlongLine()
+{
+    MeshSimulator sim(MeshSimulator::Config{});
+    addLine(sim, 4, LINE_SPACING_M);
+    sim.send(0, NODENUM_BROADCAST, 20, false, 1000);
+    TEST_ASSERT_TRUE(sim.runUntilIdle(10 * 60 * 1000));
+
+    // 3 hops away with the default hop limit of 3: everyone gets it
+    TEST_ASSERT_EQUAL(3, sim.getPackets()[0].latenciesMsec.size());
+    // Each node in the middle relays exactly once, the copies coming back are duplicates
+    TEST_ASSERT_EQUAL(1, sim.getNodeStats(1).txRelay);
+    TEST_ASSERT_EQUAL(1, sim.getNodeStats(2).txRelay);
+}
+
+void test_hopLimitStopsFlood()
+{
+    MeshSimulator sim(MeshSimulator::Config{});
+    addLine(sim, 6, LINE_SPACING_M);
+    sim.send(0, NODENUM_BROADCAST, 20, false, 1000);
+    sim.runUntilIdle(10 * 60 * 1000);
+
+    // Original transmission plus 3 hops
+    TEST_ASSERT_EQUAL(4, sim.getPackets()[0].latenciesMsec.size());
+    TEST_ASSERT_EQUAL(0, sim.getNodeStats(5).rxGood);
+}
+
+void test_directMessageIsAckedAndLearnsNextHop()
+{
+    MeshSimulator sim(MeshSimulator::Config{});
+    addLine(sim, 3, LINE_SPACING_M);
+    sim.send(0, 0x1002, 20, true, 1000);
+    sim.runUntilIdle(10 * 60 * 1000);
+
+    TEST_ASSERT_EQUAL(1, sim.getPackets()[0].latenciesMsec.size());
+    TEST_ASSERT_TRUE(sim.getPackets()[0].acked);
+
+    // The second DM should go via the learned next hop only
+    uint32_t relayedBefore = sim.getNodeStats(1).txRelay;
+    sim.send(0, 0x1002, 20, true, sim.millis() + 1000);
+    sim.runUntilIdle(sim.millis() + 10 * 60 * 1000);
+    TEST_ASSERT_TRUE(sim.getPackets()[1].acked);
+    TEST_ASSERT_EQUAL(relayedBefore + 2, sim.getNodeStats(1).txRelay); // The DM and its ACK
+}
+
+void test_simultaneousSendersCollide()
+{
+    MeshSimulator sim(MeshSimulator::Config{});
+    // Two hidden terminals either side of a receiver: they can't hear each other so CAD won't help
+    addLine(sim, 3, LINE_SPACING_M, meshtastic_Config_DeviceConfig_Role_CLIENT_MUTE);
+    for (int i = 0; i < 20; i++) {
+        sim.send(0, NODENUM_BROADCAST, 200, false, 1000 + i * 100);
+        sim.send(2, NODENUM_BROADCAST, 200, false, 1000 + i * 100);
+    }
+    sim.runUntilIdle(60 * 60 * 1000);
+
+    TEST_ASSERT_GREATER_THAN(0, sim.getChannel().collisions);
+}
+
+void test_routerLateRelaysAfterOthers()
+{
+    // Node 1 is a router, so always relays before node 2, which is the only way to reach node 3
+    for (auto role : {meshtastic_Config_DeviceConfig_Role_CLIENT, meshtastic_Config_DeviceConfig_Role_ROUTER_LATE}) {
+        MeshSimulator sim(MeshSimulator::Config{});
+        const float x[] = {0, 0, 4000, 13000}, y[] = {0, 6000, 0, 0};
+        const meshtastic_Config_DeviceConfig_Role roles[] = {meshtastic_Config_DeviceConfig_Role_CLIENT,
+                                                             meshtastic_Config_DeviceConfig_Role_ROUTER, role,
+                                                             meshtastic_Config_DeviceConfig_Role_CLIENT};
+        for (uint16_t i = 0; i < 4; i++) {
+            SimNodeSpec spec;
+            spec.num = 0x1000 + i;
+            spec.placement.x = x[i];
+            spec.placement.y = y[i];
+            spec.role = roles[i];
+            sim.addNode(spec);
+        }
+        sim.send(0, NODENUM_BROADCAST, 20, false, 1000);
+        sim.runUntilIdle(10 * 60 * 1000);
+
+        TEST_ASSERT_EQUAL(1, sim.getNodeStats(1).txRelay);
+        if (role == meshtastic_Config_DeviceConfig_Role_CLIENT) {
+            // A client gives up its rebroadcast once it hears node 1's, cutting node 3 off
+            TEST_ASSERT_EQUAL(1, sim.getNodeStats(2).txRelayCanceled);
+            TEST_ASSERT_EQUAL(0, sim.getNodeStats(3).rxGood);
+        } else {
+            // ROUTER_LATE moves it to the late window instead, and still covers node 3
+            TEST_ASSERT_EQUAL(0, sim.getNodeStats(2).txRelayCanceled);
+            TEST_ASSERT_EQUAL(1, sim.getNodeStats(2).txRelay);
+            TEST_ASSERT_EQUAL(3, sim.getPackets()[0].latenciesMsec.size());
+        }
+    }
+}
+
+void test_sameSeedIsDeterministic()
+{
+    uint32_t airtime[2];
+    for (int run = 0; run < 2; run++) {
+        MeshSimulator::Config config;
+        config.seed = 42;
+        MeshSimulator sim(config);
+        for (uint16_t i = 0; i < 25; i++) {
+            SimNodeSpec spec;
+            spec.num = 0x2000 + i;
+            spec.placement.x = (i % 5) * 4000;
+            spec.placement.y = (i / 5) * 4000;
+            sim.addNode(spec);
+        }
+        for (uint16_t i = 0; i < 25; i++)
+            sim.send(i, NODENUM_BROADCAST, 40, false, 1000 + i * 500);
+        sim.runUntilIdle(60 * 60 * 1000);
+        airtime[run] = sim.getTotalAirtimeMsec();
+    }
+    TEST_ASSERT_EQUAL(airtime[0], airtime[1]);
+}
+
+void test_benchmarkLineScenario()
+{
+    MeshBenchmark bench{MeshBenchmark::Options()};
+    MeshBenchmarkResult first, second;
+
+    TEST_ASSERT_FALSE(bench.run("nowhere", first));
+    TEST_ASSERT_TRUE(bench.run("line", first));
+    TEST_ASSERT_TRUE(bench.run("line", second));
+
+    TEST_ASSERT_EQUAL(12, first.numNodes);
+    TEST_ASSERT_GREATER_THAN(0, first.packets);
+    TEST_ASSERT_TRUE(first.deliveryRatio > 0.8f && first.deliveryRatio <= 1.0f);
+    // Every node but the two ends has to relay for anything to cross the line
+    TEST_ASSERT_TRUE(first.rebroadcastsPerPacket > 1.0f);
+    TEST_ASSERT_LESS_OR_EQUAL(first.latencyP90Msec, first.latencyP50Msec);
+    TEST_ASSERT_EQUAL(first.totalAirtimeMsec, second.totalAirtimeMsec);
+}
+
+void test_adaptiveContentionWidensAfterCollisions()
+{
+    ContentionController fixed(ContentionController::CONTENTION_FIXED);
+    ContentionController adaptive(ContentionController::CONTENTION_ADAPTIVE);
+    for (int i = 0; i < 3; i++) {
+        fixed.onCrcError();
+        adaptive.onCrcError();
+    }
+    TEST_ASSERT_EQUAL(3, fixed.adjust(3, 8));
+    TEST_ASSERT_EQUAL(5, adaptive.adjust(3, 8)); // Capped
+    TEST_ASSERT_EQUAL(8, adaptive.adjust(7, 8));
+
+    // Recovers over a few clean sends
+    for (int i = 0; i < 8; i++)
+        adaptive.onTxClean();
+    TEST_ASSERT_EQUAL(3, adaptive.adjust(3, 8));
+
+    // The simulator runs the mode it is given; on a busy grid it shouldn't cost delivery. With the firmware's delay rules it
+    // doesn't reliably cut collisions or airtime either, which is why it stays off by default.
+    MeshBenchmark::Options options;
+    MeshBenchmarkResult fixedResult, adaptiveResult;
+    TEST_ASSERT_TRUE(MeshBenchmark(options).run("grid", fixedResult));
+    options.sim.contentionMode = ContentionController::CONTENTION_ADAPTIVE;
+    TEST_ASSERT_TRUE(MeshBenchmark(options).run("grid", adaptiveResult));
+    TEST_ASSERT_EQUAL(ContentionController::CONTENTION_ADAPTIVE, adaptiveResult.contention);
+    TEST_ASSERT_NOT_EQUAL(fixedResult.collisions, adaptiveResult.collisions);
+    TEST_ASSERT_TRUE(adaptiveResult.deliveryRatio >= fixedResult.deliveryRatio - 0.01f);
+}
+
+void test_countingSuppressionLetsRoutersBackOff()
+{
+    RebroadcastSuppressor first(RebroadcastSuppressor::SUPPRESS_FIRST_DUPLICATE);
+    RebroadcastSuppressor counting(RebroadcastSuppressor::SUPPRESS_COUNTING);
+    TEST_ASSERT_TRUE(first.onDuplicate(0x1234, 1, 0x11, false));
+    TEST_ASSERT_FALSE(first.onDuplicate(0x1234, 1, 0x22, true));
+    TEST_ASSERT_TRUE(counting.onDuplicate(0x1234, 1, 0x11, false));
+
+    // A router needs two distinct relayers of the same packet
+    TEST_ASSERT_FALSE(counting.onDuplicate(0x1234, 2, 0x11, true));
+    TEST_ASSERT_FALSE(counting.onDuplicate(0x1234, 2, 0x11, true));
+    TEST_ASSERT_FALSE(counting.onDuplicate(0x5678, 2, 0x22, true));
+    TEST_ASSERT_TRUE(counting.onDuplicate(0x1234, 2, 0x22, true));
+
+    // Routers on the backbone stop repeating floods others have already carried, without losing delivery
+    MeshBenchmark::Options options;
+    MeshBenchmarkResult firstResult, countingResult;
+    TEST_ASSERT_TRUE(MeshBenchmark(options).run("backbone", firstResult));
+    options.sim.suppressionMode = RebroadcastSuppressor::SUPPRESS_COUNTING;
+    TEST_ASSERT_TRUE(MeshBenchmark(options).run("backbone", countingResult));
+    TEST_ASSERT_LESS_THAN(firstResult.rebroadcastsPerPacket, countingResult.rebroadcastsPerPacket);
+    TEST_ASSERT_LESS_THAN(firstResult.totalAirtimeMsec, countingResult.totalAirtimeMsec);
+    TEST_ASSERT_TRUE(countingResult.deliveryRatio >= firstResult.deliveryRatio - 0.01f);
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+    UNITY_BEGIN();
+    RUN_TEST(test_channelOnlyLinksNodesInRange);
+    RUN_TEST(test_airtimeMatchesRadioInterface);
+    RUN_TEST(test_broadcastFloodsAlongLine);
+    RUN_TEST(test_hopLimitStopsFlood);
+    RUN_TEST(test_directMessageIsAckedAndLearnsNextHop);
+    RUN_TEST(test_simultaneousSendersCollide);
+    RUN_TEST(test_routerLateRelaysAfterOthers);
+    RUN_TEST(test_sameSeedIsDeterministic);
+    RUN_TEST(test_benchmarkLineScenario);
+    RUN_TEST(test_adaptiveContentionWidensAfterCollisions);
+    RUN_TEST(test_countingSuppressionLetsRoutersBackOff);
+    exit(UNITY_END());
+}
+#else
+void setup()
+{
+    initializeTestEnvironment();
+    LOG_WARN("This test requires the ARCH_PORTDUINO variant");
+    UNITY_BEGIN();
+    UNITY_END();
+}
+#endif
+void loop() {}
@@ -0,0 +1,64 @@
+#include "TestUtil.h"
+#include "gps/NMEASentenceFilter.h"
+#include <string>
+#include <unity.h>
+
+namespace
+{
+NMEASentenceFilter filter;
+
+std::string run(const std::string &in)
+{
+    std::string passed;
+    for (char c : in) {
+        const uint8_t *out;
+        size_t len = filter.feed(c, out);
+        passed.append((const char *)out, len);
+    }
+    return passed;
+}
+} // namespace
+
+void setUp(void)
+{
+    filter = NMEASentenceFilter();
+}
+void tearDown(void) {}
+
+void test_passesOnlyTheSentencesWeUse()
+{
+    const std::string gga = "$GNGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+    const std::string rmc = "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n";
+    const std::string gsa = "$GNGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39\r\n";
+    const std::string txt = "$GPTXT,01,01,02,u-blox ag - www.u-blox.com*50\r\n";
+    const std::string gsv = "$GPGSV,2,1,08,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45*75\r\n";
+    const std::string vtg = "$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48\r\n";
+    const std::string pubx = "$PUBX,00,081350.00,4717.113210,N,00833.915187,E*5C\r\n";
+
+    TEST_ASSERT_EQUAL_STRING((gga + rmc + gsa + txt).c_str(), run(gsv + gga + vtg + rmc + pubx + gsa + gsv + txt).c_str());
+    TEST_ASSERT_EQUAL_UINT32(4, filter.sentencesPassed);
+    TEST_ASSERT_EQUAL_UINT32(4, filter.sentencesSkipped);
+    TEST_ASSERT_EQUAL_UINT32(2 * gsv.size() + vtg.size() + pubx.size(), filter.bytesSkipped);
+}
+
+void test_skipsBinaryAndCutShortSentences()
+{
+    const std::string rmc = "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n";
+    const std::string ubx("\xb5\x62\x05\x01\x02\x00\x06\x01\x0f\x38", 10);
+
+    // Binary after a sentence, and a sentence cut off by the next one before its type was known
+    TEST_ASSERT_EQUAL_STRING((rmc + rmc).c_str(), run(rmc + ubx + "$GP" + rmc).c_str());
+    TEST_ASSERT_EQUAL_UINT32(2, filter.sentencesPassed);
+    TEST_ASSERT_EQUAL_UINT32(1, filter.sentencesSkipped);
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+    UNITY_BEGIN();
+    RUN_TEST(test_passesOnlyTheSentencesWeUse);
+    RUN_TEST(test_skipsBinaryAndCutShortSentences);
+    exit(UNITY_END());
+}
+
+void loop() {}
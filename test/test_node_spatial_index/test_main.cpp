@@ -0,0 +1,110 @@
+#include "NodeSpatialIndex.h"
+#include "TestUtil.h"
+#include "gps/GeoCoord.h"
+#include <algorithm>
+#include <unity.h>
+
+namespace
+{
+TestRandom rng;
+
+struct Node {
+    NodeNum num;
+    int32_t lat, lon;
+};
+
+// A point up to spread degrees from lat/lon, short of the poles
+void randomPoint(double lat, double lon, double spread, int32_t &latI, int32_t &lonI)
+{
+    latI = (int32_t)lround(std::max(-89.0, std::min(89.0, lat + rng.uniform() * spread)) * 1e7);
+    lonI = (int32_t)lround((lon + rng.uniform() * spread) * 1e7);
+}
+
+std::vector<Node> scatter(size_t count, double lat, double lon, double spread)
+{
+    std::vector<Node> nodes(count);
+    for (size_t i = 0; i < count; i++) {
+        nodes[i].num = i + 1;
+        randomPoint(lat, lon, spread, nodes[i].lat, nodes[i].lon);
+    }
+    return nodes;
+}
+
+// Check a query against sorting every node by distance
+void checkNearest(const NodeSpatialIndex &index, const std::vector<Node> &nodes, int32_t lat, int32_t lon, size_t maxCount,
+                  float maxMeters)
+{
+    std::vector<NodeDistance> expected;
+    for (const Node &n : nodes) {
+        float meters = GeoCoord::latLongToMeterFast(lat, lon, n.lat, n.lon);
+        if (meters <= maxMeters)
+            expected.push_back(NodeDistance{n.num, meters});
+    }
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](const NodeDistance &a, const NodeDistance &b) { return a.meters < b.meters; });
+    if (expected.size() > maxCount)
+        expected.resize(maxCount);
+
+    std::vector<NodeDistance> found(maxCount);
+    TEST_ASSERT_EQUAL(expected.size(), index.nearest(lat, lon, found.data(), maxCount, maxMeters));
+    for (size_t i = 0; i < expected.size(); i++)
+        TEST_ASSERT_EQUAL_FLOAT(expected[i].meters, found[i].meters);
+}
+} // namespace
+
+void setUp(void)
+{
+    rng.seed(1);
+}
+void tearDown(void) {}
+
+void test_nearestMatchesBruteForce()
+{
+    for (double spread : {0.01, 1.0, 80.0}) {
+        std::vector<Node> nodes = scatter(200, 40, -75, spread);
+        NodeSpatialIndex index;
+        for (const Node &n : nodes)
+            index.update(n.num, n.lat, n.lon);
+        TEST_ASSERT_EQUAL(nodes.size(), index.size());
+
+        for (int i = 0; i < 50; i++) {
+            int32_t lat, lon;
+            randomPoint(40, -75, spread, lat, lon);
+            checkNearest(index, nodes, lat, lon, 1, INFINITY);
+            checkNearest(index, nodes, lat, lon, 10, INFINITY);
+            checkNearest(index, nodes, lat, lon, 300, spread * 30000);
+        }
+    }
+}
+
+void test_updateMovesAndRemoveForgets()
+{
+    NodeSpatialIndex index;
+    index.update(1, 100000000, 100000000);
+    index.update(2, 100010000, 100000000);
+    index.update(1, 200000000, 100000000); // Moves far away
+
+    NodeDistance found[2];
+    TEST_ASSERT_EQUAL(2, index.size());
+    TEST_ASSERT_EQUAL(2, index.nearest(100000000, 100000000, found, 2));
+    TEST_ASSERT_EQUAL_UINT32(2, found[0].num);
+    TEST_ASSERT_EQUAL_UINT32(1, found[1].num);
+    TEST_ASSERT_EQUAL(1, index.nearest(100000000, 100000000, found, 2, 1000));
+
+    index.remove(2);
+    TEST_ASSERT_EQUAL(1, index.nearest(100000000, 100000000, found, 2));
+    TEST_ASSERT_EQUAL_UINT32(1, found[0].num);
+    index.clear();
+    TEST_ASSERT_EQUAL(0, index.nearest(100000000, 100000000, found, 2));
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+    UNITY_BEGIN();
+    RUN_TEST(test_nearestMatchesBruteForce);
+    RUN_TEST(test_updateMovesAndRemoveForgets);
+    exit(UNITY_END());
+}
+
+void loop() {}
@@ -0,0 +1,54 @@
+#include "DebugConfiguration.h"
+#include "TestUtil.h"
+#include <unity.h>
+
+#if !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR
+#include "modules/Telemetry/Sensor/SensirionI2C.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_crcMatchesDatasheet()
+{
+    // The worked example from the SHT3x, SHT4x and SHTC3 datasheets
+    const uint8_t word[] = {0xBE, 0xEF};
+    TEST_ASSERT_EQUAL_HEX8(0x92, SensirionI2C::crc8(word, sizeof(word)));
+}
+
+void test_decodesBothWords()
+{
+    const uint8_t result[] = {0xBE, 0xEF, 0x92, 0x66, 0x66, 0x93};
+    uint16_t temperature = 0, humidity = 0;
+    TEST_ASSERT_TRUE(SensirionI2C::decodeWords(result, &temperature, &humidity));
+    TEST_ASSERT_EQUAL_HEX16(0xBEEF, temperature);
+    TEST_ASSERT_EQUAL_HEX16(0x6666, humidity);
+}
+
+void test_rejectsEitherBadCrc()
+{
+    uint16_t temperature, humidity;
+    const uint8_t badFirst[] = {0xBE, 0xEE, 0x92, 0x66, 0x66, 0x93};
+    TEST_ASSERT_FALSE(SensirionI2C::decodeWords(badFirst, &temperature, &humidity));
+    const uint8_t badSecond[] = {0xBE, 0xEF, 0x92, 0x66, 0x67, 0x93};
+    TEST_ASSERT_FALSE(SensirionI2C::decodeWords(badSecond, &temperature, &humidity));
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+    UNITY_BEGIN();
+    RUN_TEST(test_crcMatchesDatasheet);
+    RUN_TEST(test_decodesBothWords);
+    RUN_TEST(test_rejectsEitherBadCrc);
+    exit(UNITY_END());
+}
+#else
+void setup()
+{
+    initializeTestEnvironment();
+    LOG_WARN("This test requires the environmental sensors");
+    UNITY_BEGIN();
+    UNITY_END();
+}
+#endif
+void loop() {}
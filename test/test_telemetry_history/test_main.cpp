@@ -0,0 +1,155 @@
+#include "DebugConfiguration.h"
+#include "TestUtil.h"
+#include "modules/Telemetry/TelemetryHistory.h"
+#include <unity.h>
+
+namespace
+{
+constexpr uint32_t START_TIME = 1700000000;
+
+meshtastic_Telemetry environment(uint32_t time, float temperature, float humidity)
+{
+    meshtastic_Telemetry t = meshtastic_Telemetry_init_zero;
+    t.time = time;
+    t.which_variant = meshtastic_Telemetry_environment_metrics_tag;
+    t.variant.environment_metrics.has_temperature = true;
+    t.variant.environment_metrics.temperature = temperature;
+    t.variant.environment_metrics.has_relative_humidity = true;
+    t.variant.environment_metrics.relative_humidity = humidity;
+    return t;
+}
+
+meshtastic_Telemetry device(uint32_t time, uint32_t batteryLevel)
+{
+    meshtastic_Telemetry t = meshtastic_Telemetry_init_zero;
+    t.time = time;
+    t.which_variant = meshtastic_Telemetry_device_metrics_tag;
+    t.variant.device_metrics.has_battery_level = true;
+    t.variant.device_metrics.battery_level = batteryLevel;
+    return t;
+}
+} // namespace
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_samplesComeBackInOrderAtTheirResolution()
+{
+    TelemetryHistory history;
+    for (int i = 0; i < 10; i++)
+        history.record(environment(START_TIME + i * TELEMETRY_HISTORY_INTERVAL_SECS, 20.0f + i * 0.37f, 60.0f - i));
+
+    meshtastic_Telemetry t;
+    uint32_t after = 0;
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_TRUE(history.next(meshtastic_Telemetry_environment_metrics_tag, after, t));
+        TEST_ASSERT_EQUAL_UINT32(START_TIME + i * TELEMETRY_HISTORY_INTERVAL_SECS, t.time);
+        TEST_ASSERT_EQUAL(meshtastic_Telemetry_environment_metrics_tag, t.which_variant);
+        TEST_ASSERT_TRUE(t.variant.environment_metrics.has_temperature);
+        TEST_ASSERT_FLOAT_WITHIN(0.006f, 20.0f + i * 0.37f, t.variant.environment_metrics.temperature);
+        TEST_ASSERT_FLOAT_WITHIN(0.006f, 60.0f - i, t.variant.environment_metrics.relative_humidity);
+        TEST_ASSERT_FALSE(t.variant.environment_metrics.has_barometric_pressure);
+        after = t.time;
+    }
+    TEST_ASSERT_FALSE(history.next(meshtastic_Telemetry_environment_metrics_tag, after, t));
+    TEST_ASSERT_FALSE(history.next(meshtastic_Telemetry_power_metrics_tag, 0, t));
+}
+
+void test_samplesAreDownsampled()
+{
+    TelemetryHistory history;
+    for (uint32_t i = 0; i < 60; i++)
+        history.record(device(START_TIME + i * 10, 100 - i));
+
+    // One sample per interval survives
+    meshtastic_Telemetry t;
+    uint32_t after = 0;
+    int count = 0;
+    while (history.next(meshtastic_Telemetry_device_metrics_tag, after, t)) {
+        after = t.time;
+        count++;
+    }
+    TEST_ASSERT_EQUAL(600 / TELEMETRY_HISTORY_INTERVAL_SECS, count);
+}
+
+void test_sinceSkipsOlderSamples()
+{
+    TelemetryHistory history;
+    for (uint32_t i = 0; i < 10; i++)
+        history.record(device(START_TIME + i * TELEMETRY_HISTORY_INTERVAL_SECS, 90 - i));
+
+    meshtastic_Telemetry t;
+    TEST_ASSERT_TRUE(history.next(meshtastic_Telemetry_device_metrics_tag, START_TIME + 5 * TELEMETRY_HISTORY_INTERVAL_SECS, t));
+    TEST_ASSERT_EQUAL_UINT32(START_TIME + 6 * TELEMETRY_HISTORY_INTERVAL_SECS, t.time);
+    TEST_ASSERT_EQUAL_UINT32(84, t.variant.device_metrics.battery_level);
+}
+
+void test_oldestSamplesAreDroppedWhenFull()
+{
+    TelemetryHistory history;
+    const uint32_t samples = TELEMETRY_HISTORY_SIZE; // Far more than fit
+    for (uint32_t i = 0; i < samples; i++)
+        history.record(environment(START_TIME + i * TELEMETRY_HISTORY_INTERVAL_SECS, 15.0f + (i % 50) * 0.1f, 50.0f));
+
+    meshtastic_Telemetry t;
+    TEST_ASSERT_TRUE(history.next(meshtastic_Telemetry_environment_metrics_tag, 0, t));
+    TEST_ASSERT_GREATER_THAN_UINT32(START_TIME, t.time);
+
+    uint32_t after = 0, last = 0;
+    int count = 0;
+    while (history.next(meshtastic_Telemetry_environment_metrics_tag, after, t)) {
+        after = last = t.time;
+        count++;
+    }
+    // The newest sample is always kept, and slowly changing readings take only a few bytes each
+    TEST_ASSERT_EQUAL_UINT32(START_TIME + (samples - 1) * TELEMETRY_HISTORY_INTERVAL_SECS, last);
+    TEST_ASSERT_GREATER_THAN(TELEMETRY_HISTORY_SIZE / 16, count);
+}
+
+void test_clockGoingBackwardsStartsAFreshRun()
+{
+    TelemetryHistory history;
+    history.record(device(START_TIME + 3600, 80));
+    history.record(device(START_TIME, 90));
+    history.record(device(START_TIME + TELEMETRY_HISTORY_INTERVAL_SECS, 89));
+
+    meshtastic_Telemetry t;
+    TEST_ASSERT_TRUE(history.next(meshtastic_Telemetry_device_metrics_tag, 0, t));
+    TEST_ASSERT_EQUAL_UINT32(90, t.variant.device_metrics.battery_level);
+    TEST_ASSERT_TRUE(history.next(meshtastic_Telemetry_device_metrics_tag, t.time, t));
+    TEST_ASSERT_EQUAL_UINT32(89, t.variant.device_metrics.battery_level);
+    TEST_ASSERT_TRUE(history.next(meshtastic_Telemetry_device_metrics_tag, t.time, t));
+    TEST_ASSERT_EQUAL_UINT32(80, t.variant.device_metrics.battery_level);
+}
+
+void test_requestTimeOnlyReplaysWhenEnabled()
+{
+    TelemetryHistory history;
+    history.record(environment(START_TIME, 20.0f, 60.0f));
+
+    // An ordinary request from our own phone which happens to carry a time
+    meshtastic_MeshPacket req = meshtastic_MeshPacket_init_zero;
+    meshtastic_Telemetry request = meshtastic_Telemetry_init_zero;
+    request.which_variant = meshtastic_Telemetry_environment_metrics_tag;
+    request.time = START_TIME;
+    TEST_ASSERT_EQUAL(TELEMETRY_HISTORY_PHONE_REPLAY != 0, history.replayIfRequested(req, request));
+
+    // Without a time it's never a history request
+    request.time = 0;
+    TEST_ASSERT_FALSE(history.replayIfRequested(req, request));
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+    UNITY_BEGIN();
+    RUN_TEST(test_samplesComeBackInOrderAtTheirResolution);
+    RUN_TEST(test_samplesAreDownsampled);
+    RUN_TEST(test_sinceSkipsOlderSamples);
+    RUN_TEST(test_oldestSamplesAreDroppedWhenFull);
+    RUN_TEST(test_clockGoingBackwardsStartsAFreshRun);
+    RUN_TEST(test_requestTimeOnlyReplaysWhenEnabled);
+    exit(UNITY_END());
+}
+
+void loop() {}
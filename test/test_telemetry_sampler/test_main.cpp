@@ -0,0 +1,119 @@
+#include "DebugConfiguration.h"
+#include "TestUtil.h"
+#include <unity.h>
+
+#if !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR
+#include "modules/Telemetry/Sensor/TelemetrySampler.h"
+
+namespace
+{
+constexpr uint32_t SAMPLE_INTERVAL_MSEC = 50;
+
+class FakeSensor : public TelemetrySensor
+{
+  public:
+    explicit FakeSensor(float temperature)
+        : TelemetrySensor(meshtastic_TelemetrySensorType_SENSOR_UNSET, "Fake"), temperature(temperature)
+    {
+    }
+
+    int conversions = 0;
+    int reads = 0;
+
+    virtual int32_t runOnce() override { return 0; }
+    virtual uint32_t startConversion() override
+    {
+        conversions++;
+        return 0; // Ready as soon as it's started
+    }
+    virtual bool getMetrics(meshtastic_Telemetry *measurement) override
+    {
+        reads++;
+        measurement->variant.environment_metrics.has_temperature = true;
+        measurement->variant.environment_metrics.temperature = temperature;
+        return true;
+    }
+
+  protected:
+    virtual void setup() override {}
+
+  private:
+    float temperature;
+};
+
+class TestSampler : public TelemetrySampler
+{
+  public:
+    TestSampler() : TelemetrySampler("TestSampler", meshtastic_Telemetry_environment_metrics_tag, SAMPLE_INTERVAL_MSEC) {}
+    using TelemetrySampler::runOnce;
+};
+
+float getTemperature(TestSampler &sampler, FakeSensor &sensor)
+{
+    meshtastic_Telemetry m = meshtastic_Telemetry_init_zero;
+    m.which_variant = meshtastic_Telemetry_environment_metrics_tag;
+    TEST_ASSERT_TRUE(sampler.getMetrics(&sensor, &m));
+    return m.variant.environment_metrics.temperature;
+}
+} // namespace
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_readsEverySensorReadyInTheSameTick()
+{
+    TestSampler sampler;
+    FakeSensor a(20), b(30);
+    TEST_ASSERT_EQUAL_FLOAT(20, getTemperature(sampler, a));
+    TEST_ASSERT_EQUAL_FLOAT(30, getTemperature(sampler, b));
+    TEST_ASSERT_EQUAL(1, a.reads);
+    TEST_ASSERT_EQUAL(1, b.reads);
+
+    delay(SAMPLE_INTERVAL_MSEC + 10);
+    getTemperature(sampler, a);
+    getTemperature(sampler, b);
+
+    // Both conversions start and finish in one pass, so one is read now and we come straight back for the other
+    TEST_ASSERT_EQUAL(0, sampler.runOnce());
+    TEST_ASSERT_EQUAL(1, a.conversions);
+    TEST_ASSERT_EQUAL(1, b.conversions);
+    TEST_ASSERT_EQUAL(3, a.reads + b.reads);
+    TEST_ASSERT_GREATER_THAN(0, sampler.runOnce());
+    TEST_ASSERT_EQUAL(2, a.reads);
+    TEST_ASSERT_EQUAL(2, b.reads);
+}
+
+void test_sensorsNobodyAsksForGoIdle()
+{
+    TestSampler sampler;
+    FakeSensor a(20);
+    getTemperature(sampler, a);
+
+    delay(2 * SAMPLE_INTERVAL_MSEC + 10);
+    TEST_ASSERT_EQUAL(SAMPLE_INTERVAL_MSEC, sampler.runOnce());
+    TEST_ASSERT_EQUAL(0, a.conversions);
+    TEST_ASSERT_EQUAL(1, a.reads);
+
+    // Asking again reads it there and then, rather than handing back the stale reading
+    getTemperature(sampler, a);
+    TEST_ASSERT_EQUAL(2, a.reads);
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+    UNITY_BEGIN();
+    RUN_TEST(test_readsEverySensorReadyInTheSameTick);
+    RUN_TEST(test_sensorsNobodyAsksForGoIdle);
+    exit(UNITY_END());
+}
+#else
+void setup()
+{
+    initializeTestEnvironment();
+    LOG_WARN("This test requires the environmental sensors");
+    UNITY_BEGIN();
+    UNITY_END();
+}
+#endif
+void loop() {}
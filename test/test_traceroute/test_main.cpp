@@ -0,0 +1,85 @@
+#include "LinkQualityTable.h"
+#include "TestUtil.h"
+#include "modules/TraceRouteModule.h"
+#include <unity.h>
+
+namespace
+{
+class TestTraceRoute : public TraceRouteModule
+{
+  public:
+    using TraceRouteModule::insertUnknownHops;
+};
+
+TestTraceRoute *traceRoute;
+
+meshtastic_MeshPacket makePacket(NodeNum from, uint8_t relayNode, uint8_t hopStart, uint8_t hopLimit)
+{
+    meshtastic_MeshPacket p = meshtastic_MeshPacket_init_zero;
+    p.from = from;
+    p.to = 0x55555555;
+    p.relay_node = relayNode;
+    p.hop_start = hopStart;
+    p.hop_limit = hopLimit;
+    return p;
+}
+} // namespace
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_directFrameAddsNoHops()
+{
+    meshtastic_MeshPacket p = makePacket(0x11111134, 0x34, 3, 3);
+    meshtastic_RouteDiscovery r = meshtastic_RouteDiscovery_init_zero;
+    traceRoute->insertUnknownHops(p, &r, true);
+    TEST_ASSERT_EQUAL(0, r.route_count);
+    TEST_ASSERT_EQUAL(0, r.snr_towards_count);
+}
+
+void test_collidingRelayByteIsNotNamed()
+{
+    // We hear 0x11111134 directly, but this frame was relayed by 0x22222234, which didn't add itself to the route
+    linkQuality.onReceive(NO_RELAY_NODE, 0x11111134, 8.0f, -60, 1000);
+    meshtastic_MeshPacket p = makePacket(0x33333333, 0x34, 3, 2);
+    meshtastic_RouteDiscovery r = meshtastic_RouteDiscovery_init_zero;
+    traceRoute->insertUnknownHops(p, &r, true);
+
+    TEST_ASSERT_EQUAL(1, r.route_count);
+    TEST_ASSERT_EQUAL_HEX32(NODENUM_BROADCAST, r.route[0]);
+    TEST_ASSERT_EQUAL(1, r.snr_towards_count);
+    TEST_ASSERT_EQUAL(INT8_MIN, r.snr_towards[0]);
+}
+
+void test_onlyMissingHopsAreAdded()
+{
+    meshtastic_MeshPacket p = makePacket(0x33333333, 0x34, 5, 2);
+    meshtastic_RouteDiscovery r = meshtastic_RouteDiscovery_init_zero;
+    r.route_back[0] = 0x44444444;
+    r.route_back_count = 1;
+    r.snr_back[0] = 20;
+    r.snr_back_count = 1;
+    traceRoute->insertUnknownHops(p, &r, false);
+
+    TEST_ASSERT_EQUAL(3, r.route_back_count);
+    TEST_ASSERT_EQUAL_HEX32(0x44444444, r.route_back[0]);
+    TEST_ASSERT_EQUAL_HEX32(NODENUM_BROADCAST, r.route_back[1]);
+    TEST_ASSERT_EQUAL_HEX32(NODENUM_BROADCAST, r.route_back[2]);
+    TEST_ASSERT_EQUAL(3, r.snr_back_count);
+    TEST_ASSERT_EQUAL(20, r.snr_back[0]);
+    TEST_ASSERT_EQUAL(INT8_MIN, r.snr_back[2]);
+    TEST_ASSERT_EQUAL(0, r.route_count);
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+    traceRoute = new TestTraceRoute();
+    UNITY_BEGIN();
+    RUN_TEST(test_directFrameAddsNoHops);
+    RUN_TEST(test_collidingRelayByteIsNotNamed);
+    RUN_TEST(test_onlyMissingHopsAreAdded);
+    exit(UNITY_END());
+}
+
+void loop() {}
@@ -0,0 +1,274 @@
+#include "DebugConfiguration.h"
+#include "TestUtil.h"
+#include "mesh/compression/unishox2.h"
+#include <chrono>
+#include <string.h>
+#include <unity.h>
+
+// Internals of unishox2.cpp which have table driven / word at a time fast paths
+void init_coder();
+int append_bits(char *out, int olen, int ol, uint8_t code, int clen);
+int readVCodeIdx(const char *in, int len, int *bit_no_p);
+int getStepCodeIdx(const char *in, int len, int *bit_no_p, int limit);
+int32_t getNumFromBits(const char *in, int len, int bit_no, int count);
+
+namespace
+{
+struct KnownStream {
+    const char *text;
+    int len;
+    uint8_t bytes[32];
+};
+
+// Output of the original bit by bit encoder, the fast paths must not change a single bit of it
+const KnownStream knownStreams[] = {
+    {"Hello world", 8, {0x87, 0x67, 0xc7, 0x14, 0xbd, 0xeb, 0x7c, 0x74}},
+    {"Meeting at the trailhead at 0730, bring water!",
+     29,
+     {0x87, 0x96, 0xe2, 0xf3, 0xd9, 0x4c, 0x28, 0xec, 0xd4, 0x6e, 0x6f, 0x8e, 0xce, 0x7a, 0x53,
+      0x08, 0xa3, 0xb7, 0x10, 0xbd, 0x07, 0xad, 0xde, 0x7b, 0x2f, 0x79, 0x87, 0xb1, 0xf7}},
+    {"ALL CAPS MESSAGE", 15, {0x84, 0x87, 0x01, 0xc2, 0x0e, 0x42, 0x43, 0xc0, 0x69, 0x00, 0x79, 0x7a, 0xd4, 0xfb, 0x32}},
+    {"Battery 87% 4.12V", 14, {0x87, 0xa9, 0x88, 0x7b, 0xf9, 0x45, 0xdf, 0xb7, 0xcf, 0xae, 0x5c, 0xd8, 0x07, 0xd1}},
+    {"https://meshtastic.org/docs",
+     18,
+     {0xf6, 0x88, 0xf1, 0xa2, 0xfd, 0xf2, 0xf5, 0xda, 0x27, 0x51, 0x7c, 0x93, 0xad, 0xfb, 0x16, 0xfa, 0xae, 0x74}},
+    {"Lat 37.7749 Lon -122.4194",
+     19,
+     {0x87, 0x13, 0x08, 0xb8, 0xec, 0xfb, 0x76, 0xe6, 0xbd, 0x00, 0x71, 0x58, 0x8b, 0x45, 0x37, 0x6f, 0x99, 0xae, 0x7f}},
+    {"ok", 2, {0xd7, 0xd9}},
+    {"\xc3\x9cn\xc3\xaf"
+     "c\xc3\xb6"
+     "d\xc3\xa9 \xe2\x86\x92 \xe2\x9c\x93 \xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e",
+     24,
+     {0x9e, 0x04, 0xe6, 0x1c, 0x4f, 0x93, 0x83, 0xf4, 0x74, 0xd4, 0x7c, 0x41,
+      0xa5, 0x1e, 0x2a, 0x0a, 0x05, 0x97, 0x49, 0x41, 0x07, 0xc4, 0xcc, 0xbf}},
+    {"aaaaaaaaaaaaaaaaaaaa", 13, {0x91, 0x60, 0x15, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x45}},
+    {"{\"key\": \"value\"}", 11, {0x8a, 0x13, 0xed, 0xfc, 0x8f, 0xef, 0xd4, 0xf1, 0xdd, 0x88, 0x2c}},
+    {"CALLSIGN-42", 10, {0x80, 0x73, 0x3c, 0x71, 0xab, 0xf6, 0xc0, 0x2d, 0x17, 0x37}},
+    {"abc\r\nline two\ttab", 12, {0xcf, 0xae, 0x47, 0x5c, 0x5e, 0x35, 0x1e, 0xf4, 0x3d, 0xe2, 0x7d, 0x17}},
+    {"01234567890123456789", 13, {0x91, 0x60, 0x00, 0x24, 0x68, 0xac, 0xf1, 0x20, 0x24, 0x68, 0xac, 0xf1, 0x25}},
+    {"Wie geht's? Tr\xc3\xa8s bien.",
+     18,
+     {0x87, 0xbd, 0xb5, 0xec, 0xfb, 0x40, 0xf6, 0xd0, 0xfb, 0x20, 0x8d, 0x9e, 0x05, 0x46, 0x97, 0xab, 0x78, 0x4c}},
+};
+
+// Pieces of typical text messages and ATAK callsigns, the random inputs are built from
+const char *const fragments[] = {"the ", "and ", "at ", "ing", "Hello", "OK", "ETA ", "12:45", "37.7749", "-122.41", "N0CALL",
+                                 "https://", ".org", "!", "?", ", ", ". ", "\n", "\xc3\xa9", "\xe2\x9c\x93", "aaaaaa", "  "};
+
+TestRandom rng;
+
+int randomText(char *buf, int maxLen)
+{
+    int len = 0, target = rng.next() % maxLen;
+    while (len < target) {
+        if (rng.next() % 4 == 0) {
+            buf[len++] = 32 + rng.next() % 95;
+            continue;
+        }
+        const char *f = fragments[rng.next() % (sizeof(fragments) / sizeof(fragments[0]))];
+        int flen = strlen(f);
+        if (len + flen > target)
+            break;
+        memcpy(buf + len, f, flen);
+        len += flen;
+    }
+    return len;
+}
+
+// The original bit by bit primitives, for comparison with the fast paths
+int refAppendBits(char *out, int olen, int ol, uint8_t code, int clen)
+{
+    static const uint8_t mask[] = {0x80, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC, 0xFE, 0xFF};
+    while (clen > 0) {
+        uint8_t cur_bit = ol % 8;
+        uint8_t blen = clen;
+        uint8_t a_byte = (code & mask[blen - 1]) >> cur_bit;
+        if (blen + cur_bit > 8)
+            blen = (8 - cur_bit);
+        int oidx = ol / 8;
+        if (oidx < 0 || olen <= oidx)
+            return -1;
+        if (cur_bit == 0)
+            out[oidx] = a_byte;
+        else
+            out[oidx] |= a_byte;
+        code <<= blen;
+        ol += blen;
+        clen -= blen;
+    }
+    return ol;
+}
+
+int refReadBit(const char *in, int bit_no)
+{
+    return in[bit_no >> 3] & (0x80 >> (bit_no % 8));
+}
+
+int refGetStepCodeIdx(const char *in, int len, int *bit_no_p, int limit)
+{
+    int idx = 0;
+    while (*bit_no_p < len && refReadBit(in, *bit_no_p)) {
+        idx++;
+        (*bit_no_p)++;
+        if (idx == limit)
+            return idx;
+    }
+    if (*bit_no_p >= len)
+        return 99;
+    (*bit_no_p)++;
+    return idx;
+}
+
+int32_t refGetNumFromBits(const char *in, int len, int bit_no, int count)
+{
+    int32_t ret = 0;
+    while (count-- && bit_no < len) {
+        ret += (refReadBit(in, bit_no) ? 1 << count : 0);
+        bit_no++;
+    }
+    return count < 0 ? ret : -1;
+}
+
+int refReadVCodeIdx(const char *in, int len, int *bit_no_p)
+{
+    static const uint8_t vcodes[] = {0x00, 0x40, 0x60, 0x80, 0x90, 0xA0, 0xB0, 0xC0, 0xD0, 0xD8, 0xE0, 0xE4, 0xE8, 0xEC,
+                                     0xEE, 0xF0, 0xF2, 0xF4, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF};
+    static const uint8_t lens[] = {2, 3, 3, 4, 4, 4, 4, 4, 5, 5, 6, 6, 6, 7, 7, 7, 7, 7, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8};
+    if (*bit_no_p >= len)
+        return 99;
+    // Bits past the end of the stream read as 1, like read8bitCode()
+    for (int v = 0; v < 28; v++) {
+        int i = 0;
+        for (; i < lens[v]; i++) {
+            int bit = *bit_no_p + i < len ? !!refReadBit(in, *bit_no_p + i) : 1;
+            if (bit != ((vcodes[v] >> (7 - i)) & 1))
+                break;
+        }
+        if (i == lens[v]) {
+            *bit_no_p += lens[v];
+            return *bit_no_p > len ? 99 : v;
+        }
+    }
+    return 99;
+}
+} // namespace
+
+void setUp(void)
+{
+    rng.seed(12345);
+}
+void tearDown(void) {}
+
+void test_knownStreamsAreUnchanged()
+{
+    for (const auto &k : knownStreams) {
+        char out[64], text[128];
+        int len = unishox2_compress_lines(k.text, strlen(k.text), out, sizeof(out), USX_PSET_DFLT, NULL);
+        TEST_ASSERT_EQUAL_MESSAGE(k.len, len, k.text);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(k.bytes, out, k.len, k.text);
+
+        int textLen = unishox2_decompress_lines((const char *)k.bytes, k.len, text, sizeof(text), USX_PSET_DFLT, NULL);
+        TEST_ASSERT_EQUAL_MESSAGE(strlen(k.text), textLen, k.text);
+        TEST_ASSERT_EQUAL_MEMORY_MESSAGE(k.text, text, textLen, k.text);
+    }
+}
+
+void test_randomTextRoundTrips()
+{
+    for (int i = 0; i < 20000; i++) {
+        char text[200], out[300], back[300];
+        int len = randomText(text, sizeof(text));
+        int clen = unishox2_compress_lines(text, len, out, sizeof(out), USX_PSET_DFLT, NULL);
+        TEST_ASSERT_GREATER_THAN(0, clen);
+        TEST_ASSERT_LESS_OR_EQUAL(sizeof(out), clen);
+
+        int dlen = unishox2_decompress_lines(out, clen, back, sizeof(back), USX_PSET_DFLT, NULL);
+        TEST_ASSERT_EQUAL(len, dlen);
+        TEST_ASSERT_EQUAL_MEMORY(text, back, len);
+
+        // A short output buffer is reported, never overrun
+        char small[16 + 1];
+        small[16] = 0x5a;
+        clen = unishox2_compress_lines(text, len, small, 16, USX_PSET_DFLT, NULL);
+        TEST_ASSERT_EQUAL_HEX8(0x5a, small[16]);
+        if (clen > 16)
+            TEST_ASSERT_EQUAL(17, clen);
+    }
+}
+
+void test_fastPathsMatchBitByBit()
+{
+    init_coder();
+    for (int i = 0; i < 20000; i++) {
+        char in[8];
+        for (auto &b : in)
+            b = rng.next();
+        int len = (1 + rng.next() % sizeof(in)) * 8;
+        int bit = rng.next() % (len + 2);
+
+        int fast = bit, ref = bit;
+        TEST_ASSERT_EQUAL(refReadVCodeIdx(in, len, &ref), readVCodeIdx(in, len, &fast));
+        TEST_ASSERT_EQUAL(ref, fast);
+
+        int limit = 4 + rng.next() % 2;
+        fast = ref = bit;
+        TEST_ASSERT_EQUAL(refGetStepCodeIdx(in, len, &ref, limit), getStepCodeIdx(in, len, &fast, limit));
+        TEST_ASSERT_EQUAL(ref, fast);
+
+        int count = rng.next() % 22;
+        TEST_ASSERT_EQUAL(refGetNumFromBits(in, len, bit, count), getNumFromBits(in, len, bit, count));
+
+        char fastOut[8], refOut[8];
+        int olen = 1 + rng.next() % sizeof(fastOut), ol = rng.next() % (olen * 8);
+        for (int j = 0; j < olen; j++)
+            fastOut[j] = refOut[j] = rng.next();
+        // The encoder only ever ORs into the current byte after the bits already written, which are cleared
+        if (ol % 8)
+            fastOut[ol / 8] = refOut[ol / 8] &= 0xFF << (8 - ol % 8);
+        uint8_t code = rng.next();
+        int clen = 1 + rng.next() % 8;
+        TEST_ASSERT_EQUAL(refAppendBits(refOut, olen, ol, code, clen), append_bits(fastOut, olen, ol, code, clen));
+        TEST_ASSERT_EQUAL_MEMORY(refOut, fastOut, olen);
+    }
+}
+
+void test_throughput()
+{
+    const int iterations = 2000;
+    char texts[64][200];
+    int lens[64], total = 0;
+    for (int i = 0; i < 64; i++)
+        total += lens[i] = randomText(texts[i], sizeof(texts[i]));
+
+    char out[64][300], back[300];
+    int clens[64];
+    auto start = std::chrono::steady_clock::now();
+    for (int n = 0; n < iterations; n++)
+        for (int i = 0; i < 64; i++)
+            clens[i] = unishox2_compress_lines(texts[i], lens[i], out[i], sizeof(out[i]), USX_PSET_DFLT, NULL);
+    auto compressed = std::chrono::steady_clock::now();
+    for (int n = 0; n < iterations; n++)
+        for (int i = 0; i < 64; i++)
+            unishox2_decompress_lines(out[i], clens[i], back, sizeof(back), USX_PSET_DFLT, NULL);
+    auto decompressed = std::chrono::steady_clock::now();
+
+    double mb = (double)total * iterations / 1e6;
+    LOG_INFO("unishox2 compress %.1f MB/s, decompress %.1f MB/s",
+             mb / std::chrono::duration<double>(compressed - start).count(),
+             mb / std::chrono::duration<double>(decompressed - compressed).count());
+    TEST_ASSERT_EQUAL(lens[63], unishox2_decompress_lines(out[63], clens[63], back, sizeof(back), USX_PSET_DFLT, NULL));
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+    UNITY_BEGIN();
+    RUN_TEST(test_knownStreamsAreUnchanged);
+    RUN_TEST(test_randomTextRoundTrips);
+    RUN_TEST(test_fastPathsMatchBitByBit);
+    RUN_TEST(test_throughput);
+    exit(UNITY_END());
+}
+
+void loop() {}